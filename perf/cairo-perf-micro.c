@@ -554,6 +554,7 @@ const cairo_perf_case_t perf_cases[] = {
     { FUNC(fill),   64, 512},
     { FUNC(stroke), 64, 512},
     { FUNC(text),   64, 512},
+    { FUNC(text_threads), 256, 256 },
     { FUNC(glyphs), 64, 512},
     { FUNC(mask),   64, 512},
     { FUNC(line),  32, 512},
@@ -582,6 +583,7 @@ const cairo_perf_case_t perf_cases[] = {
     { FUNC(pythagoras_tree), 768, 768 },
     { FUNC(intersections), 512, 512 },
     { FUNC(many_strokes), 32, 512 },
+    { FUNC(many_circles), 32, 512 },
     { FUNC(wide_strokes), 32, 512 },
     { FUNC(many_fills), 32, 512 },
     { FUNC(wide_fills), 32, 512 },
@@ -590,5 +592,8 @@ const cairo_perf_case_t perf_cases[] = {
     { FUNC(wave), 500, 500 },
     { FUNC(fill_clip), 16, 512 },
     { FUNC(tiger), 16, 1024 },
+    { FUNC(rgb565), 64, 512 },
+    { FUNC(antialias), 64, 512 },
+    { FUNC(sweep), 512, 512 },
     { NULL }
 };
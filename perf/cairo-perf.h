@@ -199,6 +199,7 @@ CAIRO_PERF_DECL (disjoint);
 CAIRO_PERF_DECL (hatching);
 CAIRO_PERF_DECL (tessellate);
 CAIRO_PERF_DECL (text);
+CAIRO_PERF_DECL (text_threads);
 CAIRO_PERF_DECL (glyphs);
 CAIRO_PERF_DECL (hash_table);
 CAIRO_PERF_DECL (pattern_create_radial);
@@ -219,6 +220,7 @@ CAIRO_PERF_DECL (intersections);
 CAIRO_PERF_DECL (spiral);
 CAIRO_PERF_DECL (wave);
 CAIRO_PERF_DECL (many_strokes);
+CAIRO_PERF_DECL (many_circles);
 CAIRO_PERF_DECL (wide_strokes);
 CAIRO_PERF_DECL (many_fills);
 CAIRO_PERF_DECL (wide_fills);
@@ -232,5 +234,8 @@ CAIRO_PERF_DECL (a1_pixel);
 CAIRO_PERF_DECL (sierpinski);
 CAIRO_PERF_DECL (fill_clip);
 CAIRO_PERF_DECL (tiger);
+CAIRO_PERF_DECL (rgb565);
+CAIRO_PERF_DECL (antialias);
+CAIRO_PERF_DECL (sweep);
 
 #endif
@@ -0,0 +1,137 @@
+/*
+ * Copyright © 2012 Samsung Electronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Measures the cost of each antialiasing tier, which selects the scan
+ * converter used to rasterise fills and strokes, on a mix of curves and
+ * thin diagonal edges typical of animated vector content.
+ */
+
+#include "cairo-perf.h"
+
+static void
+star_path (cairo_t *cr, int width, int height)
+{
+    double cx = width / 2., cy = height / 2.;
+    double r = (width < height ? width : height) / 2.;
+    int i;
+
+    for (i = 0; i < 24; i++) {
+	double theta = i * M_PI / 12;
+	double d = i & 1 ? r * .35 : r * .95;
+
+	if (i == 0)
+	    cairo_move_to (cr, cx + d * cos (theta), cy + d * sin (theta));
+	else
+	    cairo_line_to (cr, cx + d * cos (theta), cy + d * sin (theta));
+    }
+    cairo_close_path (cr);
+
+    cairo_new_sub_path (cr);
+    cairo_arc (cr, cx, cy, r * .25, 0, 2 * M_PI);
+}
+
+static cairo_time_t
+do_antialias_fill (cairo_t *cr, int width, int height, int loops,
+		   cairo_antialias_t antialias)
+{
+    cairo_set_source_rgb (cr, 1, 1, 1);
+    cairo_paint (cr);
+
+    cairo_set_source_rgb (cr, 0, 0, 1);
+    cairo_set_antialias (cr, antialias);
+    cairo_set_fill_rule (cr, CAIRO_FILL_RULE_EVEN_ODD);
+    star_path (cr, width, height);
+
+    cairo_perf_timer_start ();
+
+    while (loops--)
+	cairo_fill_preserve (cr);
+
+    cairo_perf_timer_stop ();
+
+    cairo_new_path (cr);
+
+    return cairo_perf_timer_elapsed ();
+}
+
+static cairo_time_t
+do_antialias_stroke (cairo_t *cr, int width, int height, int loops,
+		     cairo_antialias_t antialias)
+{
+    cairo_set_source_rgb (cr, 1, 1, 1);
+    cairo_paint (cr);
+
+    cairo_set_source_rgb (cr, 0, 0, 1);
+    cairo_set_antialias (cr, antialias);
+    cairo_set_line_width (cr, 1.5);
+    star_path (cr, width, height);
+
+    cairo_perf_timer_start ();
+
+    while (loops--)
+	cairo_stroke_preserve (cr);
+
+    cairo_perf_timer_stop ();
+
+    cairo_new_path (cr);
+
+    return cairo_perf_timer_elapsed ();
+}
+
+#define ANTIALIAS_CASE(name, tier) \
+static cairo_time_t \
+do_antialias_fill_##name (cairo_t *cr, int width, int height, int loops) \
+{ \
+    return do_antialias_fill (cr, width, height, loops, tier); \
+} \
+static cairo_time_t \
+do_antialias_stroke_##name (cairo_t *cr, int width, int height, int loops) \
+{ \
+    return do_antialias_stroke (cr, width, height, loops, tier); \
+}
+
+ANTIALIAS_CASE (none, CAIRO_ANTIALIAS_NONE)
+ANTIALIAS_CASE (fast, CAIRO_ANTIALIAS_FAST)
+ANTIALIAS_CASE (good, CAIRO_ANTIALIAS_GOOD)
+ANTIALIAS_CASE (best, CAIRO_ANTIALIAS_BEST)
+
+cairo_bool_t
+antialias_enabled (cairo_perf_t *perf)
+{
+    return cairo_perf_can_run (perf, "antialias", NULL);
+}
+
+void
+antialias (cairo_perf_t *perf, cairo_t *cr, int width, int height)
+{
+    cairo_perf_run (perf, "antialias-fill-none", do_antialias_fill_none, NULL);
+    cairo_perf_run (perf, "antialias-fill-fast", do_antialias_fill_fast, NULL);
+    cairo_perf_run (perf, "antialias-fill-good", do_antialias_fill_good, NULL);
+    cairo_perf_run (perf, "antialias-fill-best", do_antialias_fill_best, NULL);
+
+    cairo_perf_run (perf, "antialias-stroke-none", do_antialias_stroke_none, NULL);
+    cairo_perf_run (perf, "antialias-stroke-fast", do_antialias_stroke_fast, NULL);
+    cairo_perf_run (perf, "antialias-stroke-good", do_antialias_stroke_good, NULL);
+    cairo_perf_run (perf, "antialias-stroke-best", do_antialias_stroke_best, NULL);
+}
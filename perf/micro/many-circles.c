@@ -0,0 +1,131 @@
+/*
+ * Copyright © 2012 Samsung Electronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Draws many small circles, and many short lines with round caps, so that
+ * every operation rebuilds the same arcs and pens.
+ */
+
+#include "cairo-perf.h"
+
+static uint32_t state;
+
+static double
+uniform_random (double minval, double maxval)
+{
+    static uint32_t const poly = 0x9a795537U;
+    uint32_t n = 32;
+    while (n-->0)
+	state = 2*state < state ? (2*state ^ poly) : 2*state;
+    return minval + state * (maxval - minval) / 4294967296.0;
+}
+
+static cairo_time_t
+do_many_circles_fill (cairo_t *cr, int width, int height, int loops)
+{
+    cairo_perf_timer_start ();
+
+    while (loops--) {
+	int count;
+
+	state = 0xc0ffee;
+	for (count = 0; count < 1000; count++) {
+	    cairo_arc (cr,
+		       uniform_random (0, width),
+		       uniform_random (0, height),
+		       4., 0, 2 * M_PI);
+	    cairo_fill (cr);
+	}
+    }
+
+    cairo_perf_timer_stop ();
+
+    return cairo_perf_timer_elapsed ();
+}
+
+static cairo_time_t
+do_many_circles_stroke (cairo_t *cr, int width, int height, int loops)
+{
+    cairo_set_line_width (cr, 2.);
+
+    cairo_perf_timer_start ();
+
+    while (loops--) {
+	int count;
+
+	state = 0xc0ffee;
+	for (count = 0; count < 1000; count++) {
+	    cairo_new_sub_path (cr);
+	    cairo_arc (cr,
+		       uniform_random (0, width),
+		       uniform_random (0, height),
+		       4., 0, 2 * M_PI);
+	    cairo_stroke (cr);
+	}
+    }
+
+    cairo_perf_timer_stop ();
+
+    return cairo_perf_timer_elapsed ();
+}
+
+static cairo_time_t
+do_many_round_caps (cairo_t *cr, int width, int height, int loops)
+{
+    cairo_set_line_width (cr, 5.);
+    cairo_set_line_cap (cr, CAIRO_LINE_CAP_ROUND);
+    cairo_set_line_join (cr, CAIRO_LINE_JOIN_ROUND);
+
+    cairo_perf_timer_start ();
+
+    while (loops--) {
+	int count;
+
+	state = 0xc0ffee;
+	for (count = 0; count < 1000; count++) {
+	    double x = uniform_random (0, width);
+	    double y = uniform_random (0, height);
+	    cairo_move_to (cr, x, y);
+	    cairo_rel_line_to (cr, uniform_random (-10, 10), uniform_random (-10, 10));
+	    cairo_stroke (cr);
+	}
+    }
+
+    cairo_perf_timer_stop ();
+
+    return cairo_perf_timer_elapsed ();
+}
+
+cairo_bool_t
+many_circles_enabled (cairo_perf_t *perf)
+{
+    return cairo_perf_can_run (perf, "many-circles", NULL);
+}
+
+void
+many_circles (cairo_perf_t *perf, cairo_t *cr, int width, int height)
+{
+    cairo_perf_run (perf, "many-circles-fill", do_many_circles_fill, NULL);
+    cairo_perf_run (perf, "many-circles-stroke", do_many_circles_stroke, NULL);
+    cairo_perf_run (perf, "many-circles-round-caps", do_many_round_caps, NULL);
+}
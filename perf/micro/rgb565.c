@@ -0,0 +1,151 @@
+/*
+ * Copyright © 2012 Samsung Electronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Measures the direct span renderers for RGB16_565 destinations, as used
+ * by embedded displays. Whatever the target, the shapes are drawn into a
+ * 565 image which is then shown on the target once the timer stops.
+ */
+
+#include "cairo-perf.h"
+
+typedef enum {
+    RGB565_FILL,
+    RGB565_LERP,
+    RGB565_LERP_ALPHA,
+    RGB565_BLIT
+} rgb565_mode_t;
+
+static cairo_time_t
+do_rgb565 (cairo_t *cr, int width, int height, int loops, rgb565_mode_t mode)
+{
+    cairo_surface_t *image;
+    cairo_t *cr565;
+
+    image = cairo_image_surface_create (CAIRO_FORMAT_RGB16_565, width, height);
+    cr565 = cairo_create (image);
+
+    cairo_set_source_rgb (cr565, 1, 1, 1);
+    cairo_paint (cr565);
+
+    switch (mode) {
+    case RGB565_FILL:
+	cairo_set_antialias (cr565, CAIRO_ANTIALIAS_NONE);
+	cairo_set_source_rgb (cr565, 0, 0, 1);
+	break;
+    case RGB565_LERP:
+    case RGB565_LERP_ALPHA:
+	cairo_set_source_rgb (cr565, 0, 0, 1);
+	break;
+    case RGB565_BLIT:
+	{
+	    cairo_surface_t *src;
+	    cairo_t *cr2;
+
+	    src = cairo_image_surface_create (CAIRO_FORMAT_RGB16_565,
+					      width, height);
+	    cr2 = cairo_create (src);
+	    cairo_set_source_rgb (cr2, 1, 0, 0);
+	    cairo_paint (cr2);
+	    cairo_destroy (cr2);
+
+	    cairo_set_source_surface (cr565, src, 0, 0);
+	    cairo_surface_destroy (src);
+	}
+	break;
+    }
+
+    cairo_arc (cr565,
+	       width/2.0, height/2.0,
+	       width/3.0,
+	       0, 2 * M_PI);
+
+    cairo_perf_timer_start ();
+
+    while (loops--) {
+	if (mode == RGB565_LERP_ALPHA) {
+	    cairo_save (cr565);
+	    cairo_clip_preserve (cr565);
+	    cairo_paint_with_alpha (cr565, .5);
+	    cairo_restore (cr565);
+	} else
+	    cairo_fill_preserve (cr565);
+    }
+    cairo_surface_flush (image);
+
+    cairo_perf_timer_stop ();
+
+    cairo_destroy (cr565);
+
+    cairo_set_source_surface (cr, image, 0, 0);
+    cairo_paint (cr);
+    cairo_surface_destroy (image);
+
+    return cairo_perf_timer_elapsed ();
+}
+
+static cairo_time_t
+do_rgb565_fill (cairo_t *cr, int width, int height, int loops)
+{
+    return do_rgb565 (cr, width, height, loops, RGB565_FILL);
+}
+
+static cairo_time_t
+do_rgb565_lerp (cairo_t *cr, int width, int height, int loops)
+{
+    return do_rgb565 (cr, width, height, loops, RGB565_LERP);
+}
+
+static cairo_time_t
+do_rgb565_lerp_alpha (cairo_t *cr, int width, int height, int loops)
+{
+    return do_rgb565 (cr, width, height, loops, RGB565_LERP_ALPHA);
+}
+
+static cairo_time_t
+do_rgb565_blit (cairo_t *cr, int width, int height, int loops)
+{
+    return do_rgb565 (cr, width, height, loops, RGB565_BLIT);
+}
+
+static double
+count_rgb565 (cairo_t *cr, int width, int height)
+{
+    /* the area of the circle */
+    return M_PI * width * width / 9 / 1e6; /* Mpix/s */
+}
+
+cairo_bool_t
+rgb565_enabled (cairo_perf_t *perf)
+{
+    return cairo_perf_can_run (perf, "rgb565", NULL);
+}
+
+void
+rgb565 (cairo_perf_t *perf, cairo_t *cr, int width, int height)
+{
+    cairo_perf_run (perf, "rgb565-fill", do_rgb565_fill, count_rgb565);
+    cairo_perf_run (perf, "rgb565-lerp", do_rgb565_lerp, count_rgb565);
+    cairo_perf_run (perf, "rgb565-lerp-alpha", do_rgb565_lerp_alpha, count_rgb565);
+    cairo_perf_run (perf, "rgb565-blit", do_rgb565_blit, count_rgb565);
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright © 2012 Samsung Electronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Measures how the Bentley-Ottmann tessellator scales with the number of
+ * edges, from a thousand up to a million. The path is a field of small
+ * bow-ties, each crossing itself once and overlapping its neighbours, so
+ * the intersection count grows linearly and the cost is dominated by
+ * sorting the events and maintaining the sweep line. cairo_fill_extents()
+ * tessellates the path without rasterising it, whatever the target.
+ */
+
+#include "cairo-perf.h"
+
+static unsigned state;
+static double
+uniform_random (double minval, double maxval)
+{
+    static unsigned const poly = 0x9a795537U;
+    unsigned n = 32;
+    while (n-->0)
+	state = 2*state < state ? (2*state ^ poly) : 2*state;
+    return minval + state * (maxval - minval) / 4294967296.0;
+}
+
+static cairo_time_t
+do_sweep (cairo_t *cr, int width, int height, int loops, int num_edges)
+{
+    int num_bowties = num_edges / 4;
+    int cols, rows, i;
+    double size, x1, y1, x2, y2;
+
+    cols = ceil (sqrt (num_bowties * (double) width / height));
+    rows = (num_bowties + cols - 1) / cols;
+    size = 1.5 * width / cols;
+
+    state = 0x12345678;
+    cairo_new_path (cr);
+    for (i = 0; i < num_bowties; i++) {
+	double x = (i % cols + uniform_random (0, 1)) * width / cols;
+	double y = (i / cols + uniform_random (0, 1)) * height / rows;
+	double dx = uniform_random (.25, 1) * size;
+	double dy = uniform_random (.25, 1) * size;
+
+	cairo_move_to (cr, x, y);
+	cairo_line_to (cr, x + dx, y + dy);
+	cairo_line_to (cr, x + dx, y);
+	cairo_line_to (cr, x, y + dy);
+	cairo_close_path (cr);
+    }
+
+    cairo_perf_timer_start ();
+
+    while (loops--)
+	cairo_fill_extents (cr, &x1, &y1, &x2, &y2);
+
+    cairo_perf_timer_stop ();
+
+    cairo_new_path (cr);
+
+    return cairo_perf_timer_elapsed ();
+}
+
+static cairo_time_t
+sweep_1k (cairo_t *cr, int width, int height, int loops)
+{
+    return do_sweep (cr, width, height, loops, 1000);
+}
+
+static cairo_time_t
+sweep_10k (cairo_t *cr, int width, int height, int loops)
+{
+    return do_sweep (cr, width, height, loops, 10000);
+}
+
+static cairo_time_t
+sweep_100k (cairo_t *cr, int width, int height, int loops)
+{
+    return do_sweep (cr, width, height, loops, 100000);
+}
+
+static cairo_time_t
+sweep_1m (cairo_t *cr, int width, int height, int loops)
+{
+    return do_sweep (cr, width, height, loops, 1000000);
+}
+
+cairo_bool_t
+sweep_enabled (cairo_perf_t *perf)
+{
+    return cairo_perf_can_run (perf, "sweep", NULL);
+}
+
+void
+sweep (cairo_perf_t *perf, cairo_t *cr, int width, int height)
+{
+    cairo_perf_run (perf, "sweep-1k", sweep_1k, NULL);
+    cairo_perf_run (perf, "sweep-10k", sweep_10k, NULL);
+    cairo_perf_run (perf, "sweep-100k", sweep_100k, NULL);
+    cairo_perf_run (perf, "sweep-1m", sweep_1m, NULL);
+}
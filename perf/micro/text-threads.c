@@ -0,0 +1,133 @@
+/*
+ * Copyright © 2012 Samsung Electronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Renders the same text into a separate image surface from each of several
+ * threads at once, all sharing one scaled font. Every thread does the same
+ * amount of work, so with no contention between the threads the time per
+ * iteration stays the same as the number of threads grows.
+ */
+
+#include "cairo-perf.h"
+
+#if CAIRO_HAS_REAL_PTHREAD
+#include <pthread.h>
+
+#define MAX_THREADS 8
+
+typedef struct {
+    cairo_surface_t *surface;
+    cairo_scaled_font_t *scaled_font;
+    int width, height;
+} text_thread_t;
+
+static int num_threads;
+
+static void *
+draw_text (void *closure)
+{
+    const char text[] = "the jay, pig, fox, zebra and my wolves quack";
+    text_thread_t *thread = closure;
+    cairo_t *cr;
+    double x, y;
+    int i = 0, j = 0;
+
+    cr = cairo_create (thread->surface);
+    cairo_set_scaled_font (cr, thread->scaled_font);
+
+    do {
+	cairo_move_to (cr, 0, j++ * 10);
+	cairo_show_text (cr, text + i);
+	cairo_get_current_point (cr, &x, &y);
+	while (x < thread->width && cairo_status (cr) == CAIRO_STATUS_SUCCESS) {
+	    cairo_show_text (cr, text);
+	    cairo_get_current_point (cr, &x, &y);
+	}
+	if (++i >= (int) sizeof (text) - 1)
+	    i = 0;
+    } while (y < thread->height && cairo_status (cr) == CAIRO_STATUS_SUCCESS);
+
+    cairo_destroy (cr);
+
+    return NULL;
+}
+
+static cairo_time_t
+do_text_threads (cairo_t *cr, int width, int height, int loops)
+{
+    text_thread_t threads[MAX_THREADS];
+    pthread_t ids[MAX_THREADS];
+    int n;
+
+    cairo_set_font_size (cr, 9);
+
+    for (n = 0; n < num_threads; n++) {
+	threads[n].surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+							 width, height);
+	threads[n].scaled_font = cairo_get_scaled_font (cr);
+	threads[n].width = width;
+	threads[n].height = height;
+    }
+
+    cairo_perf_timer_start ();
+
+    while (loops--) {
+	for (n = 0; n < num_threads; n++)
+	    pthread_create (&ids[n], NULL, draw_text, &threads[n]);
+	for (n = 0; n < num_threads; n++)
+	    pthread_join (ids[n], NULL);
+    }
+
+    cairo_perf_timer_stop ();
+
+    for (n = 0; n < num_threads; n++)
+	cairo_surface_destroy (threads[n].surface);
+
+    return cairo_perf_timer_elapsed ();
+}
+#endif
+
+cairo_bool_t
+text_threads_enabled (cairo_perf_t *perf)
+{
+#if CAIRO_HAS_REAL_PTHREAD
+    return cairo_perf_can_run (perf, "text-threads", NULL);
+#else
+    return FALSE;
+#endif
+}
+
+void
+text_threads (cairo_perf_t *perf, cairo_t *cr, int width, int height)
+{
+#if CAIRO_HAS_REAL_PTHREAD
+    num_threads = 1;
+    cairo_perf_run (perf, "text-threads-1", do_text_threads, NULL);
+    num_threads = 2;
+    cairo_perf_run (perf, "text-threads-2", do_text_threads, NULL);
+    num_threads = 4;
+    cairo_perf_run (perf, "text-threads-4", do_text_threads, NULL);
+    num_threads = 8;
+    cairo_perf_run (perf, "text-threads-8", do_text_threads, NULL);
+#endif
+}
@@ -147,31 +147,105 @@ _arc_segments_needed (double	      angle,
    _arc_error_normalized).
 */
 static void
-_cairo_arc_segment (cairo_t *cr,
-		    double   xc,
-		    double   yc,
-		    double   radius,
-		    double   angle_A,
-		    double   angle_B)
+_cairo_arc_segment (double		  angle_A,
+		    double		  angle_B,
+		    cairo_point_double_t *points)
 {
-    double r_sin_A, r_cos_A;
-    double r_sin_B, r_cos_B;
+    double sin_A, cos_A;
+    double sin_B, cos_B;
     double h;
 
-    r_sin_A = radius * sin (angle_A);
-    r_cos_A = radius * cos (angle_A);
-    r_sin_B = radius * sin (angle_B);
-    r_cos_B = radius * cos (angle_B);
+    sin_A = sin (angle_A);
+    cos_A = cos (angle_A);
+    sin_B = sin (angle_B);
+    cos_B = cos (angle_B);
 
     h = 4.0/3.0 * tan ((angle_B - angle_A) / 4.0);
 
-    cairo_curve_to (cr,
-		    xc + r_cos_A - h * r_sin_A,
-		    yc + r_sin_A + h * r_cos_A,
-		    xc + r_cos_B + h * r_sin_B,
-		    yc + r_sin_B - h * r_cos_B,
-		    xc + r_cos_B,
-		    yc + r_sin_B);
+    points[0].x = cos_A - h * sin_A;
+    points[0].y = sin_A + h * cos_A;
+    points[1].x = cos_B + h * sin_B;
+    points[1].y = sin_B - h * cos_B;
+    points[2].x = cos_B;
+    points[2].y = sin_B;
+}
+
+/* Applications tend to draw the same arcs, typically whole circles, many
+ * times over. Once the segment count is known, the splines only depend
+ * upon the angles and direction, so the last few decompositions of the
+ * unit circle are kept in a small direct-mapped cache. The device space
+ * radius, tolerance and matrix are all folded into the segment count, so
+ * circles of similar size share an entry.
+ */
+#define ARC_CACHE_SIZE 32
+#define ARC_CACHE_MAX_SEGMENTS 16
+
+typedef struct _cairo_arc_key {
+    double angle_min;
+    double angle_max;
+    int segments;
+    int dir;
+} cairo_arc_key_t;
+
+typedef struct _cairo_arc_decomposition {
+    cairo_arc_key_t key;
+    cairo_point_double_t points[3 * ARC_CACHE_MAX_SEGMENTS];
+} cairo_arc_decomposition_t;
+
+static cairo_arc_decomposition_t arc_cache[ARC_CACHE_SIZE];
+
+static void
+_cairo_arc_decompose (const cairo_arc_key_t *key,
+		      cairo_point_double_t  *points)
+{
+    double angle_min = key->angle_min;
+    double angle_max = key->angle_max;
+    double step;
+    int i;
+
+    step = (angle_max - angle_min) / key->segments;
+
+    if (key->dir == CAIRO_DIRECTION_REVERSE) {
+	double t;
+
+	t = angle_min;
+	angle_min = angle_max;
+	angle_max = t;
+
+	step = -step;
+    }
+
+    for (i = 0; i < key->segments - 1; i++, angle_min += step)
+	_cairo_arc_segment (angle_min, angle_min + step, points + 3 * i);
+
+    _cairo_arc_segment (angle_min, angle_max, points + 3 * i);
+}
+
+static void
+_cairo_arc_lookup (const cairo_arc_key_t *key,
+		   cairo_point_double_t  *points)
+{
+    cairo_arc_decomposition_t *entry;
+    unsigned long hash;
+    int n = 3 * key->segments;
+
+    hash = _cairo_hash_bytes (_CAIRO_HASH_INIT_VALUE, key, sizeof (*key));
+
+    CAIRO_MUTEX_LOCK (_cairo_arc_cache_mutex);
+    entry = &arc_cache[hash % ARC_CACHE_SIZE];
+    if (memcmp (&entry->key, key, sizeof (*key)) == 0) {
+	memcpy (points, entry->points, n * sizeof (cairo_point_double_t));
+	CAIRO_MUTEX_UNLOCK (_cairo_arc_cache_mutex);
+	return;
+    }
+    CAIRO_MUTEX_UNLOCK (_cairo_arc_cache_mutex);
+
+    _cairo_arc_decompose (key, points);
+
+    CAIRO_MUTEX_LOCK (_cairo_arc_cache_mutex);
+    entry->key = *key;
+    memcpy (entry->points, points, n * sizeof (cairo_point_double_t));
+    CAIRO_MUTEX_UNLOCK (_cairo_arc_cache_mutex);
 }
 
 static void
@@ -183,6 +257,8 @@ _cairo_arc_in_direction (cairo_t	  *cr,
 			 double		   angle_max,
 			 cairo_direction_t dir)
 {
+    int segments = 0;
+
     if (cairo_status (cr))
         return;
 
@@ -194,8 +270,20 @@ _cairo_arc_in_direction (cairo_t	  *cr,
 	angle_max += angle_min + 2 * M_PI * MAX_FULL_CIRCLES;
     }
 
-    /* Recurse if drawing arc larger than pi */
-    if (angle_max - angle_min > M_PI) {
+    if (angle_max - angle_min <= M_PI && angle_max != angle_min) {
+	cairo_matrix_t ctm;
+
+	cairo_get_matrix (cr, &ctm);
+	segments = _arc_segments_needed (angle_max - angle_min,
+					 radius, &ctm,
+					 cairo_get_tolerance (cr));
+    }
+
+    /* Recurse if drawing arc larger than pi, or too finely divided to
+     * be cached */
+    if (angle_max - angle_min > M_PI ||
+	segments > ARC_CACHE_MAX_SEGMENTS)
+    {
 	double angle_mid = angle_min + (angle_max - angle_min) / 2.0;
 	if (dir == CAIRO_DIRECTION_FORWARD) {
 	    _cairo_arc_in_direction (cr, xc, yc, radius,
@@ -214,35 +302,26 @@ _cairo_arc_in_direction (cairo_t	  *cr,
 				     angle_min, angle_mid,
 				     dir);
 	}
-    } else if (angle_max != angle_min) {
-	cairo_matrix_t ctm;
-	int i, segments;
-	double step;
-
-	cairo_get_matrix (cr, &ctm);
-	segments = _arc_segments_needed (angle_max - angle_min,
-					 radius, &ctm,
-					 cairo_get_tolerance (cr));
-	step = (angle_max - angle_min) / segments;
-	segments -= 1;
-
-	if (dir == CAIRO_DIRECTION_REVERSE) {
-	    double t;
-
-	    t = angle_min;
-	    angle_min = angle_max;
-	    angle_max = t;
-
-	    step = -step;
-	}
-
-	for (i = 0; i < segments; i++, angle_min += step) {
-	    _cairo_arc_segment (cr, xc, yc, radius,
-				angle_min, angle_min + step);
+    } else if (segments) {
+	cairo_point_double_t points[3 * ARC_CACHE_MAX_SEGMENTS];
+	cairo_arc_key_t key;
+	int i;
+
+	key.angle_min = angle_min;
+	key.angle_max = angle_max;
+	key.segments = segments;
+	key.dir = dir;
+	_cairo_arc_lookup (&key, points);
+
+	for (i = 0; i < 3 * segments; i += 3) {
+	    cairo_curve_to (cr,
+			    xc + radius * points[i + 0].x,
+			    yc + radius * points[i + 0].y,
+			    xc + radius * points[i + 1].x,
+			    yc + radius * points[i + 1].y,
+			    xc + radius * points[i + 2].x,
+			    yc + radius * points[i + 2].y);
 	}
-
-	_cairo_arc_segment (cr, xc, yc, radius,
-			    angle_min, angle_max);
     } else {
 	cairo_line_to (cr,
 		       xc + radius * cos (angle_min),
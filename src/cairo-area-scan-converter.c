@@ -0,0 +1,409 @@
+/* cairo - a vector graphics library with display and print output
+ *
+ * Copyright © 2012 Samsung Electronics
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it either under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * (the "LGPL") or, at your option, under the terms of the Mozilla
+ * Public License Version 1.1 (the "MPL"). If you do not alter this
+ * notice, a recipient may use your version of this file under either
+ * the MPL or the LGPL.
+ *
+ * You should have received a copy of the LGPL along with this library
+ * in the file COPYING-LGPL-2.1; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA 02110-1335, USA
+ * You should have received a copy of the MPL along with this library
+ * in the file COPYING-MPL-1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License
+ * Version 1.1 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY
+ * OF ANY KIND, either express or implied. See the LGPL or the MPL for
+ * the specific language governing rights and limitations.
+ *
+ * The Original Code is the cairo graphics library.
+ *
+ * The Initial Developer of the Original Code is Samsung Electronics.
+ */
+
+/* A scan converter that computes the exact area coverage of each pixel.
+ *
+ * Rather than sampling the polygon on a subpixel grid, every edge
+ * deposits the signed area it sweeps out of each pixel row into an
+ * accumulation buffer: for each cell the edge crosses we record the
+ * height of the edge within the cell, split between that cell and its
+ * neighbour to the right according to where it crossed. A prefix sum
+ * along the row then yields the (signed) winding area of every pixel,
+ * which is mapped through the fill rule to a coverage value.
+ *
+ * Only a single row of cells is live at any time, so the memory use is
+ * proportional to the width of the extents and the number of edges.
+ * Rows without any edges are skipped, and runs of rows crossed only by
+ * vertical edges are rendered once with the full height of the run.
+ *
+ * The coverage is only exact where the winding stays within 0 and 1.
+ * Where edges overlap within a pixel the areas are summed before the
+ * fill rule is applied, which is the same approximation made by the
+ * other analytic rasterisers; so callers wanting exact coverage must
+ * first reduce the polygon with _cairo_polygon_reduce().
+ */
+
+#include "cairoint.h"
+
+#include "cairo-spans-private.h"
+#include "cairo-error-private.h"
+#include "cairo-combsort-inline.h"
+
+#include <math.h>
+
+struct edge {
+    double top, bottom;
+    double x;		/* at top */
+    double dxdy;
+    int dir;
+};
+
+typedef struct _cairo_area_scan_converter {
+    cairo_scan_converter_t base;
+
+    int xmin, ymin;
+    int width, height;
+
+    cairo_fill_rule_t fill_rule;
+    cairo_antialias_t antialias;
+
+    struct edge *edges;
+    int num_edges;
+
+    struct edge **active;
+
+    float *cells;
+    cairo_half_open_span_t *spans;
+
+    struct edge edges_embedded[32];
+    struct edge *active_embedded[32];
+} cairo_area_scan_converter_t;
+
+static inline int
+edge_compare_for_top (const struct edge a, const struct edge b)
+{
+    if (a.top < b.top)
+	return -1;
+    return a.top > b.top;
+}
+
+CAIRO_COMBSORT_DECLARE (sort_edges, struct edge, edge_compare_for_top)
+
+static inline void
+cell_add (float *cells, int i, float v, int *min, int *max)
+{
+    cells[i] += v;
+    if (i < *min)
+	*min = i;
+    if (i > *max)
+	*max = i;
+}
+
+/* Deposit the area swept by the portion of an edge within a row,
+ * running from x0 to x1 with a signed height of d.
+ */
+static void
+accumulate (float *cells, int width,
+	    double x0, double x1, double d,
+	    int *min, int *max)
+{
+    double s;
+    int i, end;
+
+    if (x0 > x1) {
+	double t = x0;
+	x0 = x1;
+	x1 = t;
+    }
+
+    if (x0 >= width)
+	return;
+
+    if (x1 <= 0) {
+	cell_add (cells, 0, d, min, max);
+	return;
+    }
+
+    if (x0 == x1) {
+	double f;
+
+	i = floor (x0);
+	f = x0 - i;
+	cell_add (cells, i, d * (1 - f), min, max);
+	cell_add (cells, i + 1, d * f, min, max);
+	return;
+    }
+
+    s = d / (x1 - x0);
+    if (x0 < 0) {
+	cell_add (cells, 0, -x0 * s, min, max);
+	x0 = 0;
+    }
+
+    i = floor (x0);
+    end = x1 < width ? floor (x1) : width - 1;
+    for (; i <= end; i++) {
+	double u = x0 - i;
+	double v = (x1 < i + 1 ? x1 : i + 1) - i;
+	double h = s * (v - u);
+	double m = .5 * (u + v);
+
+	cell_add (cells, i, h * (1 - m), min, max);
+	cell_add (cells, i + 1, h * m, min, max);
+	x0 = i + 1;
+    }
+}
+
+static inline uint8_t
+coverage_to_alpha (float acc, cairo_fill_rule_t fill_rule)
+{
+    float c = fabsf (acc);
+
+    if (fill_rule == CAIRO_FILL_RULE_WINDING) {
+	if (c > 1)
+	    c = 1;
+    } else {
+	c = fmodf (c, 2);
+	if (c > 1)
+	    c = 2 - c;
+    }
+
+    return c * 255 + .5f;
+}
+
+static cairo_status_t
+render_row (cairo_area_scan_converter_t *self,
+	    int y, int height, int min, int max,
+	    cairo_span_renderer_t *renderer)
+{
+    cairo_half_open_span_t *spans = self->spans;
+    float *cells = self->cells;
+    float acc = 0;
+    int last = 0, num_spans = 0;
+    int x, end;
+
+    end = max < self->width ? max + 1 : self->width;
+    for (x = min; x < end; x++) {
+	int a;
+
+	acc += cells[x];
+	a = coverage_to_alpha (acc, self->fill_rule);
+	if (a != last) {
+	    spans[num_spans].x = self->xmin + x;
+	    spans[num_spans].coverage = a;
+	    spans[num_spans].inverse = 0;
+	    num_spans++;
+	    last = a;
+	}
+    }
+
+    if (last) {
+	spans[num_spans].x = self->xmin + self->width;
+	spans[num_spans].coverage = 0;
+	spans[num_spans].inverse = 0;
+	num_spans++;
+    }
+
+    memset (cells + min, 0, (max - min + 1) * sizeof (float));
+
+    return renderer->render_rows (renderer, self->ymin + y, height,
+				  num_spans ? spans : NULL, num_spans);
+}
+
+static cairo_status_t
+_cairo_area_scan_converter_generate (void			*converter,
+				     cairo_span_renderer_t	*renderer)
+{
+    cairo_area_scan_converter_t *self = converter;
+    struct edge **active = self->active;
+    struct edge *next = self->edges;
+    struct edge *end = self->edges + self->num_edges;
+    int num_active = 0;
+    cairo_status_t status;
+    int y;
+
+    for (y = 0; y < self->height; ) {
+	int i, j, min, max, height;
+	cairo_bool_t vertical;
+
+	for (i = j = 0; i < num_active; i++) {
+	    if (active[i]->bottom > y)
+		active[j++] = active[i];
+	}
+	num_active = j;
+
+	if (num_active == 0) {
+	    int stop = next < end ? floor (next->top) : self->height;
+
+	    if (stop > y) {
+		status = renderer->render_rows (renderer, self->ymin + y,
+						stop - y, NULL, 0);
+		if (unlikely (status))
+		    return status;
+		y = stop;
+		continue;
+	    }
+	}
+
+	while (next < end && next->top < y + 1)
+	    active[num_active++] = next++;
+
+	min = self->width;
+	max = -1;
+	vertical = TRUE;
+	for (i = 0; i < num_active; i++) {
+	    const struct edge *e = active[i];
+	    double top = e->top > y ? e->top : y;
+	    double bottom = e->bottom < y + 1 ? e->bottom : y + 1;
+
+	    if (e->dxdy != 0. || top != y || bottom != y + 1)
+		vertical = FALSE;
+
+	    accumulate (self->cells, self->width,
+			e->x + (top - e->top) * e->dxdy,
+			e->x + (bottom - e->top) * e->dxdy,
+			e->dir * (bottom - top),
+			&min, &max);
+	}
+
+	height = 1;
+	if (vertical) {
+	    int stop = next < end ? floor (next->top) : self->height;
+
+	    for (i = 0; i < num_active; i++) {
+		int bottom = floor (active[i]->bottom);
+		if (bottom < stop)
+		    stop = bottom;
+	    }
+	    if (stop > y + 1)
+		height = stop - y;
+	}
+
+	if (max < min) {
+	    status = renderer->render_rows (renderer, self->ymin + y,
+					    height, NULL, 0);
+	} else {
+	    status = render_row (self, y, height, min, max, renderer);
+	}
+	if (unlikely (status))
+	    return status;
+
+	y += height;
+    }
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+cairo_status_t
+_cairo_area_scan_converter_add_polygon (void		*converter,
+					const cairo_polygon_t	*polygon)
+{
+    cairo_area_scan_converter_t *self = converter;
+    int i, num_edges;
+
+    if (unlikely (self->base.status))
+	return self->base.status;
+
+    if (polygon->num_edges > (int) ARRAY_LENGTH (self->edges_embedded)) {
+	self->edges = _cairo_malloc_ab (polygon->num_edges,
+					sizeof (struct edge));
+	self->active = _cairo_malloc_ab (polygon->num_edges,
+					 sizeof (struct edge *));
+	if (unlikely (self->edges == NULL || self->active == NULL))
+	    return _cairo_scan_converter_set_error (self,
+						    _cairo_error (CAIRO_STATUS_NO_MEMORY));
+    }
+
+    num_edges = 0;
+    for (i = 0; i < polygon->num_edges; i++) {
+	const cairo_edge_t *edge = &polygon->edges[i];
+	struct edge *e = &self->edges[num_edges];
+	double x1, y1, dy;
+
+	if (edge->top >= edge->bottom)
+	    continue;
+
+	e->top = _cairo_fixed_to_double (edge->top) - self->ymin;
+	e->bottom = _cairo_fixed_to_double (edge->bottom) - self->ymin;
+	if (e->bottom <= 0 || e->top >= self->height)
+	    continue;
+	if (e->top < 0)
+	    e->top = 0;
+	if (e->bottom > self->height)
+	    e->bottom = self->height;
+
+	x1 = _cairo_fixed_to_double (edge->line.p1.x) - self->xmin;
+	y1 = _cairo_fixed_to_double (edge->line.p1.y) - self->ymin;
+	dy = _cairo_fixed_to_double (edge->line.p2.y) - self->ymin - y1;
+	e->dxdy = (_cairo_fixed_to_double (edge->line.p2.x) - self->xmin - x1) / dy;
+	e->x = x1 + (e->top - y1) * e->dxdy;
+	e->dir = edge->dir;
+	num_edges++;
+    }
+
+    sort_edges (self->edges, num_edges);
+    self->num_edges = num_edges;
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static void
+_cairo_area_scan_converter_destroy (void *converter)
+{
+    cairo_area_scan_converter_t *self = converter;
+
+    if (self->edges != self->edges_embedded)
+	free (self->edges);
+    if (self->active != self->active_embedded)
+	free (self->active);
+    free (self);
+}
+
+cairo_scan_converter_t *
+_cairo_area_scan_converter_create (int			xmin,
+				   int			ymin,
+				   int			xmax,
+				   int			ymax,
+				   cairo_fill_rule_t	fill_rule,
+				   cairo_antialias_t	antialias)
+{
+    cairo_area_scan_converter_t *self;
+    int width = xmax - xmin;
+
+    self = _cairo_malloc_ab_plus_c (width + 1,
+				    sizeof (float) + sizeof (cairo_half_open_span_t),
+				    sizeof (cairo_area_scan_converter_t));
+    if (unlikely (self == NULL))
+	return _cairo_scan_converter_create_in_error (_cairo_error (CAIRO_STATUS_NO_MEMORY));
+
+    self->base.destroy = _cairo_area_scan_converter_destroy;
+    self->base.generate = _cairo_area_scan_converter_generate;
+    self->base.status = CAIRO_STATUS_SUCCESS;
+
+    self->xmin = xmin;
+    self->ymin = ymin;
+    self->width = width;
+    self->height = ymax - ymin;
+
+    self->fill_rule = fill_rule;
+    self->antialias = antialias;
+
+    self->edges = self->edges_embedded;
+    self->active = self->active_embedded;
+    self->num_edges = 0;
+
+    self->cells = (float *) (self + 1);
+    self->spans = (cairo_half_open_span_t *) (self->cells + width + 1);
+    memset (self->cells, 0, (width + 1) * sizeof (float));
+
+    return &self->base;
+}
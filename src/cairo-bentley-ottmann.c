@@ -41,6 +41,7 @@
 #include "cairo-error-private.h"
 #include "cairo-freelist-private.h"
 #include "cairo-combsort-inline.h"
+#include "cairo-thread-pool-private.h"
 #include "cairo-traps-private.h"
 
 #define DEBUG_PRINT_STATE 0
@@ -1043,6 +1044,102 @@ CAIRO_COMBSORT_DECLARE (_cairo_bo_event_queue_sort,
 			cairo_bo_event_t *,
 			cairo_bo_event_compare)
 
+/* Beyond this many edges we radix sort the start events rather than
+ * use the comparison sort. */
+#define BO_RADIX_SORT_THRESHOLD 256
+
+typedef struct _cairo_bo_sort_key {
+    uint64_t key;
+    uint32_t index;
+} cairo_bo_sort_key_t;
+
+/* All start events share the same type, so cairo_bo_event_compare()
+ * reduces to ordering by (y, x) and then by address. As the events
+ * are stored in input order, a stable LSD radix sort of their biased
+ * coordinates reproduces exactly the same order in linear time.
+ *
+ * Once sorted, the events are permuted in place into that order. The
+ * sweep then walks the array sequentially, and edges which become
+ * active together sit next to each other in memory, so traversing
+ * the sweep line touches far fewer cache lines.
+ */
+static cairo_status_t
+_cairo_bo_start_events_radix_sort (cairo_bo_start_event_t *events,
+				   int num_events)
+{
+    cairo_bo_sort_key_t *keys, *tmp, *src, *dst;
+    unsigned int count[8][256];
+    int i, j, pass;
+
+    keys = _cairo_malloc_ab (num_events, 2 * sizeof (cairo_bo_sort_key_t));
+    if (unlikely (keys == NULL))
+	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+    tmp = keys + num_events;
+
+    memset (count, 0, sizeof (count));
+    for (i = 0; i < num_events; i++) {
+	uint64_t key;
+
+	key = (uint64_t) ((uint32_t) events[i].point.y ^ 0x80000000) << 32;
+	key |= (uint32_t) events[i].point.x ^ 0x80000000;
+	keys[i].key = key;
+	keys[i].index = i;
+
+	for (pass = 0; pass < 8; pass++)
+	    count[pass][(key >> (8 * pass)) & 0xff]++;
+    }
+
+    src = keys;
+    dst = tmp;
+    for (pass = 0; pass < 8; pass++) {
+	unsigned int offset[256], sum;
+	int shift = 8 * pass;
+
+	/* skip the digits shared by every key */
+	if (count[pass][(src[0].key >> shift) & 0xff] == (unsigned) num_events)
+	    continue;
+
+	for (sum = j = 0; j < 256; j++) {
+	    offset[j] = sum;
+	    sum += count[pass][j];
+	}
+
+	for (i = 0; i < num_events; i++)
+	    dst[offset[(src[i].key >> shift) & 0xff]++] = src[i];
+
+	tmp = src;
+	src = dst;
+	dst = tmp;
+    }
+
+    /* Apply the permutation by following its cycles, marking each
+     * slot as done as it is filled. */
+    for (i = 0; i < num_events; i++) {
+	cairo_bo_start_event_t event;
+
+	if (src[i].index == (uint32_t) i)
+	    continue;
+
+	event = events[i];
+	j = i;
+	do {
+	    int k = src[j].index;
+
+	    src[j].index = j;
+	    if (k == i) {
+		events[j] = event;
+		break;
+	    }
+
+	    events[j] = events[k];
+	    j = k;
+	} while (TRUE);
+    }
+
+    free (keys);
+    return CAIRO_STATUS_SUCCESS;
+}
+
 static void
 _cairo_bo_event_queue_init (cairo_bo_event_queue_t	 *event_queue,
 			    cairo_bo_event_t		**start_events,
@@ -1685,10 +1782,10 @@ _cairo_bentley_ottmann_tessellate_bo_edges (cairo_bo_event_t   **start_events,
     return status;
 }
 
-cairo_status_t
-_cairo_bentley_ottmann_tessellate_polygon (cairo_traps_t	 *traps,
-					   const cairo_polygon_t *polygon,
-					   cairo_fill_rule_t	  fill_rule)
+static cairo_status_t
+_cairo_bentley_ottmann_tessellate_polygon_serial (cairo_traps_t	 *traps,
+						  const cairo_polygon_t *polygon,
+						  cairo_fill_rule_t	 fill_rule)
 {
     int intersections;
     cairo_status_t status;
@@ -1704,7 +1801,7 @@ _cairo_bentley_ottmann_tessellate_polygon (cairo_traps_t	 *traps,
     if (unlikely (0 == num_events))
 	return CAIRO_STATUS_SUCCESS;
 
-    if (polygon->num_limits) {
+    if (polygon->num_limits && num_events <= BO_RADIX_SORT_THRESHOLD) {
 	ymin = _cairo_fixed_integer_floor (polygon->limit.p1.y);
 	ymax = _cairo_fixed_integer_ceil (polygon->limit.p2.y) - ymin;
 
@@ -1759,6 +1856,13 @@ _cairo_bentley_ottmann_tessellate_polygon (cairo_traps_t	 *traps,
 	}
 	if (event_y != stack_event_y)
 	    free (event_y);
+    } else if (num_events > BO_RADIX_SORT_THRESHOLD) {
+	status = _cairo_bo_start_events_radix_sort (events, num_events);
+	if (unlikely (status)) {
+	    if (events != stack_events)
+		free (events);
+	    return status;
+	}
     } else
 	_cairo_bo_event_queue_sort (event_ptrs, i);
     event_ptrs[i] = NULL;
@@ -1784,6 +1888,119 @@ _cairo_bentley_ottmann_tessellate_polygon (cairo_traps_t	 *traps,
     return status;
 }
 
+/* Polygons with fewer edges are not worth splitting across threads */
+#define BO_PARALLEL_MIN_EDGES 4096
+#define BO_CLUSTERS_PER_THREAD 4
+
+typedef struct _cairo_bo_cluster_task {
+    const cairo_polygon_cluster_t *cluster;
+    cairo_fill_rule_t fill_rule;
+    cairo_traps_t traps;
+    cairo_status_t status;
+} cairo_bo_cluster_task_t;
+
+static void
+_cairo_bo_tessellate_cluster (void *closure, int index)
+{
+    cairo_bo_cluster_task_t *task = (cairo_bo_cluster_task_t *) closure + index;
+    cairo_polygon_t polygon;
+
+    /* a read-only view of the cluster's edges */
+    polygon.status = CAIRO_STATUS_SUCCESS;
+    polygon.extents = task->cluster->extents;
+    polygon.limits = NULL;
+    polygon.num_limits = 0;
+    polygon.num_edges = task->cluster->num_edges;
+    polygon.edges_size = task->cluster->num_edges;
+    polygon.edges = task->cluster->edges;
+
+    task->status =
+	_cairo_bentley_ottmann_tessellate_polygon_serial (&task->traps,
+							  &polygon,
+							  task->fill_rule);
+}
+
+/* Tessellate the independent clusters of a large polygon on the worker
+ * threads, appending their trapezoids in turn. */
+static cairo_status_t
+_cairo_bentley_ottmann_tessellate_clusters (cairo_traps_t		  *traps,
+					    const cairo_polygon_cluster_t *clusters,
+					    int				   num_clusters,
+					    cairo_fill_rule_t		   fill_rule)
+{
+    cairo_bo_cluster_task_t *tasks;
+    cairo_status_t status;
+    int i, j;
+
+    tasks = _cairo_malloc_ab (num_clusters, sizeof (cairo_bo_cluster_task_t));
+    if (unlikely (tasks == NULL))
+	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+
+    for (i = 0; i < num_clusters; i++) {
+	tasks[i].cluster = &clusters[i];
+	tasks[i].fill_rule = fill_rule;
+	_cairo_traps_init (&tasks[i].traps);
+    }
+
+    _cairo_thread_pool_run (_cairo_bo_tessellate_cluster, tasks, num_clusters);
+
+    status = CAIRO_STATUS_SUCCESS;
+    for (i = 0; i < num_clusters; i++) {
+	cairo_bo_cluster_task_t *task = &tasks[i];
+
+	if (status == CAIRO_STATUS_SUCCESS)
+	    status = task->status;
+
+	if (status == CAIRO_STATUS_SUCCESS) {
+	    for (j = 0; j < task->traps.num_traps; j++) {
+		cairo_trapezoid_t *t = &task->traps.traps[j];
+
+		_cairo_traps_add_trap (traps, t->top, t->bottom,
+				       &t->left, &t->right);
+	    }
+	    status = traps->status;
+	}
+
+	_cairo_traps_fini (&task->traps);
+    }
+
+    free (tasks);
+    return status;
+}
+
+cairo_status_t
+_cairo_bentley_ottmann_tessellate_polygon (cairo_traps_t	 *traps,
+					   const cairo_polygon_t *polygon,
+					   cairo_fill_rule_t	  fill_rule)
+{
+    if (polygon->num_edges >= BO_PARALLEL_MIN_EDGES &&
+	_cairo_thread_pool_get_num_threads () > 1)
+    {
+	cairo_polygon_cluster_t *clusters;
+	cairo_status_t status;
+	int num_clusters;
+
+	status = _cairo_polygon_partition (polygon,
+					   _cairo_thread_pool_get_num_threads () *
+					   BO_CLUSTERS_PER_THREAD,
+					   &clusters, &num_clusters);
+	if (unlikely (status))
+	    return status;
+
+	if (num_clusters) {
+	    status = _cairo_bentley_ottmann_tessellate_clusters (traps,
+								 clusters,
+								 num_clusters,
+								 fill_rule);
+	    free (clusters);
+	    return status;
+	}
+    }
+
+    return _cairo_bentley_ottmann_tessellate_polygon_serial (traps, polygon,
+							     fill_rule);
+}
+
 cairo_status_t
 _cairo_bentley_ottmann_tessellate_traps (cairo_traps_t *traps,
 					 cairo_fill_rule_t fill_rule)
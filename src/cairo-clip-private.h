@@ -48,6 +48,14 @@
 
 extern const cairo_private cairo_rectangle_list_t _cairo_rectangles_nil;
 
+/* The rasterised coverage of a chain of clip paths, shared by every
+ * draw through the same clip to a compatible target.
+ */
+typedef struct _cairo_clip_path_coverage {
+    cairo_surface_t		*surface;
+    cairo_rectangle_int_t	 extents;
+} cairo_clip_path_coverage_t;
+
 struct _cairo_clip_path {
     cairo_reference_count_t	 ref_count;
     cairo_path_fixed_t		 path;
@@ -55,6 +63,9 @@ struct _cairo_clip_path {
     double			 tolerance;
     cairo_antialias_t		 antialias;
     cairo_clip_path_t		*prev;
+
+    cairo_clip_path_coverage_t	*coverage;
+    cairo_atomic_int_t	 num_uses; /* saturates at 1 */
 };
 
 struct _cairo_clip {
@@ -79,6 +90,17 @@ _cairo_clip_path_reference (cairo_clip_path_t *clip_path);
 cairo_private void
 _cairo_clip_path_destroy (cairo_clip_path_t *clip_path);
 
+cairo_private cairo_surface_t *
+_cairo_clip_path_get_coverage (cairo_clip_path_t *clip_path,
+			       const cairo_surface_t *target,
+			       const cairo_rectangle_int_t *extents,
+			       int *x, int *y);
+
+cairo_private void
+_cairo_clip_path_set_coverage (cairo_clip_path_t *clip_path,
+			       cairo_surface_t *surface,
+			       const cairo_rectangle_int_t *extents);
+
 cairo_private void
 _cairo_clip_destroy (cairo_clip_t *clip);
 
@@ -69,6 +69,9 @@ _cairo_clip_path_create (cairo_clip_t *clip)
 
     CAIRO_REFERENCE_COUNT_INIT (&clip_path->ref_count, 1);
 
+    clip_path->coverage = NULL;
+    clip_path->num_uses = 0;
+
     clip_path->prev = clip->path;
     clip->path = clip_path;
 
@@ -95,12 +98,72 @@ _cairo_clip_path_destroy (cairo_clip_path_t *clip_path)
 
     _cairo_path_fixed_fini (&clip_path->path);
 
+    if (clip_path->coverage != NULL) {
+	cairo_surface_destroy (clip_path->coverage->surface);
+	free (clip_path->coverage);
+    }
+
     if (clip_path->prev != NULL)
 	_cairo_clip_path_destroy (clip_path->prev);
 
     _freed_pool_put (&clip_path_pool, clip_path);
 }
 
+/* Returns a reference to the shared coverage of the clip path if it was
+ * rasterised for a target of the same kind and covers @extents, with
+ * its origin in device space in @x, @y. The clip paths are immutable,
+ * so the coverage remains valid for the lifetime of the clip path.
+ */
+cairo_surface_t *
+_cairo_clip_path_get_coverage (cairo_clip_path_t *clip_path,
+			       const cairo_surface_t *target,
+			       const cairo_rectangle_int_t *extents,
+			       int *x, int *y)
+{
+    cairo_clip_path_coverage_t *coverage;
+
+    coverage = _cairo_atomic_ptr_get ((void **) &clip_path->coverage);
+    if (coverage == NULL)
+	return NULL;
+
+    if (coverage->surface->backend != target->backend ||
+	coverage->surface->device != target->device)
+	return NULL;
+
+    if (! _cairo_rectangle_contains_rectangle (&coverage->extents, extents))
+	return NULL;
+
+    *x = coverage->extents.x;
+    *y = coverage->extents.y;
+    return cairo_surface_reference (coverage->surface);
+}
+
+/* Attach the rasterised coverage of the clip path for sharing with later
+ * draws. The surface must not be modified afterwards. Should another
+ * thread have attached its coverage first, that one is kept.
+ */
+void
+_cairo_clip_path_set_coverage (cairo_clip_path_t *clip_path,
+			       cairo_surface_t *surface,
+			       const cairo_rectangle_int_t *extents)
+{
+    cairo_clip_path_coverage_t *coverage;
+
+    coverage = malloc (sizeof (cairo_clip_path_coverage_t));
+    if (unlikely (coverage == NULL))
+	return;
+
+    coverage->surface = cairo_surface_reference (surface);
+    coverage->extents = *extents;
+
+    if (! _cairo_atomic_ptr_cmpxchg ((void **) &clip_path->coverage,
+				     NULL, coverage))
+    {
+	cairo_surface_destroy (coverage->surface);
+	free (coverage);
+    }
+}
+
 cairo_clip_t *
 _cairo_clip_create (void)
 {
@@ -292,6 +292,10 @@ struct cairo_traps_compositor {
 				 int				 dst_x,
 				 int				 dst_y,
 				 cairo_composite_glyphs_info_t  *info);
+
+    /* Set if composite_glyphs() only reads the glyphs, so that the font
+     * need not be locked against other threads drawing with it. */
+    cairo_bool_t shared_glyph_cache;
 };
 
 cairo_private extern const cairo_compositor_t __cairo_no_compositor;
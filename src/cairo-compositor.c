@@ -316,6 +316,39 @@ _cairo_compositor_fill (const cairo_compositor_t	*compositor,
     return status;
 }
 
+/* Large glyphs are filled from their outlines rather than cached as
+ * images, see cairo_glyph_cache_set_max_glyph_size(). */
+static cairo_int_status_t
+_cairo_compositor_glyph_outlines (const cairo_compositor_t	*compositor,
+				  cairo_surface_t		*surface,
+				  cairo_operator_t		 op,
+				  const cairo_pattern_t		*source,
+				  cairo_glyph_t			*glyphs,
+				  int				 num_glyphs,
+				  cairo_scaled_font_t		*scaled_font,
+				  const cairo_clip_t		*clip)
+{
+    cairo_path_fixed_t path;
+    cairo_int_status_t status;
+
+    _cairo_path_fixed_init (&path);
+
+    status = _cairo_scaled_font_glyph_outlines (scaled_font,
+						glyphs, num_glyphs,
+						&path);
+    if (status == CAIRO_INT_STATUS_SUCCESS) {
+	status = _cairo_compositor_fill (compositor, surface, op, source,
+					 &path, CAIRO_FILL_RULE_WINDING,
+					 CAIRO_GSTATE_TOLERANCE_DEFAULT,
+					 scaled_font->options.antialias,
+					 clip);
+    }
+
+    _cairo_path_fixed_fini (&path);
+
+    return status;
+}
+
 cairo_int_status_t
 _cairo_compositor_glyphs (const cairo_compositor_t		*compositor,
 			  cairo_surface_t			*surface,
@@ -333,6 +366,15 @@ _cairo_compositor_glyphs (const cairo_compositor_t		*compositor,
 
     TRACE ((stderr, "%s\n", __FUNCTION__));
 
+    if (_cairo_scaled_font_has_large_glyphs (scaled_font)) {
+	status = _cairo_compositor_glyph_outlines (compositor, surface,
+						   op, source,
+						   glyphs, num_glyphs,
+						   scaled_font, clip);
+	if (status != CAIRO_INT_STATUS_UNSUPPORTED)
+	    return status;
+    }
+
     if (compositor->lazy_init) {
 	status = _cairo_composite_rectangles_lazy_init_for_glyphs (&extents, surface,
 								  op, source,
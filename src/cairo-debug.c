@@ -35,6 +35,7 @@
 
 #include "cairoint.h"
 #include "cairo-image-surface-private.h"
+#include "cairo-thread-pool-private.h"
 
 /**
  * cairo_debug_reset_static_data:
@@ -85,6 +86,11 @@ cairo_debug_reset_static_data (void)
     _cairo_clip_reset_static_data ();
 
     _cairo_image_reset_static_data ();
+    _cairo_image_compositor_reset_static_data ();
+    _cairo_image_scratch_reset_static_data ();
+    _cairo_spans_compositor_reset_static_data ();
+
+    _cairo_pen_reset_static_data ();
 
 #if CAIRO_HAS_DRM_SURFACE
     _cairo_drm_device_reset_static_data ();
@@ -92,6 +98,8 @@ cairo_debug_reset_static_data (void)
 
     _cairo_default_context_reset_static_data ();
 
+    _cairo_thread_pool_reset_static_data ();
+
 #if CAIRO_HAS_COGL_SURFACE
     _cairo_cogl_context_reset_static_data ();
 #endif
@@ -1865,6 +1865,16 @@ _cairo_ft_font_face_scaled_font_create (void		    *abstract_font_face,
 	return status;
     }
 
+    /* outlines can be rendered at any subpixel offset, see
+     * _cairo_ft_scaled_glyph_init(), but embedded bitmaps cannot be
+     * moved, so faces that may load them are left on whole pixels */
+    if (FT_IS_SCALABLE (face) &&
+	(! FT_HAS_FIXED_SIZES (face) ||
+	 (scaled_font->ft_options.load_flags & FT_LOAD_NO_BITMAP)) &&
+	scaled_font->ft_options.base.antialias != CAIRO_ANTIALIAS_NONE)
+    {
+	_cairo_scaled_font_enable_glyph_phases (&scaled_font->base);
+    }
 
     metrics = &face->size->metrics;
 
@@ -2112,6 +2122,17 @@ _cairo_ft_scaled_glyph_vertical_layout_bearing_fix (void        *abstract_font,
     }
 }
 
+/* The glyph index within the face, without the phase of the variant. */
+static unsigned long
+_cairo_ft_scaled_glyph_index (cairo_ft_scaled_font_t *scaled_font,
+			      cairo_scaled_glyph_t   *scaled_glyph)
+{
+    if (scaled_font->base.glyph_phases)
+	return _cairo_scaled_glyph_font_index (scaled_glyph);
+
+    return _cairo_scaled_glyph_index (scaled_glyph);
+}
+
 static cairo_int_status_t
 _cairo_ft_scaled_glyph_init (void			*abstract_font,
 			     cairo_scaled_glyph_t	*scaled_glyph,
@@ -2155,7 +2176,7 @@ _cairo_ft_scaled_glyph_init (void			*abstract_font,
     }
 
     error = FT_Load_Glyph (face,
-			   _cairo_scaled_glyph_index(scaled_glyph),
+			   _cairo_ft_scaled_glyph_index (scaled_font, scaled_glyph),
 			   load_flags);
     /* XXX ignoring all other errors for now.  They are not fatal, typically
      * just a glyph-not-found. */
@@ -2283,6 +2304,13 @@ _cairo_ft_scaled_glyph_init (void			*abstract_font,
 	cairo_image_surface_t	*surface;
 
 	if (glyph->format == FT_GLYPH_FORMAT_OUTLINE) {
+	    if (scaled_font->base.glyph_phases) {
+		FT_Outline_Translate (&glyph->outline,
+				      _cairo_scaled_glyph_xphase (scaled_glyph) *
+				      (64 / CAIRO_SCALED_GLYPH_XPHASES),
+				      0);
+	    }
+
 	    status = _render_glyph_outline (face, &scaled_font->ft_options.base,
 					    &surface);
 	} else {
@@ -2314,7 +2342,7 @@ _cairo_ft_scaled_glyph_init (void			*abstract_font,
 	 */
 	if ((info & CAIRO_SCALED_GLYPH_INFO_SURFACE) != 0) {
 	    error = FT_Load_Glyph (face,
-				   _cairo_scaled_glyph_index(scaled_glyph),
+				   _cairo_ft_scaled_glyph_index (scaled_font, scaled_glyph),
 				   load_flags | FT_LOAD_NO_BITMAP);
 	    /* XXX ignoring all other errors for now.  They are not fatal, typically
 	     * just a glyph-not-found. */
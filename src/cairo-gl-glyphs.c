@@ -73,7 +73,7 @@ _cairo_gl_node_destroy (cairo_rtree_node_t *node)
 	    glyph->dev_private = NULL;
 	    glyph->dev_private_key = NULL;
     }
-    cairo_list_del (&priv->base.link);
+    _cairo_scaled_glyph_detach_private (glyph, &priv->base);
     priv->glyph = NULL;
 }
 
@@ -0,0 +1,595 @@
+/* cairo - a vector graphics library with display and print output
+ *
+ * Copyright © 2012 Samsung Electronics
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it either under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * (the "LGPL") or, at your option, under the terms of the Mozilla
+ * Public License Version 1.1 (the "MPL"). If you do not alter this
+ * notice, a recipient may use your version of this file under either
+ * the MPL or the LGPL.
+ *
+ * You should have received a copy of the LGPL along with this library
+ * in the file COPYING-LGPL-2.1; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA 02110-1335, USA
+ * You should have received a copy of the MPL along with this library
+ * in the file COPYING-MPL-1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License
+ * Version 1.1 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY
+ * OF ANY KIND, either express or implied. See the LGPL or the MPL for
+ * the specific language governing rights and limitations.
+ *
+ * The Original Code is the cairo graphics library.
+ *
+ * The Initial Developer of the Original Code is Samsung Electronics.
+ */
+
+/* A scan converter for strokes no wider than a device pixel.
+ *
+ * Such thin lines gain nothing from being stroked into a polygon and
+ * tessellated: instead each segment is walked along its major axis,
+ * Wu-style, and every column (or row) it crosses receives the overlap
+ * of the pixels with the stroke's thickness measured along the minor
+ * axis, centred upon the line. Partial columns at the ends of segments
+ * are weighted by how much of the column they span, so the coverage
+ * matches the exact area for horizontal and vertical lines and is an
+ * approximation for the rest, sampling the thickness at the middle of
+ * each column.
+ *
+ * Each cell remembers which part of its column it spans, so where
+ * several segments deposit into one pixel their partial coverages are
+ * added, as along a finely flattened curve, whilst over the part of the
+ * column that they share only the greatest is counted, as the union of
+ * a stroke must never be darker than any of its parts. Segments that
+ * are walked along different axes cannot be related in this way, and
+ * the pixel takes the greater of their two sums.
+ *
+ * The touched pixels are gathered into a list of cells, bucketed into
+ * rows and sorted, and identical consecutive rows, as produced by
+ * vertical lines, are rendered together.
+ */
+
+#include "cairoint.h"
+
+#include "cairo-spans-private.h"
+#include "cairo-error-private.h"
+#include "cairo-combsort-inline.h"
+
+#include <math.h>
+
+/* A cell holds the thickness of the stroke across a pixel, as density
+ * 0..255, over the interval [lo, hi) of the pixel along the segment's
+ * major axis, in 256ths. */
+struct cell {
+    int x, y;
+    short density;
+    unsigned short lo, hi;
+    short x_major;
+};
+
+typedef struct _cairo_hairline_scan_converter {
+    cairo_scan_converter_t base;
+
+    int xmin, ymin;
+    int width, height;
+
+    double line_width;
+    cairo_line_cap_t cap;
+
+    /* The first and last segments of the current subpath are held back
+     * until we know whether it is closed, and so whether to cap them. */
+    double start_x, start_y;
+    double current_x, current_y;
+    double first[4], last[4];
+    cairo_bool_t has_first, has_last, has_point;
+
+    struct cell *cells;
+    int num_cells, size_cells;
+
+    struct cell cells_embedded[256];
+} cairo_hairline_scan_converter_t;
+
+#define cell_compare_x(a, b) ((a).x - (b).x)
+CAIRO_COMBSORT_DECLARE (sort_cells, struct cell, cell_compare_x)
+
+static void
+add_cell (cairo_hairline_scan_converter_t *self,
+	  cairo_bool_t x_major, int x, int y,
+	  double density, int lo, int hi)
+{
+    struct cell *cell;
+    int a;
+
+    if ((unsigned) x >= (unsigned) self->width ||
+	(unsigned) y >= (unsigned) self->height)
+	return;
+
+    a = density * 255 + .5;
+    if (a <= 0 || hi <= lo)
+	return;
+
+    if (unlikely (self->num_cells == self->size_cells)) {
+	int size = 2 * self->size_cells;
+	struct cell *cells;
+
+	if (self->cells == self->cells_embedded) {
+	    cells = _cairo_malloc_ab (size, sizeof (struct cell));
+	    if (cells != NULL)
+		memcpy (cells, self->cells, self->num_cells * sizeof (struct cell));
+	} else {
+	    cells = _cairo_realloc_ab (self->cells, size, sizeof (struct cell));
+	}
+	if (unlikely (cells == NULL)) {
+	    self->base.status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
+	    return;
+	}
+
+	self->cells = cells;
+	self->size_cells = size;
+    }
+
+    cell = &self->cells[self->num_cells++];
+    cell->x = x;
+    cell->y = y;
+    cell->density = a > 255 ? 255 : a;
+    cell->lo = lo;
+    cell->hi = hi;
+    cell->x_major = x_major;
+}
+
+/* Deposit the interval [v0, v1) across the minor axis at major
+ * position u, over the part [lo, hi) of the pixel spanned. */
+static void
+add_interval (cairo_hairline_scan_converter_t *self,
+	      cairo_bool_t x_major, int u,
+	      double v0, double v1, int lo, int hi)
+{
+    int v;
+
+    for (v = floor (v0); v < v1; v++) {
+	double a = v0 > v ? v0 : v;
+	double b = v1 < v + 1 ? v1 : v + 1;
+
+	if (x_major)
+	    add_cell (self, TRUE, u, v, b - a, lo, hi);
+	else
+	    add_cell (self, FALSE, v, u, b - a, lo, hi);
+    }
+}
+
+static void
+add_segment (cairo_hairline_scan_converter_t *self,
+	     double x1, double y1, double x2, double y2)
+{
+    double u1, v1, u2, v2, m, t, end;
+    cairo_bool_t x_major;
+    int u;
+
+    x_major = fabs (x2 - x1) >= fabs (y2 - y1);
+    if (x_major) {
+	u1 = x1; v1 = y1;
+	u2 = x2; v2 = y2;
+	end = self->width;
+    } else {
+	u1 = y1; v1 = x1;
+	u2 = y2; v2 = x2;
+	end = self->height;
+    }
+
+    if (u1 == u2)
+	return;
+
+    if (u1 > u2) {
+	double tmp;
+
+	tmp = u1; u1 = u2; u2 = tmp;
+	tmp = v1; v1 = v2; v2 = tmp;
+    }
+
+    /* the thickness of the line measured along the minor axis */
+    m = (v2 - v1) / (u2 - u1);
+    t = .5 * self->line_width * sqrt (1 + m * m);
+
+    if (u2 > end)
+	u2 = end;
+    for (u = floor (u1 > 0 ? u1 : 0); u < u2; u++) {
+	double a = u1 > u ? u1 : u;
+	double b = u2 < u + 1 ? u2 : u + 1;
+	double v = v1 + (.5 * (a + b) - u1) * m;
+
+	add_interval (self, x_major, u, v - t, v + t,
+		      (a - u) * 256 + .5, (b - u) * 256 + .5);
+    }
+}
+
+/* Adds a segment, extending the ends that need to be capped */
+static void
+add_capped_segment (cairo_hairline_scan_converter_t *self,
+		    const double s[4],
+		    cairo_bool_t cap_start,
+		    cairo_bool_t cap_end)
+{
+    double x1 = s[0], y1 = s[1], x2 = s[2], y2 = s[3];
+
+    if (self->cap != CAIRO_LINE_CAP_BUTT && (cap_start || cap_end)) {
+	double dx = x2 - x1, dy = y2 - y1;
+	double scale = .5 * self->line_width / sqrt (dx * dx + dy * dy);
+
+	dx *= scale;
+	dy *= scale;
+	if (cap_start) {
+	    x1 -= dx;
+	    y1 -= dy;
+	}
+	if (cap_end) {
+	    x2 += dx;
+	    y2 += dy;
+	}
+    }
+
+    add_segment (self, x1, y1, x2, y2);
+}
+
+static void
+finish_subpath (cairo_hairline_scan_converter_t *self, cairo_bool_t closed)
+{
+    if (self->has_first) {
+	if (self->has_last) {
+	    add_capped_segment (self, self->first, ! closed, FALSE);
+	    add_capped_segment (self, self->last, FALSE, ! closed);
+	} else {
+	    add_capped_segment (self, self->first, ! closed, ! closed);
+	}
+    } else if (self->has_point && self->cap != CAIRO_LINE_CAP_BUTT) {
+	double w = .5 * self->line_width;
+
+	/* a degenerate subpath is drawn as a dot */
+	add_segment (self,
+		     self->current_x - w, self->current_y,
+		     self->current_x + w, self->current_y);
+    }
+
+    self->has_first = self->has_last = self->has_point = FALSE;
+}
+
+static cairo_status_t
+_hairline_move_to (void *closure, const cairo_point_t *point)
+{
+    cairo_hairline_scan_converter_t *self = closure;
+
+    finish_subpath (self, FALSE);
+
+    self->start_x = self->current_x = _cairo_fixed_to_double (point->x) - self->xmin;
+    self->start_y = self->current_y = _cairo_fixed_to_double (point->y) - self->ymin;
+    self->has_point = TRUE;
+
+    return self->base.status;
+}
+
+static void
+add_line_to (cairo_hairline_scan_converter_t *self, double x, double y)
+{
+    double *s;
+
+    if (x == self->current_x && y == self->current_y) {
+	self->has_point = TRUE;
+	return;
+    }
+
+    if (! self->has_first) {
+	s = self->first;
+	self->has_first = TRUE;
+    } else {
+	if (self->has_last)
+	    add_segment (self, self->last[0], self->last[1], self->last[2], self->last[3]);
+	s = self->last;
+	self->has_last = TRUE;
+    }
+
+    s[0] = self->current_x;
+    s[1] = self->current_y;
+    s[2] = self->current_x = x;
+    s[3] = self->current_y = y;
+}
+
+static cairo_status_t
+_hairline_line_to (void *closure, const cairo_point_t *point)
+{
+    cairo_hairline_scan_converter_t *self = closure;
+
+    add_line_to (self,
+		 _cairo_fixed_to_double (point->x) - self->xmin,
+		 _cairo_fixed_to_double (point->y) - self->ymin);
+
+    return self->base.status;
+}
+
+static cairo_status_t
+_hairline_close_path (void *closure)
+{
+    cairo_hairline_scan_converter_t *self = closure;
+    cairo_bool_t closed = self->has_first;
+
+    if (closed)
+	add_line_to (self, self->start_x, self->start_y);
+    finish_subpath (self, closed);
+
+    self->current_x = self->start_x;
+    self->current_y = self->start_y;
+
+    return self->base.status;
+}
+
+cairo_status_t
+_cairo_hairline_scan_converter_add_path (void			 *converter,
+					 const cairo_path_fixed_t *path,
+					 double			  tolerance)
+{
+    cairo_hairline_scan_converter_t *self = converter;
+    cairo_status_t status;
+
+    if (unlikely (self->base.status))
+	return self->base.status;
+
+    status = _cairo_path_fixed_interpret_flat (path,
+					       _hairline_move_to,
+					       _hairline_line_to,
+					       _hairline_close_path,
+					       self,
+					       tolerance);
+    if (likely (status == CAIRO_STATUS_SUCCESS))
+	finish_subpath (self, FALSE);
+
+    if (unlikely (status))
+	return _cairo_scan_converter_set_error (self, status);
+
+    return self->base.status;
+}
+
+/* Sums the coverage of the cells along one axis within a pixel, taking
+ * the greatest density wherever their intervals overlap. */
+static int
+cells_coverage (const struct cell *cell, const struct cell *end,
+		cairo_bool_t x_major)
+{
+    unsigned char best[256];
+    int lo = 256, hi = 0, sum = 0, i;
+    const struct cell *c;
+
+    for (c = cell; c < end; c++) {
+	if (c->x_major != x_major)
+	    continue;
+	if (c->lo < lo)
+	    lo = c->lo;
+	if (c->hi > hi)
+	    hi = c->hi;
+    }
+    if (hi <= lo)
+	return 0;
+
+    memset (best + lo, 0, hi - lo);
+    for (c = cell; c < end; c++) {
+	if (c->x_major != x_major)
+	    continue;
+	for (i = c->lo; i < c->hi; i++) {
+	    if (c->density > best[i])
+		best[i] = c->density;
+	}
+    }
+
+    for (i = lo; i < hi; i++)
+	sum += best[i];
+    return (sum + 128) >> 8;
+}
+
+/* Converts the sorted cells of a row into spans, combining the cells
+ * of each pixel. */
+static int
+row_to_spans (cairo_hairline_scan_converter_t *self,
+	      const struct cell *cell, const struct cell *end,
+	      cairo_half_open_span_t *spans)
+{
+    int num_spans = 0, last = -1;
+
+    while (cell < end) {
+	const struct cell *first = cell;
+	int x = cell->x, a;
+
+	for (cell++; cell < end && cell->x == x; cell++)
+	    ;
+
+	if (cell - first == 1) {
+	    a = (first->density * (first->hi - first->lo) + 128) >> 8;
+	} else {
+	    int b;
+
+	    a = cells_coverage (first, cell, TRUE);
+	    b = cells_coverage (first, cell, FALSE);
+	    if (b > a)
+		a = b;
+	    if (a > 255)
+		a = 255;
+	}
+	if (a == 0)
+	    continue;
+
+	if (last != x) {
+	    if (num_spans) {
+		spans[num_spans].x = self->xmin + last;
+		spans[num_spans].coverage = 0;
+		spans[num_spans].inverse = 0;
+		num_spans++;
+	    }
+	} else if (spans[num_spans-1].coverage == a) {
+	    last = x + 1;
+	    continue;
+	}
+
+	spans[num_spans].x = self->xmin + x;
+	spans[num_spans].coverage = a;
+	spans[num_spans].inverse = 0;
+	num_spans++;
+	last = x + 1;
+    }
+
+    if (num_spans) {
+	spans[num_spans].x = self->xmin + last;
+	spans[num_spans].coverage = 0;
+	spans[num_spans].inverse = 0;
+	num_spans++;
+    }
+
+    return num_spans;
+}
+
+static cairo_bool_t
+spans_equal (const cairo_half_open_span_t *a,
+	     const cairo_half_open_span_t *b,
+	     int num_spans)
+{
+    int i;
+
+    for (i = 0; i < num_spans; i++) {
+	if (a[i].x != b[i].x || a[i].coverage != b[i].coverage)
+	    return FALSE;
+    }
+
+    return TRUE;
+}
+
+static cairo_status_t
+_cairo_hairline_scan_converter_generate (void			*converter,
+					 cairo_span_renderer_t	*renderer)
+{
+    cairo_hairline_scan_converter_t *self = converter;
+    cairo_half_open_span_t *spans, *prev;
+    struct cell *cells;
+    int *rows;
+    int num_prev, height, y, i;
+    cairo_status_t status;
+    void *buf;
+
+    if (unlikely (self->base.status))
+	return self->base.status;
+
+    buf = _cairo_malloc_ab_plus_c (self->num_cells, sizeof (struct cell),
+				   2 * (self->width + 1) * sizeof (cairo_half_open_span_t) +
+				   (self->height + 1) * sizeof (int));
+    if (unlikely (buf == NULL))
+	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+
+    spans = buf;
+    prev = spans + self->width + 1;
+    rows = (int *) (prev + self->width + 1);
+    cells = (struct cell *) (rows + self->height + 1);
+
+    /* bucket the cells into rows, then sort each row */
+    memset (rows, 0, (self->height + 1) * sizeof (int));
+    for (i = 0; i < self->num_cells; i++)
+	rows[self->cells[i].y + 1]++;
+    for (y = 0; y < self->height; y++)
+	rows[y + 1] += rows[y];
+    for (i = 0; i < self->num_cells; i++)
+	cells[rows[self->cells[i].y]++] = self->cells[i];
+    for (y = self->height; y > 0; y--)
+	rows[y] = rows[y - 1];
+    rows[0] = 0;
+
+    num_prev = 0;
+    height = 0;
+    for (y = 0; y < self->height; y++) {
+	int num_spans;
+
+	if (rows[y + 1] - rows[y] > 1)
+	    sort_cells (cells + rows[y], rows[y + 1] - rows[y]);
+	num_spans = row_to_spans (self,
+				  cells + rows[y], cells + rows[y + 1],
+				  spans);
+	if (height && num_spans == num_prev &&
+	    spans_equal (spans, prev, num_spans))
+	{
+	    height++;
+	    continue;
+	}
+
+	if (height) {
+	    status = renderer->render_rows (renderer, self->ymin + y - height,
+					    height,
+					    num_prev ? prev : NULL, num_prev);
+	    if (unlikely (status))
+		goto out;
+	}
+
+	{
+	    cairo_half_open_span_t *tmp = prev;
+	    prev = spans;
+	    spans = tmp;
+	}
+	num_prev = num_spans;
+	height = 1;
+    }
+
+    status = CAIRO_STATUS_SUCCESS;
+    if (height) {
+	status = renderer->render_rows (renderer, self->ymin + y - height,
+					height,
+					num_prev ? prev : NULL, num_prev);
+    }
+
+out:
+    free (buf);
+    return status;
+}
+
+static void
+_cairo_hairline_scan_converter_destroy (void *converter)
+{
+    cairo_hairline_scan_converter_t *self = converter;
+
+    if (self->cells != self->cells_embedded)
+	free (self->cells);
+    free (self);
+}
+
+cairo_scan_converter_t *
+_cairo_hairline_scan_converter_create (int			xmin,
+				       int			ymin,
+				       int			xmax,
+				       int			ymax,
+				       double			line_width,
+				       cairo_line_cap_t		line_cap)
+{
+    cairo_hairline_scan_converter_t *self;
+
+    self = malloc (sizeof (cairo_hairline_scan_converter_t));
+    if (unlikely (self == NULL))
+	return _cairo_scan_converter_create_in_error (_cairo_error (CAIRO_STATUS_NO_MEMORY));
+
+    self->base.destroy = _cairo_hairline_scan_converter_destroy;
+    self->base.generate = _cairo_hairline_scan_converter_generate;
+    self->base.status = CAIRO_STATUS_SUCCESS;
+
+    self->xmin = xmin;
+    self->ymin = ymin;
+    self->width = xmax - xmin;
+    self->height = ymax - ymin;
+
+    self->line_width = line_width;
+    self->cap = line_cap;
+
+    self->current_x = self->current_y = 0;
+    self->start_x = self->start_y = 0;
+    self->has_first = self->has_last = self->has_point = FALSE;
+
+    self->cells = self->cells_embedded;
+    self->num_cells = 0;
+    self->size_cells = ARRAY_LENGTH (self->cells_embedded);
+
+    return &self->base;
+}
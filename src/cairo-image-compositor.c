@@ -49,6 +49,7 @@
 #include "cairo-spans-compositor-private.h"
 
 #include "cairo-region-private.h"
+#include "cairo-rtree-private.h"
 #include "cairo-traps-private.h"
 #include "cairo-tristrip-private.h"
 
@@ -655,9 +656,9 @@ composite_traps (void			*_dst,
 	return CAIRO_STATUS_SUCCESS;
     }
 
-    mask = pixman_image_create_bits (format,
-				     extents->width, extents->height,
-				     NULL, 0);
+    mask = _pixman_image_create_scratch (format,
+					 extents->width, extents->height,
+					 TRUE, NULL);
     if (unlikely (mask == NULL))
 	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
 
@@ -731,9 +732,9 @@ composite_tristrip (void			*_dst,
 	return CAIRO_STATUS_SUCCESS;
     }
 
-    mask = pixman_image_create_bits (format,
-				     extents->width, extents->height,
-				     NULL, 0);
+    mask = _pixman_image_create_scratch (format,
+					 extents->width, extents->height,
+					 TRUE, NULL);
     if (unlikely (mask == NULL))
 	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
 
@@ -759,6 +760,320 @@ check_composite_glyphs (const cairo_composite_rectangles_t *extents,
     return CAIRO_STATUS_SUCCESS;
 }
 
+/* A persistent atlas of A8 glyph masks shared by all image surfaces.
+ *
+ * Rather than compositing every glyph into the temporary mask with
+ * pixman, glyphs are uploaded once into a single plane (evicting at
+ * random when full, as per the GL glyph cache) and then added into the
+ * mask with a straight saturating copy from the atlas. The memory used
+ * is bounded by the size of the plane.
+ *
+ * _cairo_image_glyph_cache_mutex is a leaf lock: the glyphs must be
+ * looked up (which may evict glyph pages and so call back into
+ * _image_glyph_fini) before it is taken.
+ */
+#define GLYPH_CACHE_WIDTH 1024
+#define GLYPH_CACHE_HEIGHT 1024
+#define GLYPH_CACHE_MIN_SIZE 4
+#define GLYPH_CACHE_MAX_SIZE 128
+#define GLYPH_CACHE_BATCH 64
+
+typedef struct _image_glyph_node image_glyph_node_t;
+
+typedef struct _image_glyph {
+    cairo_scaled_glyph_private_t base;
+    image_glyph_node_t *node;
+} image_glyph_t;
+
+struct _image_glyph_node {
+    cairo_rtree_node_t node;
+    image_glyph_t *glyph;
+};
+
+static struct _image_glyph_cache {
+    cairo_rtree_t rtree;
+    uint8_t *data;
+} image_glyph_cache;
+
+static void
+_image_glyph_node_destroy (cairo_rtree_node_t *node)
+{
+    image_glyph_node_t *priv = (image_glyph_node_t *) node;
+
+    /* evicted, the glyph is refetched on its next use */
+    if (priv->glyph != NULL) {
+	priv->glyph->node = NULL;
+	priv->glyph = NULL;
+    }
+}
+
+static void
+_image_glyph_fini (cairo_scaled_glyph_private_t *glyph_private,
+		   cairo_scaled_glyph_t *scaled_glyph,
+		   cairo_scaled_font_t  *scaled_font)
+{
+    image_glyph_t *glyph = cairo_container_of (glyph_private,
+					       image_glyph_t,
+					       base);
+
+    CAIRO_MUTEX_LOCK (_cairo_image_glyph_cache_mutex);
+    if (glyph->node != NULL) {
+	glyph->node->glyph = NULL;
+	_cairo_rtree_node_remove (&image_glyph_cache.rtree,
+				  &glyph->node->node);
+    }
+    CAIRO_MUTEX_UNLOCK (_cairo_image_glyph_cache_mutex);
+
+    _cairo_scaled_glyph_detach_private (scaled_glyph, glyph_private);
+    free (glyph);
+}
+
+void
+_cairo_image_compositor_reset_static_data (void)
+{
+    CAIRO_MUTEX_LOCK (_cairo_image_glyph_cache_mutex);
+    if (image_glyph_cache.data != NULL) {
+	_cairo_rtree_fini (&image_glyph_cache.rtree);
+	free (image_glyph_cache.data);
+	image_glyph_cache.data = NULL;
+    }
+    CAIRO_MUTEX_UNLOCK (_cairo_image_glyph_cache_mutex);
+}
+
+static cairo_bool_t
+_image_glyph_cache_can_hold (const cairo_image_surface_t *glyph_surface)
+{
+    if (glyph_surface->format != CAIRO_FORMAT_A8 &&
+	glyph_surface->format != CAIRO_FORMAT_A1)
+	return FALSE;
+
+    return glyph_surface->width  <= GLYPH_CACHE_MAX_SIZE &&
+	   glyph_surface->height <= GLYPH_CACHE_MAX_SIZE;
+}
+
+static void
+_image_glyph_upload (const cairo_image_surface_t *glyph_surface,
+		     const cairo_rtree_node_t *node)
+{
+    const uint8_t *src = glyph_surface->data;
+    uint8_t *dst = image_glyph_cache.data +
+	node->y * GLYPH_CACHE_WIDTH + node->x;
+    int width = glyph_surface->width;
+    int height = glyph_surface->height;
+    int x;
+
+    if (glyph_surface->format == CAIRO_FORMAT_A8) {
+	while (height--) {
+	    memcpy (dst, src, width);
+	    src += glyph_surface->stride;
+	    dst += GLYPH_CACHE_WIDTH;
+	}
+    } else {
+	while (height--) {
+	    for (x = 0; x < width; x++) {
+#ifdef WORDS_BIGENDIAN
+		int bit = (src[x >> 3] >> (7 - (x & 7))) & 1;
+#else
+		int bit = (src[x >> 3] >> (x & 7)) & 1;
+#endif
+		dst[x] = -bit;
+	    }
+	    src += glyph_surface->stride;
+	    dst += GLYPH_CACHE_WIDTH;
+	}
+    }
+}
+
+/* Must be called with _cairo_image_glyph_cache_mutex held. */
+static image_glyph_node_t *
+_image_glyph_cache_get (cairo_scaled_glyph_t *scaled_glyph)
+{
+    cairo_image_surface_t *glyph_surface = scaled_glyph->surface;
+    cairo_scaled_glyph_private_t *priv;
+    cairo_rtree_node_t *node = NULL;
+    image_glyph_t *glyph;
+    cairo_int_status_t status;
+    int width, height;
+
+    priv = _cairo_scaled_glyph_find_private (scaled_glyph,
+					     &image_glyph_cache);
+    if (priv != NULL) {
+	glyph = cairo_container_of (priv, image_glyph_t, base);
+	if (glyph->node != NULL)
+	    return glyph->node;
+    } else {
+	glyph = malloc (sizeof (image_glyph_t));
+	if (unlikely (glyph == NULL))
+	    return NULL;
+
+	glyph->node = NULL;
+	_cairo_scaled_glyph_attach_private (scaled_glyph,
+					    &glyph->base,
+					    &image_glyph_cache,
+					    _image_glyph_fini);
+    }
+
+    if (image_glyph_cache.data == NULL) {
+	image_glyph_cache.data = malloc (GLYPH_CACHE_WIDTH * GLYPH_CACHE_HEIGHT);
+	if (unlikely (image_glyph_cache.data == NULL))
+	    return NULL;
+
+	_cairo_rtree_init (&image_glyph_cache.rtree,
+			   GLYPH_CACHE_WIDTH,
+			   GLYPH_CACHE_HEIGHT,
+			   GLYPH_CACHE_MIN_SIZE,
+			   sizeof (image_glyph_node_t),
+			   _image_glyph_node_destroy);
+    }
+
+    width = glyph_surface->width;
+    if (width < GLYPH_CACHE_MIN_SIZE)
+	width = GLYPH_CACHE_MIN_SIZE;
+    height = glyph_surface->height;
+    if (height < GLYPH_CACHE_MIN_SIZE)
+	height = GLYPH_CACHE_MIN_SIZE;
+
+    status = _cairo_rtree_insert (&image_glyph_cache.rtree,
+				  width, height, &node);
+    if (status == CAIRO_INT_STATUS_UNSUPPORTED) {
+	status = _cairo_rtree_evict_random (&image_glyph_cache.rtree,
+					    width, height, &node);
+	if (status == CAIRO_INT_STATUS_SUCCESS) {
+	    status = _cairo_rtree_node_insert (&image_glyph_cache.rtree,
+					       node, width, height, &node);
+	}
+    }
+    if (status)
+	return NULL;
+
+    _image_glyph_upload (glyph_surface, node);
+
+    glyph->node = (image_glyph_node_t *) node;
+    glyph->node->glyph = glyph;
+    return glyph->node;
+}
+
+static void
+_image_glyph_add (pixman_image_t *mask,
+		  const cairo_rectangle_int_t *extents,
+		  const cairo_rtree_node_t *node,
+		  int x, int y, int width, int height)
+{
+    const uint8_t *src;
+    uint8_t *dst;
+    int stride, sx = 0, sy = 0;
+
+    x -= extents->x;
+    y -= extents->y;
+    if (x < 0) {
+	sx = -x;
+	width += x;
+	x = 0;
+    }
+    if (y < 0) {
+	sy = -y;
+	height += y;
+	y = 0;
+    }
+    if (x + width > extents->width)
+	width = extents->width - x;
+    if (y + height > extents->height)
+	height = extents->height - y;
+    if (width <= 0 || height <= 0)
+	return;
+
+    stride = pixman_image_get_stride (mask);
+    dst = (uint8_t *) pixman_image_get_data (mask) + y * stride + x;
+    src = image_glyph_cache.data +
+	(node->y + sy) * GLYPH_CACHE_WIDTH + node->x + sx;
+    while (height--) {
+	int i;
+
+	for (i = 0; i < width; i++) {
+	    uint16_t t = dst[i] + src[i];
+	    dst[i] = t | (0 - (t >> 8));
+	}
+	src += GLYPH_CACHE_WIDTH;
+	dst += stride;
+    }
+}
+
+typedef struct _image_glyph_batch {
+    int count;
+    struct {
+	cairo_scaled_glyph_t *scaled_glyph;
+	int x, y;
+    } glyphs[GLYPH_CACHE_BATCH];
+} image_glyph_batch_t;
+
+static void
+_image_glyph_batch_flush (image_glyph_batch_t *batch,
+			  pixman_image_t *mask,
+			  const cairo_rectangle_int_t *extents)
+{
+    int i, j;
+
+    /* Add every glyph we can through the atlas under a single lock,
+     * collecting the leftovers to be composited by pixman afterwards.
+     */
+    CAIRO_MUTEX_LOCK (_cairo_image_glyph_cache_mutex);
+    for (i = j = 0; i < batch->count; i++) {
+	cairo_scaled_glyph_t *scaled_glyph = batch->glyphs[i].scaled_glyph;
+	image_glyph_node_t *node;
+
+	node = _image_glyph_cache_get (scaled_glyph);
+	if (node != NULL) {
+	    _image_glyph_add (mask, extents, &node->node,
+			      batch->glyphs[i].x, batch->glyphs[i].y,
+			      scaled_glyph->surface->width,
+			      scaled_glyph->surface->height);
+	} else {
+	    batch->glyphs[j++] = batch->glyphs[i];
+	}
+    }
+    CAIRO_MUTEX_UNLOCK (_cairo_image_glyph_cache_mutex);
+
+    for (i = 0; i < j; i++) {
+	cairo_image_surface_t *glyph_surface =
+	    batch->glyphs[i].scaled_glyph->surface;
+
+	pixman_image_composite32 (PIXMAN_OP_ADD,
+				  glyph_surface->pixman_image, NULL, mask,
+				  0, 0,
+				  0, 0,
+				  batch->glyphs[i].x - extents->x,
+				  batch->glyphs[i].y - extents->y,
+				  glyph_surface->width,
+				  glyph_surface->height);
+    }
+
+    batch->count = 0;
+}
+
+/* Picks the glyph to draw at the position of @glyph. Where the font has
+ * glyph phases, that is the variant nearest to the fractional part of the
+ * x position, and @x is set to the whole pixel it is then drawn from;
+ * otherwise it is the glyph itself, and @x its position, to be rounded to
+ * the nearest pixel.
+ */
+static inline unsigned long
+_image_glyph_index (const cairo_scaled_font_t *font,
+		    const cairo_glyph_t *glyph,
+		    double *x)
+{
+    if (font->glyph_phases && glyph->index <= CAIRO_SCALED_GLYPH_INDEX_MASK) {
+	int q = _cairo_lround (glyph->x * CAIRO_SCALED_GLYPH_XPHASES);
+	int phase = q & (CAIRO_SCALED_GLYPH_XPHASES - 1);
+
+	*x = (q - phase) / CAIRO_SCALED_GLYPH_XPHASES;
+	return glyph->index |
+	    ((unsigned long) phase << CAIRO_SCALED_GLYPH_XPHASE_SHIFT);
+    }
+
+    *x = glyph->x;
+    return glyph->index;
+}
+
 static cairo_int_status_t
 composite_one_glyph (void				*_dst,
 		     cairo_operator_t			 op,
@@ -772,12 +1087,15 @@ composite_one_glyph (void				*_dst,
     cairo_image_surface_t *glyph_surface;
     cairo_scaled_glyph_t *scaled_glyph;
     cairo_status_t status;
+    unsigned long glyph_index;
+    double glyph_x;
     int x, y;
 
     TRACE ((stderr, "%s\n", __FUNCTION__));
 
+    glyph_index = _image_glyph_index (info->font, &info->glyphs[0], &glyph_x);
     status = _cairo_scaled_glyph_lookup (info->font,
-					 info->glyphs[0].index,
+					 glyph_index,
 					 CAIRO_SCALED_GLYPH_INFO_SURFACE,
 					 &scaled_glyph);
 
@@ -790,7 +1108,7 @@ composite_one_glyph (void				*_dst,
 
     /* round glyph locations to the nearest pixel */
     /* XXX: FRAGILE: We're ignoring device_transform scaling here. A bug? */
-    x = _cairo_lround (info->glyphs[0].x -
+    x = _cairo_lround (glyph_x -
 		       glyph_surface->base.device_transform.x0);
     y = _cairo_lround (info->glyphs[0].y -
 		       glyph_surface->base.device_transform.y0);
@@ -819,6 +1137,7 @@ composite_glyphs_via_mask (void				*_dst,
 			   cairo_composite_glyphs_info_t *info)
 {
     cairo_scaled_glyph_t *glyph_cache[64];
+    image_glyph_batch_t batch;
     cairo_bool_t component_alpha = FALSE;
     uint8_t buf[2048];
     pixman_image_t *mask;
@@ -834,10 +1153,10 @@ composite_glyphs_via_mask (void				*_dst,
      */
     i = (info->extents.width + 3) & ~3;
     if (i * info->extents.height > (int) sizeof (buf)) {
-	mask = pixman_image_create_bits (PIXMAN_a8,
-					info->extents.width,
-					info->extents.height,
-					NULL, 0);
+	mask = _pixman_image_create_scratch (PIXMAN_a8,
+					     info->extents.width,
+					     info->extents.height,
+					     TRUE, NULL);
     } else {
 	memset (buf, 0, i * info->extents.height);
 	mask = pixman_image_create_bits (PIXMAN_a8,
@@ -849,15 +1168,21 @@ composite_glyphs_via_mask (void				*_dst,
 	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
 
     memset (glyph_cache, 0, sizeof (glyph_cache));
+    batch.count = 0;
     status = CAIRO_STATUS_SUCCESS;
 
     for (i = 0; i < info->num_glyphs; i++) {
 	cairo_image_surface_t *glyph_surface;
 	cairo_scaled_glyph_t *scaled_glyph;
-	unsigned long glyph_index = info->glyphs[i].index;
-	int cache_index = glyph_index % ARRAY_LENGTH (glyph_cache);
+	unsigned long glyph_index;
+	int cache_index;
+	double glyph_x;
 	int x, y;
 
+	glyph_index = _image_glyph_index (info->font, &info->glyphs[i], &glyph_x);
+	cache_index = _cairo_scaled_glyph_index_hash (glyph_index) %
+		      ARRAY_LENGTH (glyph_cache);
+
 	scaled_glyph = glyph_cache[cache_index];
 	if (scaled_glyph == NULL ||
 	    _cairo_scaled_glyph_index (scaled_glyph) != glyph_index)
@@ -880,10 +1205,13 @@ composite_glyphs_via_mask (void				*_dst,
 		! component_alpha) {
 		pixman_image_t *ca_mask;
 
-		ca_mask = pixman_image_create_bits (PIXMAN_a8r8g8b8,
-						    info->extents.width,
-						    info->extents.height,
-						    NULL, 0);
+		if (batch.count)
+		    _image_glyph_batch_flush (&batch, mask, &info->extents);
+
+		ca_mask = _pixman_image_create_scratch (PIXMAN_a8r8g8b8,
+							info->extents.width,
+							info->extents.height,
+							FALSE, NULL);
 		if (unlikely (ca_mask == NULL)) {
 		    pixman_image_unref (mask);
 		    return _cairo_error (CAIRO_STATUS_NO_MEMORY);
@@ -903,11 +1231,22 @@ composite_glyphs_via_mask (void				*_dst,
 
 	    /* round glyph locations to the nearest pixel */
 	    /* XXX: FRAGILE: We're ignoring device_transform scaling here. A bug? */
-	    x = _cairo_lround (info->glyphs[i].x -
+	    x = _cairo_lround (glyph_x -
 			       glyph_surface->base.device_transform.x0);
 	    y = _cairo_lround (info->glyphs[i].y -
 			       glyph_surface->base.device_transform.y0);
 
+	    if (! component_alpha &&
+		_image_glyph_cache_can_hold (glyph_surface))
+	    {
+		batch.glyphs[batch.count].scaled_glyph = scaled_glyph;
+		batch.glyphs[batch.count].x = x;
+		batch.glyphs[batch.count].y = y;
+		if (++batch.count == GLYPH_CACHE_BATCH)
+		    _image_glyph_batch_flush (&batch, mask, &info->extents);
+		continue;
+	    }
+
 	    pixman_image_composite32 (PIXMAN_OP_ADD,
 				      glyph_surface->pixman_image, NULL, mask,
                                       0, 0,
@@ -918,6 +1257,9 @@ composite_glyphs_via_mask (void				*_dst,
 	}
     }
 
+    if (batch.count)
+	_image_glyph_batch_flush (&batch, mask, &info->extents);
+
     if (component_alpha)
 	pixman_image_set_component_alpha (mask, TRUE);
 
@@ -968,8 +1310,13 @@ composite_glyphs (void				*_dst,
 	int x, y;
 	cairo_image_surface_t *glyph_surface;
 	cairo_scaled_glyph_t *scaled_glyph;
-	unsigned long glyph_index = info->glyphs[i].index;
-	int cache_index = glyph_index % ARRAY_LENGTH (glyph_cache);
+	unsigned long glyph_index;
+	int cache_index;
+	double glyph_x;
+
+	glyph_index = _image_glyph_index (info->font, &info->glyphs[i], &glyph_x);
+	cache_index = _cairo_scaled_glyph_index_hash (glyph_index) %
+		      ARRAY_LENGTH (glyph_cache);
 
 	scaled_glyph = glyph_cache[cache_index];
 	if (scaled_glyph == NULL ||
@@ -989,7 +1336,7 @@ composite_glyphs (void				*_dst,
 	if (glyph_surface->width && glyph_surface->height) {
 	    /* round glyph locations to the nearest pixel */
 	    /* XXX: FRAGILE: We're ignoring device_transform scaling here. A bug? */
-	    x = _cairo_lround (info->glyphs[i].x -
+	    x = _cairo_lround (glyph_x -
 			       glyph_surface->base.device_transform.x0);
 	    y = _cairo_lround (info->glyphs[i].y -
 			       glyph_surface->base.device_transform.y0);
@@ -1038,6 +1385,7 @@ _cairo_image_traps_compositor_get (void)
 	compositor.composite_tristrip = composite_tristrip;
 	compositor.check_composite_glyphs = check_composite_glyphs;
 	compositor.composite_glyphs = composite_glyphs;
+	compositor.shared_glyph_cache = TRUE;
     }
 
     return &compositor.base;
@@ -1864,7 +2212,8 @@ mono_renderer_init (cairo_image_span_renderer_t	*r,
 	    r->u.blit.stride = dst->stride;
 	    r->u.blit.data = dst->data;
 	    r->u.blit.src_stride = src->stride;
-	    r->u.blit.src_data = src->data + src->stride * ty + tx * 4;
+	    r->u.blit.src_data = src->data + src->stride * ty +
+		tx * (PIXMAN_FORMAT_BPP(dst->pixman_format) / 8);
 	    r->base.render_rows = _blit_spans;
 	}
     }
@@ -1932,6 +2281,517 @@ lerp8x4 (uint32_t src, uint8_t a, uint32_t dst)
     return r1 | (r2 << G_SHIFT);
 }
 
+/* The partial coverage span fillers below spend most of their time
+ * blending long runs of pixels with a constant coverage. The span
+ * kernels process such a run 4-32 pixels at a time using the vector
+ * units of the CPU, whilst computing exactly the same rounding as the
+ * scalar helpers above. The kernels are chosen at runtime, once, when
+ * the spans compositor is first initialised.
+ */
+typedef struct _cairo_image_span_kernels {
+    void (*lerp_a8) (uint8_t *d, int len, uint16_t p, uint8_t ia);
+    void (*add_mul_a8) (uint8_t *d, int len, uint8_t s, uint8_t ia);
+    void (*lerp_xrgb32) (uint32_t *d, int len, uint32_t src, uint8_t a);
+    void (*blit_lerp_xrgb32) (uint32_t *d, const uint32_t *s, int len, uint8_t a);
+} cairo_image_span_kernels_t;
+
+/* Below this length, the call overhead outweighs any vector gain */
+#define SPAN_KERNEL_MIN_LEN 8
+
+static void
+lerp_a8_c (uint8_t *d, int len, uint16_t p, uint8_t ia)
+{
+    while (len--) {
+	uint16_t t = *d*ia + p;
+	*d++ = (t + (t>>8)) >> 8;
+    }
+}
+
+static void
+add_mul_a8_c (uint8_t *d, int len, uint8_t s, uint8_t ia)
+{
+    while (len--) {
+	uint8_t t = mul8_8 (*d, ia);
+	*d++ = t + s;
+    }
+}
+
+static void
+lerp_xrgb32_c (uint32_t *d, int len, uint32_t src, uint8_t a)
+{
+    while (len--) {
+	*d = lerp8x4 (src, a, *d);
+	d++;
+    }
+}
+
+static void
+blit_lerp_xrgb32_c (uint32_t *d, const uint32_t *s, int len, uint8_t a)
+{
+    while (len--) {
+	*d = lerp8x4 (*s, a, *d);
+	s++, d++;
+    }
+}
+
+/* RGB16_565 pixels are blended by spreading them out across 32 bits as
+ * 00000ggg ggg00000 rrrrr000 000bbbbb, which leaves enough headroom
+ * between the channels to scale all three by a 5-bit alpha with a
+ * single multiply. 5 bits of alpha is all the precision 565 can show.
+ */
+#define RGB565_SPREAD_MASK 0x07e0f81f
+
+static inline uint32_t
+spread565 (uint16_t p)
+{
+    return (p | ((uint32_t) p << 16)) & RGB565_SPREAD_MASK;
+}
+
+static inline uint16_t
+pack565 (uint32_t p)
+{
+    return p | (p >> 16);
+}
+
+static inline uint16_t
+lerp565 (uint32_t src, uint8_t a5, uint16_t dst)
+{
+    uint32_t d = spread565 (dst);
+
+    return pack565 (((((src - d) * a5) >> 5) + d) & RGB565_SPREAD_MASK);
+}
+
+static void
+lerp_rgb565_c (uint16_t *d, int len, uint16_t src, uint8_t a)
+{
+    uint32_t s = spread565 (src);
+    uint8_t a5 = (a + 4) >> 3;
+
+    while (len--) {
+	*d = lerp565 (s, a5, *d);
+	d++;
+    }
+}
+
+static void
+blit_lerp_rgb565_c (uint16_t *d, const uint16_t *s, int len, uint8_t a)
+{
+    uint8_t a5 = (a + 4) >> 3;
+
+    while (len--) {
+	*d = lerp565 (spread565 (*s), a5, *d);
+	s++, d++;
+    }
+}
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define USE_X86_SPAN_KERNELS 1
+#include <immintrin.h>
+
+#define SSE2_TARGET __attribute__((target("sse2")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+/* (v * a + 127) / 255 on each 16-bit lane, as per mul8_8() */
+static inline __m128i SSE2_TARGET
+mul8_8x8_sse2 (__m128i v, __m128i a)
+{
+    __m128i t = _mm_add_epi16 (_mm_mullo_epi16 (v, a),
+			       _mm_set1_epi16 (ONE_HALF));
+    return _mm_srli_epi16 (_mm_add_epi16 (t, _mm_srli_epi16 (t, G_SHIFT)),
+			   G_SHIFT);
+}
+
+static void SSE2_TARGET
+lerp_a8_sse2 (uint8_t *d, int len, uint16_t p, uint8_t ia)
+{
+    const __m128i zero = _mm_setzero_si128 ();
+    const __m128i vp = _mm_set1_epi16 ((short) p);
+    const __m128i via = _mm_set1_epi16 (ia);
+
+    while (len >= 16) {
+	__m128i v = _mm_loadu_si128 ((__m128i *) d);
+	__m128i lo = _mm_unpacklo_epi8 (v, zero);
+	__m128i hi = _mm_unpackhi_epi8 (v, zero);
+
+	lo = _mm_add_epi16 (_mm_mullo_epi16 (lo, via), vp);
+	hi = _mm_add_epi16 (_mm_mullo_epi16 (hi, via), vp);
+	lo = _mm_srli_epi16 (_mm_add_epi16 (lo, _mm_srli_epi16 (lo, 8)), 8);
+	hi = _mm_srli_epi16 (_mm_add_epi16 (hi, _mm_srli_epi16 (hi, 8)), 8);
+	_mm_storeu_si128 ((__m128i *) d, _mm_packus_epi16 (lo, hi));
+
+	d += 16;
+	len -= 16;
+    }
+
+    lerp_a8_c (d, len, p, ia);
+}
+
+static void SSE2_TARGET
+add_mul_a8_sse2 (uint8_t *d, int len, uint8_t s, uint8_t ia)
+{
+    const __m128i zero = _mm_setzero_si128 ();
+    const __m128i vs = _mm_set1_epi16 (s);
+    const __m128i via = _mm_set1_epi16 (ia);
+
+    while (len >= 16) {
+	__m128i v = _mm_loadu_si128 ((__m128i *) d);
+	__m128i lo = _mm_unpacklo_epi8 (v, zero);
+	__m128i hi = _mm_unpackhi_epi8 (v, zero);
+
+	lo = _mm_add_epi16 (mul8_8x8_sse2 (lo, via), vs);
+	hi = _mm_add_epi16 (mul8_8x8_sse2 (hi, via), vs);
+	_mm_storeu_si128 ((__m128i *) d, _mm_packus_epi16 (lo, hi));
+
+	d += 16;
+	len -= 16;
+    }
+
+    add_mul_a8_c (d, len, s, ia);
+}
+
+static void SSE2_TARGET
+lerp_xrgb32_sse2 (uint32_t *d, int len, uint32_t src, uint8_t a)
+{
+    const __m128i zero = _mm_setzero_si128 ();
+    const __m128i via = _mm_set1_epi16 ((uint8_t) ~a);
+    __m128i vs;
+
+    /* the source contribution is constant across the span */
+    vs = _mm_unpacklo_epi8 (_mm_set1_epi32 (src), zero);
+    vs = mul8_8x8_sse2 (vs, _mm_set1_epi16 (a));
+
+    while (len >= 4) {
+	__m128i v = _mm_loadu_si128 ((__m128i *) d);
+	__m128i lo = _mm_unpacklo_epi8 (v, zero);
+	__m128i hi = _mm_unpackhi_epi8 (v, zero);
+
+	lo = _mm_add_epi16 (mul8_8x8_sse2 (lo, via), vs);
+	hi = _mm_add_epi16 (mul8_8x8_sse2 (hi, via), vs);
+	_mm_storeu_si128 ((__m128i *) d, _mm_packus_epi16 (lo, hi));
+
+	d += 4;
+	len -= 4;
+    }
+
+    lerp_xrgb32_c (d, len, src, a);
+}
+
+static void SSE2_TARGET
+blit_lerp_xrgb32_sse2 (uint32_t *d, const uint32_t *s, int len, uint8_t a)
+{
+    const __m128i zero = _mm_setzero_si128 ();
+    const __m128i va = _mm_set1_epi16 (a);
+    const __m128i via = _mm_set1_epi16 ((uint8_t) ~a);
+
+    while (len >= 4) {
+	__m128i v = _mm_loadu_si128 ((__m128i *) d);
+	__m128i u = _mm_loadu_si128 ((__m128i *) s);
+	__m128i lo, hi;
+
+	lo = _mm_add_epi16 (mul8_8x8_sse2 (_mm_unpacklo_epi8 (u, zero), va),
+			    mul8_8x8_sse2 (_mm_unpacklo_epi8 (v, zero), via));
+	hi = _mm_add_epi16 (mul8_8x8_sse2 (_mm_unpackhi_epi8 (u, zero), va),
+			    mul8_8x8_sse2 (_mm_unpackhi_epi8 (v, zero), via));
+	_mm_storeu_si128 ((__m128i *) d, _mm_packus_epi16 (lo, hi));
+
+	s += 4;
+	d += 4;
+	len -= 4;
+    }
+
+    blit_lerp_xrgb32_c (d, s, len, a);
+}
+
+/* The AVX2 variants operate on twice as many pixels per iteration.
+ * Note that unpack and pack both work within each 128-bit lane, so the
+ * pixel order is preserved.
+ */
+static inline __m256i AVX2_TARGET
+mul8_8x16_avx2 (__m256i v, __m256i a)
+{
+    __m256i t = _mm256_add_epi16 (_mm256_mullo_epi16 (v, a),
+				  _mm256_set1_epi16 (ONE_HALF));
+    return _mm256_srli_epi16 (_mm256_add_epi16 (t, _mm256_srli_epi16 (t, G_SHIFT)),
+			      G_SHIFT);
+}
+
+static void AVX2_TARGET
+lerp_a8_avx2 (uint8_t *d, int len, uint16_t p, uint8_t ia)
+{
+    const __m256i zero = _mm256_setzero_si256 ();
+    const __m256i vp = _mm256_set1_epi16 ((short) p);
+    const __m256i via = _mm256_set1_epi16 (ia);
+
+    while (len >= 32) {
+	__m256i v = _mm256_loadu_si256 ((__m256i *) d);
+	__m256i lo = _mm256_unpacklo_epi8 (v, zero);
+	__m256i hi = _mm256_unpackhi_epi8 (v, zero);
+
+	lo = _mm256_add_epi16 (_mm256_mullo_epi16 (lo, via), vp);
+	hi = _mm256_add_epi16 (_mm256_mullo_epi16 (hi, via), vp);
+	lo = _mm256_srli_epi16 (_mm256_add_epi16 (lo, _mm256_srli_epi16 (lo, 8)), 8);
+	hi = _mm256_srli_epi16 (_mm256_add_epi16 (hi, _mm256_srli_epi16 (hi, 8)), 8);
+	_mm256_storeu_si256 ((__m256i *) d, _mm256_packus_epi16 (lo, hi));
+
+	d += 32;
+	len -= 32;
+    }
+
+    lerp_a8_sse2 (d, len, p, ia);
+}
+
+static void AVX2_TARGET
+add_mul_a8_avx2 (uint8_t *d, int len, uint8_t s, uint8_t ia)
+{
+    const __m256i zero = _mm256_setzero_si256 ();
+    const __m256i vs = _mm256_set1_epi16 (s);
+    const __m256i via = _mm256_set1_epi16 (ia);
+
+    while (len >= 32) {
+	__m256i v = _mm256_loadu_si256 ((__m256i *) d);
+	__m256i lo = _mm256_unpacklo_epi8 (v, zero);
+	__m256i hi = _mm256_unpackhi_epi8 (v, zero);
+
+	lo = _mm256_add_epi16 (mul8_8x16_avx2 (lo, via), vs);
+	hi = _mm256_add_epi16 (mul8_8x16_avx2 (hi, via), vs);
+	_mm256_storeu_si256 ((__m256i *) d, _mm256_packus_epi16 (lo, hi));
+
+	d += 32;
+	len -= 32;
+    }
+
+    add_mul_a8_sse2 (d, len, s, ia);
+}
+
+static void AVX2_TARGET
+lerp_xrgb32_avx2 (uint32_t *d, int len, uint32_t src, uint8_t a)
+{
+    const __m256i zero = _mm256_setzero_si256 ();
+    const __m256i via = _mm256_set1_epi16 ((uint8_t) ~a);
+    __m256i vs;
+
+    vs = _mm256_unpacklo_epi8 (_mm256_set1_epi32 (src), zero);
+    vs = mul8_8x16_avx2 (vs, _mm256_set1_epi16 (a));
+
+    while (len >= 8) {
+	__m256i v = _mm256_loadu_si256 ((__m256i *) d);
+	__m256i lo = _mm256_unpacklo_epi8 (v, zero);
+	__m256i hi = _mm256_unpackhi_epi8 (v, zero);
+
+	lo = _mm256_add_epi16 (mul8_8x16_avx2 (lo, via), vs);
+	hi = _mm256_add_epi16 (mul8_8x16_avx2 (hi, via), vs);
+	_mm256_storeu_si256 ((__m256i *) d, _mm256_packus_epi16 (lo, hi));
+
+	d += 8;
+	len -= 8;
+    }
+
+    lerp_xrgb32_sse2 (d, len, src, a);
+}
+
+static void AVX2_TARGET
+blit_lerp_xrgb32_avx2 (uint32_t *d, const uint32_t *s, int len, uint8_t a)
+{
+    const __m256i zero = _mm256_setzero_si256 ();
+    const __m256i va = _mm256_set1_epi16 (a);
+    const __m256i via = _mm256_set1_epi16 ((uint8_t) ~a);
+
+    while (len >= 8) {
+	__m256i v = _mm256_loadu_si256 ((__m256i *) d);
+	__m256i u = _mm256_loadu_si256 ((__m256i *) s);
+	__m256i lo, hi;
+
+	lo = _mm256_add_epi16 (mul8_8x16_avx2 (_mm256_unpacklo_epi8 (u, zero), va),
+			       mul8_8x16_avx2 (_mm256_unpacklo_epi8 (v, zero), via));
+	hi = _mm256_add_epi16 (mul8_8x16_avx2 (_mm256_unpackhi_epi8 (u, zero), va),
+			       mul8_8x16_avx2 (_mm256_unpackhi_epi8 (v, zero), via));
+	_mm256_storeu_si256 ((__m256i *) d, _mm256_packus_epi16 (lo, hi));
+
+	s += 8;
+	d += 8;
+	len -= 8;
+    }
+
+    blit_lerp_xrgb32_sse2 (d, s, len, a);
+}
+
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define USE_NEON_SPAN_KERNELS 1
+#include <arm_neon.h>
+
+/* (t + (t >> 8)) >> 8, where t already includes the rounding bias */
+static inline uint16x8_t
+div255_u16_neon (uint16x8_t t)
+{
+    return vshrq_n_u16 (vsraq_n_u16 (t, t, G_SHIFT), G_SHIFT);
+}
+
+static void
+lerp_a8_neon (uint8_t *d, int len, uint16_t p, uint8_t ia)
+{
+    const uint16x8_t vp = vdupq_n_u16 (p);
+    const uint8x8_t via = vdup_n_u8 (ia);
+
+    while (len >= 16) {
+	uint8x16_t v = vld1q_u8 (d);
+	uint16x8_t lo = vmlal_u8 (vp, vget_low_u8 (v), via);
+	uint16x8_t hi = vmlal_u8 (vp, vget_high_u8 (v), via);
+
+	vst1q_u8 (d, vcombine_u8 (vshrn_n_u16 (vsraq_n_u16 (lo, lo, 8), 8),
+				  vshrn_n_u16 (vsraq_n_u16 (hi, hi, 8), 8)));
+
+	d += 16;
+	len -= 16;
+    }
+
+    lerp_a8_c (d, len, p, ia);
+}
+
+static void
+add_mul_a8_neon (uint8_t *d, int len, uint8_t s, uint8_t ia)
+{
+    const uint16x8_t half = vdupq_n_u16 (ONE_HALF);
+    const uint8x16_t vs = vdupq_n_u8 (s);
+    const uint8x8_t via = vdup_n_u8 (ia);
+
+    while (len >= 16) {
+	uint8x16_t v = vld1q_u8 (d);
+	uint16x8_t lo = vmlal_u8 (half, vget_low_u8 (v), via);
+	uint16x8_t hi = vmlal_u8 (half, vget_high_u8 (v), via);
+
+	v = vcombine_u8 (vshrn_n_u16 (vsraq_n_u16 (lo, lo, 8), 8),
+			 vshrn_n_u16 (vsraq_n_u16 (hi, hi, 8), 8));
+	vst1q_u8 (d, vaddq_u8 (v, vs));
+
+	d += 16;
+	len -= 16;
+    }
+
+    add_mul_a8_c (d, len, s, ia);
+}
+
+static void
+lerp_xrgb32_neon (uint32_t *d, int len, uint32_t src, uint8_t a)
+{
+    const uint16x8_t half = vdupq_n_u16 (ONE_HALF);
+    const uint8x8_t via = vdup_n_u8 ((uint8_t) ~a);
+    uint16x8_t vs;
+
+    /* the source contribution is constant across the span */
+    vs = vmlal_u8 (half, vreinterpret_u8_u32 (vdup_n_u32 (src)), vdup_n_u8 (a));
+    vs = div255_u16_neon (vs);
+
+    while (len >= 4) {
+	uint8x16_t v = vld1q_u8 ((uint8_t *) d);
+	uint16x8_t lo = div255_u16_neon (vmlal_u8 (half, vget_low_u8 (v), via));
+	uint16x8_t hi = div255_u16_neon (vmlal_u8 (half, vget_high_u8 (v), via));
+
+	v = vcombine_u8 (vqmovn_u16 (vaddq_u16 (lo, vs)),
+			 vqmovn_u16 (vaddq_u16 (hi, vs)));
+	vst1q_u8 ((uint8_t *) d, v);
+
+	d += 4;
+	len -= 4;
+    }
+
+    lerp_xrgb32_c (d, len, src, a);
+}
+
+static void
+blit_lerp_xrgb32_neon (uint32_t *d, const uint32_t *s, int len, uint8_t a)
+{
+    const uint16x8_t half = vdupq_n_u16 (ONE_HALF);
+    const uint8x8_t va = vdup_n_u8 (a);
+    const uint8x8_t via = vdup_n_u8 ((uint8_t) ~a);
+
+    while (len >= 4) {
+	uint8x16_t v = vld1q_u8 ((uint8_t *) d);
+	uint8x16_t u = vld1q_u8 ((const uint8_t *) s);
+	uint16x8_t lo, hi;
+
+	lo = vaddq_u16 (div255_u16_neon (vmlal_u8 (half, vget_low_u8 (u), va)),
+			div255_u16_neon (vmlal_u8 (half, vget_low_u8 (v), via)));
+	hi = vaddq_u16 (div255_u16_neon (vmlal_u8 (half, vget_high_u8 (u), va)),
+			div255_u16_neon (vmlal_u8 (half, vget_high_u8 (v), via)));
+	vst1q_u8 ((uint8_t *) d, vcombine_u8 (vqmovn_u16 (lo), vqmovn_u16 (hi)));
+
+	s += 4;
+	d += 4;
+	len -= 4;
+    }
+
+    blit_lerp_xrgb32_c (d, s, len, a);
+}
+#endif
+
+static cairo_image_span_kernels_t span_kernels = {
+    lerp_a8_c,
+    add_mul_a8_c,
+    lerp_xrgb32_c,
+    blit_lerp_xrgb32_c,
+};
+
+static void
+span_kernels_init (void)
+{
+#if USE_X86_SPAN_KERNELS
+    __builtin_cpu_init ();
+    if (__builtin_cpu_supports ("avx2")) {
+	span_kernels.lerp_a8 = lerp_a8_avx2;
+	span_kernels.add_mul_a8 = add_mul_a8_avx2;
+	span_kernels.lerp_xrgb32 = lerp_xrgb32_avx2;
+	span_kernels.blit_lerp_xrgb32 = blit_lerp_xrgb32_avx2;
+    } else if (__builtin_cpu_supports ("sse2")) {
+	span_kernels.lerp_a8 = lerp_a8_sse2;
+	span_kernels.add_mul_a8 = add_mul_a8_sse2;
+	span_kernels.lerp_xrgb32 = lerp_xrgb32_sse2;
+	span_kernels.blit_lerp_xrgb32 = blit_lerp_xrgb32_sse2;
+    }
+#elif USE_NEON_SPAN_KERNELS
+    span_kernels.lerp_a8 = lerp_a8_neon;
+    span_kernels.add_mul_a8 = add_mul_a8_neon;
+    span_kernels.lerp_xrgb32 = lerp_xrgb32_neon;
+    span_kernels.blit_lerp_xrgb32 = blit_lerp_xrgb32_neon;
+#endif
+}
+
+static inline void
+lerp_a8_span (uint8_t *d, int len, uint16_t p, uint8_t ia)
+{
+    if (len < SPAN_KERNEL_MIN_LEN)
+	lerp_a8_c (d, len, p, ia);
+    else
+	span_kernels.lerp_a8 (d, len, p, ia);
+}
+
+static inline void
+add_mul_a8_span (uint8_t *d, int len, uint8_t s, uint8_t ia)
+{
+    if (len < SPAN_KERNEL_MIN_LEN)
+	add_mul_a8_c (d, len, s, ia);
+    else
+	span_kernels.add_mul_a8 (d, len, s, ia);
+}
+
+static inline void
+lerp_xrgb32_span (uint32_t *d, int len, uint32_t src, uint8_t a)
+{
+    if (len < SPAN_KERNEL_MIN_LEN)
+	lerp_xrgb32_c (d, len, src, a);
+    else
+	span_kernels.lerp_xrgb32 (d, len, src, a);
+}
+
+static inline void
+blit_lerp_xrgb32_span (uint32_t *d, const uint32_t *s, int len, uint8_t a)
+{
+    if (len < SPAN_KERNEL_MIN_LEN)
+	blit_lerp_xrgb32_c (d, s, len, a);
+    else
+	span_kernels.blit_lerp_xrgb32 (d, s, len, a);
+}
+
 static cairo_status_t
 _fill_a8_lerp_opaque_spans (void *abstract_renderer, int y, int h,
 			    const cairo_half_open_span_t *spans, unsigned num_spans)
@@ -1951,12 +2811,7 @@ _fill_a8_lerp_opaque_spans (void *abstract_renderer, int y, int h,
 		    memset(d + spans[0].x, r->u.fill.pixel, len);
 		} else {
 		    uint8_t s = mul8_8(a, r->u.fill.pixel);
-		    uint8_t *dst = d + spans[0].x;
-		    a = ~a;
-		    while (len--) {
-			uint8_t t = mul8_8(*dst, a);
-			*dst++ = t + s;
-		    }
+		    add_mul_a8_span (d + spans[0].x, len, s, ~a);
 		}
 	    }
 	    spans++;
@@ -1979,10 +2834,7 @@ _fill_a8_lerp_opaque_spans (void *abstract_renderer, int y, int h,
 		    do {
 			int len = spans[1].x - spans[0].x;
 			uint8_t *d = r->u.fill.data + r->u.fill.stride*yy + spans[0].x;
-			while (len--) {
-			    uint8_t t = mul8_8(*d, a);
-			    *d++ = t + s;
-			}
+			add_mul_a8_span (d, len, s, a);
 			yy++;
 		    } while (--hh);
 		}
@@ -2018,10 +2870,8 @@ _fill_xrgb32_lerp_opaque_spans (void *abstract_renderer, int y, int h,
 			while (len--)
 			    *d++ = r->u.fill.pixel;
 		    }
-		} else while (len--) {
-		    *d = lerp8x4 (r->u.fill.pixel, a, *d);
-		    d++;
-		}
+		} else
+		    lerp_xrgb32_span (d, len, r->u.fill.pixel, a);
 	    }
 	    spans++;
 	} while (--num_spans > 1);
@@ -2049,10 +2899,7 @@ _fill_xrgb32_lerp_opaque_spans (void *abstract_renderer, int y, int h,
 		    do {
 			int len = spans[1].x - spans[0].x;
 			uint32_t *d = (uint32_t *)(r->u.fill.data + r->u.fill.stride*yy + spans[0].x*4);
-			while (len--) {
-			    *d = lerp8x4 (r->u.fill.pixel, a, *d);
-			    d++;
-			}
+			lerp_xrgb32_span (d, len, r->u.fill.pixel, a);
 			yy++;
 		    } while (--hh);
 		}
@@ -2064,6 +2911,36 @@ _fill_xrgb32_lerp_opaque_spans (void *abstract_renderer, int y, int h,
     return CAIRO_STATUS_SUCCESS;
 }
 
+static cairo_status_t
+_fill_rgb565_lerp_opaque_spans (void *abstract_renderer, int y, int h,
+				const cairo_half_open_span_t *spans, unsigned num_spans)
+{
+    cairo_image_span_renderer_t *r = abstract_renderer;
+
+    if (num_spans == 0)
+	return CAIRO_STATUS_SUCCESS;
+
+    do {
+	uint8_t a = spans[0].coverage;
+	if (a) {
+	    int yy = y, hh = h;
+	    do {
+		int len = spans[1].x - spans[0].x;
+		uint16_t *d = (uint16_t *)(r->u.fill.data + r->u.fill.stride*yy + spans[0].x*2);
+		if (a == 0xff) {
+		    while (len--)
+			*d++ = r->u.fill.pixel;
+		} else
+		    lerp_rgb565_c (d, len, r->u.fill.pixel, a);
+		yy++;
+	    } while (--hh);
+	}
+	spans++;
+    } while (--num_spans > 1);
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
 static cairo_status_t
 _fill_a8_lerp_spans (void *abstract_renderer, int y, int h,
 		     const cairo_half_open_span_t *spans, unsigned num_spans)
@@ -2080,11 +2957,7 @@ _fill_a8_lerp_spans (void *abstract_renderer, int y, int h,
 		int len = spans[1].x - spans[0].x;
 		uint8_t *d = r->u.fill.data + r->u.fill.stride*y + spans[0].x;
 		uint16_t p = (uint16_t)a * r->u.fill.pixel + 0x7f;
-		uint16_t ia = ~a;
-		while (len--) {
-		    uint16_t t = *d*ia + p;
-		    *d++ = (t + (t>>8)) >> 8;
-		}
+		lerp_a8_span (d, len, p, ~a);
 	    }
 	    spans++;
 	} while (--num_spans > 1);
@@ -2094,14 +2967,10 @@ _fill_a8_lerp_spans (void *abstract_renderer, int y, int h,
 	    if (a) {
 		int yy = y, hh = h;
 		uint16_t p = (uint16_t)a * r->u.fill.pixel + 0x7f;
-		uint16_t ia = ~a;
 		do {
 		    int len = spans[1].x - spans[0].x;
 		    uint8_t *d = r->u.fill.data + r->u.fill.stride*yy + spans[0].x;
-		    while (len--) {
-			uint16_t t = *d*ia + p;
-			*d++ = (t + (t>>8)) >> 8;
-		    }
+		    lerp_a8_span (d, len, p, ~a);
 		    yy++;
 		} while (--hh);
 	    }
@@ -2127,10 +2996,7 @@ _fill_xrgb32_lerp_spans (void *abstract_renderer, int y, int h,
 	    if (a) {
 		int len = spans[1].x - spans[0].x;
 		uint32_t *d = (uint32_t*)(r->u.fill.data + r->u.fill.stride*y + spans[0].x*4);
-		while (len--) {
-		    *d = lerp8x4 (r->u.fill.pixel, a, *d);
-		    d++;
-		}
+		lerp_xrgb32_span (d, len, r->u.fill.pixel, a);
 	    }
 	    spans++;
 	} while (--num_spans > 1);
@@ -2142,10 +3008,7 @@ _fill_xrgb32_lerp_spans (void *abstract_renderer, int y, int h,
 		do {
 		    int len = spans[1].x - spans[0].x;
 		    uint32_t *d = (uint32_t *)(r->u.fill.data + r->u.fill.stride*yy + spans[0].x*4);
-		    while (len--) {
-			*d = lerp8x4 (r->u.fill.pixel, a, *d);
-			d++;
-		    }
+		    lerp_xrgb32_span (d, len, r->u.fill.pixel, a);
 		    yy++;
 		} while (--hh);
 	    }
@@ -2156,6 +3019,32 @@ _fill_xrgb32_lerp_spans (void *abstract_renderer, int y, int h,
     return CAIRO_STATUS_SUCCESS;
 }
 
+static cairo_status_t
+_fill_rgb565_lerp_spans (void *abstract_renderer, int y, int h,
+			 const cairo_half_open_span_t *spans, unsigned num_spans)
+{
+    cairo_image_span_renderer_t *r = abstract_renderer;
+
+    if (num_spans == 0)
+	return CAIRO_STATUS_SUCCESS;
+
+    do {
+	uint8_t a = mul8_8 (spans[0].coverage, r->op);
+	if (a) {
+	    int yy = y, hh = h;
+	    do {
+		int len = spans[1].x - spans[0].x;
+		uint16_t *d = (uint16_t *)(r->u.fill.data + r->u.fill.stride*yy + spans[0].x*2);
+		lerp_rgb565_c (d, len, r->u.fill.pixel, a);
+		yy++;
+	    } while (--hh);
+	}
+	spans++;
+    } while (--num_spans > 1);
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
 static cairo_status_t
 _blit_xrgb32_lerp_spans (void *abstract_renderer, int y, int h,
 			 const cairo_half_open_span_t *spans, unsigned num_spans)
@@ -2179,12 +3068,8 @@ _blit_xrgb32_lerp_spans (void *abstract_renderer, int y, int h,
 			*d = *s;
 		    else
 			memcpy(d, s, len*4);
-		} else {
-		    while (len--) {
-			*d = lerp8x4 (*s, a, *d);
-			s++, d++;
-		    }
-		}
+		} else
+		    blit_lerp_xrgb32_span (d, s, len, a);
 	    }
 	    spans++;
 	} while (--num_spans > 1);
@@ -2202,12 +3087,8 @@ _blit_xrgb32_lerp_spans (void *abstract_renderer, int y, int h,
 			    *d = *s;
 			else
 			    memcpy(d, s, len * 4);
-		    } else {
-			while (len--) {
-			    *d = lerp8x4 (*s, a, *d);
-			    s++, d++;
-			}
-		    }
+		    } else
+			blit_lerp_xrgb32_span (d, s, len, a);
 		    yy++;
 		} while (--hh);
 	    }
@@ -2218,6 +3099,39 @@ _blit_xrgb32_lerp_spans (void *abstract_renderer, int y, int h,
     return CAIRO_STATUS_SUCCESS;
 }
 
+static cairo_status_t
+_blit_rgb565_lerp_spans (void *abstract_renderer, int y, int h,
+			 const cairo_half_open_span_t *spans, unsigned num_spans)
+{
+    cairo_image_span_renderer_t *r = abstract_renderer;
+
+    if (num_spans == 0)
+	return CAIRO_STATUS_SUCCESS;
+
+    do {
+	uint8_t a = mul8_8 (spans[0].coverage, r->op);
+	if (a) {
+	    int yy = y, hh = h;
+	    do {
+		uint16_t *s = (uint16_t *)(r->u.blit.src_data + yy*r->u.blit.src_stride + spans[0].x * 2);
+		uint16_t *d = (uint16_t *)(r->u.blit.data + yy*r->u.blit.stride + spans[0].x * 2);
+		int len = spans[1].x - spans[0].x;
+		if (a == 0xff) {
+		    if (len == 1)
+			*d = *s;
+		    else
+			memcpy(d, s, len * 2);
+		} else
+		    blit_lerp_rgb565_c (d, s, len, a);
+		yy++;
+	    } while (--hh);
+	}
+	spans++;
+    } while (--num_spans > 1);
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
 static cairo_status_t
 _inplace_spans (void *abstract_renderer,
 		int y, int h,
@@ -2422,8 +3336,10 @@ inplace_renderer_init (cairo_image_span_renderer_t	*r,
 		case CAIRO_FORMAT_ARGB32:
 		    r->base.render_rows = _fill_xrgb32_lerp_opaque_spans;
 		    break;
-		case CAIRO_FORMAT_A1:
 		case CAIRO_FORMAT_RGB16_565:
+		    r->base.render_rows = _fill_rgb565_lerp_opaque_spans;
+		    break;
+		case CAIRO_FORMAT_A1:
 		case CAIRO_FORMAT_RGB30:
 		case CAIRO_FORMAT_INVALID:
 		default: break;
@@ -2437,8 +3353,10 @@ inplace_renderer_init (cairo_image_span_renderer_t	*r,
 		case CAIRO_FORMAT_ARGB32:
 		    r->base.render_rows = _fill_xrgb32_lerp_spans;
 		    break;
-		case CAIRO_FORMAT_A1:
 		case CAIRO_FORMAT_RGB16_565:
+		    r->base.render_rows = _fill_rgb565_lerp_spans;
+		    break;
+		case CAIRO_FORMAT_A1:
 		case CAIRO_FORMAT_RGB30:
 		case CAIRO_FORMAT_INVALID:
 		default: break;
@@ -2447,7 +3365,9 @@ inplace_renderer_init (cairo_image_span_renderer_t	*r,
 	    r->u.fill.data = dst->data;
 	    r->u.fill.stride = dst->stride;
 	}
-    } else if ((dst->format == CAIRO_FORMAT_ARGB32 || dst->format == CAIRO_FORMAT_RGB24) &&
+    } else if ((dst->format == CAIRO_FORMAT_ARGB32 ||
+		dst->format == CAIRO_FORMAT_RGB24 ||
+		dst->format == CAIRO_FORMAT_RGB16_565) &&
 	       (composite->op == CAIRO_OPERATOR_SOURCE ||
 		(composite->op == CAIRO_OPERATOR_OVER &&
 		 (dst->base.is_clear || (dst->base.content & CAIRO_CONTENT_ALPHA) == 0))) &&
@@ -2466,12 +3386,16 @@ inplace_renderer_init (cairo_image_span_renderer_t	*r,
 	    composite->bounded.x + composite->bounded.width + tx <= src->width &&
 	    composite->bounded.y + composite->bounded.height + ty <= src->height) {
 
-	    assert(PIXMAN_FORMAT_BPP(dst->pixman_format) == 32);
+	    int cpp = PIXMAN_FORMAT_BPP(dst->pixman_format) / 8;
+
 	    r->u.blit.stride = dst->stride;
 	    r->u.blit.data = dst->data;
 	    r->u.blit.src_stride = src->stride;
-	    r->u.blit.src_data = src->data + src->stride * ty + tx * 4;
-	    r->base.render_rows = _blit_xrgb32_lerp_spans;
+	    r->u.blit.src_data = src->data + src->stride * ty + tx * cpp;
+	    if (cpp == 2)
+		r->base.render_rows = _blit_rgb565_lerp_spans;
+	    else
+		r->base.render_rows = _blit_xrgb32_lerp_spans;
 	}
     }
     if (r->base.render_rows == NULL) {
@@ -2627,10 +3551,10 @@ span_renderer_init (cairo_abstract_span_renderer_t	*_r,
     r->u.mask.extents = composite->unbounded;
     r->u.mask.stride = (r->u.mask.extents.width + 3) & ~3;
     if (r->u.mask.extents.height * r->u.mask.stride > (int)sizeof (r->buf)) {
-	r->mask = pixman_image_create_bits (PIXMAN_a8,
-					    r->u.mask.extents.width,
-					    r->u.mask.extents.height,
-					    NULL, 0);
+	r->mask = _pixman_image_create_scratch (PIXMAN_a8,
+						r->u.mask.extents.width,
+						r->u.mask.extents.height,
+						TRUE, NULL);
 
 	r->base.render_rows = _cairo_image_spans;
 	r->base.finish = NULL;
@@ -2653,6 +3577,31 @@ span_renderer_init (cairo_abstract_span_renderer_t	*_r,
     return CAIRO_STATUS_SUCCESS;
 }
 
+/* Only those renderers that write directly into the destination pixels,
+ * or into their own mask, during generation may be run concurrently.
+ * The others call into pixman with the shared destination image.
+ */
+static cairo_bool_t
+span_renderer_is_threadsafe (const cairo_abstract_span_renderer_t *_r)
+{
+    const cairo_image_span_renderer_t *r = (const cairo_image_span_renderer_t *) _r;
+
+    return (r->base.render_rows == _fill8_spans ||
+	    r->base.render_rows == _fill16_spans ||
+	    r->base.render_rows == _fill32_spans ||
+	    r->base.render_rows == _blit_spans ||
+	    r->base.render_rows == _fill_a8_lerp_opaque_spans ||
+	    r->base.render_rows == _fill_xrgb32_lerp_opaque_spans ||
+	    r->base.render_rows == _fill_a8_lerp_spans ||
+	    r->base.render_rows == _fill_xrgb32_lerp_spans ||
+	    r->base.render_rows == _blit_xrgb32_lerp_spans ||
+	    r->base.render_rows == _fill_rgb565_lerp_opaque_spans ||
+	    r->base.render_rows == _fill_rgb565_lerp_spans ||
+	    r->base.render_rows == _blit_rgb565_lerp_spans ||
+	    r->base.render_rows == _cairo_image_spans ||
+	    r->base.render_rows == _cairo_image_spans_and_zero);
+}
+
 static void
 span_renderer_fini (cairo_abstract_span_renderer_t *_r,
 		    cairo_int_status_t status)
@@ -2698,6 +3647,11 @@ _cairo_image_spans_compositor_get (void)
 
 	_cairo_spans_compositor_init (&spans, &shape);
 
+#if ! PIXMAN_HAS_COMPOSITOR
+	span_kernels_init ();
+	spans.renderer_is_threadsafe = span_renderer_is_threadsafe;
+#endif
+
 	spans.flags = 0;
 #if PIXMAN_HAS_OP_LERP
 	spans.flags |= CAIRO_SPANS_COMPOSITOR_HAS_LERP;
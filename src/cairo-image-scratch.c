@@ -0,0 +1,220 @@
+/* cairo - a vector graphics library with display and print output
+ *
+ * Copyright © 2012 Samsung Electronics
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it either under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * (the "LGPL") or, at your option, under the terms of the Mozilla
+ * Public License Version 1.1 (the "MPL"). If you do not alter this
+ * notice, a recipient may use your version of this file under either
+ * the MPL or the LGPL.
+ *
+ * You should have received a copy of the LGPL along with this library
+ * in the file COPYING-LGPL-2.1; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA 02110-1335, USA
+ * You should have received a copy of the MPL along with this library
+ * in the file COPYING-MPL-1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License
+ * Version 1.1 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY
+ * OF ANY KIND, either express or implied. See the LGPL or the MPL for
+ * the specific language governing rights and limitations.
+ *
+ * The Original Code is the cairo graphics library.
+ *
+ * The Initial Developer of the Original Code is Samsung Electronics.
+ */
+
+/* A pool of recycled pixel buffers for the short-lived masks and
+ * temporary surfaces created by the image compositors.
+ *
+ * Buffers are kept in size classes from 4KiB to 4MiB, four to each
+ * doubling so that rounding up wastes at most a quarter of a buffer, and
+ * the total held in the pool is capped. Images are handed out with a
+ * pixman destroy function that returns their buffer to the pool, so the
+ * buffer lives exactly as long as the pixman image. The free lists are
+ * shared between threads, the lock being held only to pop or push a
+ * single buffer.
+ */
+
+#include "cairoint.h"
+
+#include "cairo-image-surface-private.h"
+
+#define SCRATCH_MIN_SHIFT 12
+#define SCRATCH_MAX_SHIFT 22
+#define SCRATCH_CLASS_SHIFT 2
+#define SCRATCH_NUM_CLASSES (((SCRATCH_MAX_SHIFT - SCRATCH_MIN_SHIFT) << SCRATCH_CLASS_SHIFT) + 1)
+#define SCRATCH_MAX_POOLED (16 << 20)
+
+typedef struct _scratch_buffer {
+    struct _scratch_buffer *next;
+} scratch_buffer_t;
+
+static struct {
+    scratch_buffer_t *free[SCRATCH_NUM_CLASSES];
+    cairo_image_scratch_stats_t stats;
+} pool;
+
+/* Class 0 holds the smallest buffers; above that each doubling from
+ * 2^shift to 2^(shift+1) is split into four equal steps.
+ */
+static size_t
+_scratch_class_size (int class)
+{
+    int shift;
+
+    if (class == 0)
+	return (size_t) 1 << SCRATCH_MIN_SHIFT;
+
+    class--;
+    shift = SCRATCH_MIN_SHIFT + (class >> SCRATCH_CLASS_SHIFT);
+    return ((size_t) 1 << shift) +
+	((size_t) ((class & ((1 << SCRATCH_CLASS_SHIFT) - 1)) + 1) <<
+	 (shift - SCRATCH_CLASS_SHIFT));
+}
+
+static int
+_scratch_class (size_t size)
+{
+    size_t step;
+    int shift;
+
+    if (size <= ((size_t) 1 << SCRATCH_MIN_SHIFT))
+	return 0;
+
+    shift = SCRATCH_MIN_SHIFT;
+    while (((size_t) 2 << shift) < size)
+	shift++;
+
+    step = (size_t) 1 << (shift - SCRATCH_CLASS_SHIFT);
+    return ((shift - SCRATCH_MIN_SHIFT) << SCRATCH_CLASS_SHIFT) +
+	(int) ((size - ((size_t) 1 << shift) + step - 1) / step);
+}
+
+static void
+_scratch_release (pixman_image_t *image, void *closure)
+{
+    int class = (uintptr_t) closure;
+    scratch_buffer_t *buffer;
+    size_t size = _scratch_class_size (class);
+
+    buffer = (scratch_buffer_t *) pixman_image_get_data (image);
+
+    CAIRO_MUTEX_LOCK (_cairo_image_scratch_pool_mutex);
+    if (pool.stats.pooled_bytes + size <= SCRATCH_MAX_POOLED) {
+	buffer->next = pool.free[class];
+	pool.free[class] = buffer;
+	pool.stats.pooled_bytes += size;
+	buffer = NULL;
+    } else {
+	pool.stats.discards++;
+    }
+    CAIRO_MUTEX_UNLOCK (_cairo_image_scratch_pool_mutex);
+
+    free (buffer);
+}
+
+/**
+ * _pixman_image_create_scratch:
+ * @format: the pixman format of the image
+ * @width: the width of the image
+ * @height: the height of the image
+ * @clear: whether the pixels must be zeroed
+ * @is_clear: return location for whether the pixels are zero, or %NULL
+ *
+ * Creates a pixman image for temporary use, recycling the pixel buffer
+ * of a previously destroyed scratch image where possible. Unless @clear
+ * is set, the contents of a recycled buffer are undefined.
+ *
+ * Return value: the new image or %NULL if out of memory.
+ **/
+pixman_image_t *
+_pixman_image_create_scratch (pixman_format_code_t format,
+			      int width, int height,
+			      cairo_bool_t clear,
+			      cairo_bool_t *is_clear)
+{
+    scratch_buffer_t *buffer;
+    pixman_image_t *image;
+    size_t size;
+    int stride, class;
+
+    if (is_clear)
+	*is_clear = TRUE;
+
+    stride = CAIRO_STRIDE_FOR_WIDTH_BPP (width, PIXMAN_FORMAT_BPP (format));
+    size = (size_t) stride * height;
+    if (size < ((size_t) 1 << SCRATCH_MIN_SHIFT) ||
+	size > ((size_t) 1 << SCRATCH_MAX_SHIFT))
+    {
+	/* too small to be worth recycling, or too large to hold onto */
+	return pixman_image_create_bits (format, width, height, NULL, 0);
+    }
+
+    class = _scratch_class (size);
+
+    CAIRO_MUTEX_LOCK (_cairo_image_scratch_pool_mutex);
+    buffer = pool.free[class];
+    if (buffer != NULL) {
+	pool.free[class] = buffer->next;
+	pool.stats.pooled_bytes -= _scratch_class_size (class);
+	pool.stats.hits++;
+    } else {
+	pool.stats.misses++;
+    }
+    CAIRO_MUTEX_UNLOCK (_cairo_image_scratch_pool_mutex);
+
+    if (buffer != NULL) {
+	if (clear)
+	    memset (buffer, 0, size);
+	else if (is_clear)
+	    *is_clear = FALSE;
+    } else {
+	buffer = calloc (1, _scratch_class_size (class));
+	if (unlikely (buffer == NULL))
+	    return NULL;
+    }
+
+    image = pixman_image_create_bits (format, width, height,
+				      (uint32_t *) buffer, stride);
+    if (unlikely (image == NULL)) {
+	free (buffer);
+	return NULL;
+    }
+
+    pixman_image_set_destroy_function (image, _scratch_release,
+				       (void *) (uintptr_t) class);
+    return image;
+}
+
+void
+_cairo_image_scratch_get_stats (cairo_image_scratch_stats_t *stats)
+{
+    CAIRO_MUTEX_LOCK (_cairo_image_scratch_pool_mutex);
+    *stats = pool.stats;
+    CAIRO_MUTEX_UNLOCK (_cairo_image_scratch_pool_mutex);
+}
+
+void
+_cairo_image_scratch_reset_static_data (void)
+{
+    int class;
+
+    CAIRO_MUTEX_LOCK (_cairo_image_scratch_pool_mutex);
+    for (class = 0; class < SCRATCH_NUM_CLASSES; class++) {
+	while (pool.free[class] != NULL) {
+	    scratch_buffer_t *buffer = pool.free[class];
+
+	    pool.free[class] = buffer->next;
+	    free (buffer);
+	}
+    }
+    memset (&pool.stats, 0, sizeof (pool.stats));
+    CAIRO_MUTEX_UNLOCK (_cairo_image_scratch_pool_mutex);
+}
@@ -54,6 +54,7 @@
 #include "cairo-surface-observer-private.h"
 #include "cairo-surface-snapshot-inline.h"
 #include "cairo-surface-subsurface-private.h"
+#include "cairo-thread-pool-private.h"
 
 #define PIXMAN_MAX_INT ((pixman_fixed_1 >> 1) - pixman_fixed_e) /* need to ensure deltas also fit */
 
@@ -162,21 +163,6 @@ _pixman_white_image (void)
     return image;
 }
 
-static uint32_t
-hars_petruska_f54_1_random (void)
-{
-#define rol(x,k) ((x << k) | (x >> (32-k)))
-    static uint32_t x;
-    return x = (x ^ rol (x, 5) ^ rol (x, 24)) + 0x37798849;
-#undef rol
-}
-
-static struct {
-    cairo_color_t color;
-    pixman_image_t *image;
-} cache[16];
-static int n_cached;
-
 #else  /* !PIXMAN_HAS_ATOMIC_OPS */
 static pixman_image_t *
 _pixman_transparent_image (void)
@@ -201,15 +187,242 @@ _pixman_white_image (void)
 #endif /* !PIXMAN_HAS_ATOMIC_OPS */
 
 
+/* Pixman reference counts are not atomic, so rather than share the solid
+ * and gradient images between threads under a lock, each thread keeps a
+ * small cache of its own. The solid cache is set-associative on the colour
+ * and evicts the least recently used entry from a set.
+ */
+#if PIXMAN_HAS_ATOMIC_OPS || CAIRO_HAS_REAL_PTHREAD
+#define SOURCE_CACHE 1
+#define SOLID_CACHE_SETS 8
+#define SOLID_CACHE_WAYS 4
+#define GRADIENT_CACHE_SIZE 16
+
+typedef struct _cairo_image_solid_cache {
+    struct {
+	cairo_color_t color;
+	pixman_image_t *image;
+	unsigned int stamp;
+    } entry[SOLID_CACHE_SETS][SOLID_CACHE_WAYS];
+    unsigned int clock;
+    /* the cache belongs to one thread, so plain counters suffice */
+    unsigned long hits;
+    unsigned long misses;
+} cairo_image_solid_cache_t;
+
+typedef struct _cairo_image_gradient_entry {
+    cairo_cache_entry_t key;
+    cairo_pattern_union_t pattern;
+    pixman_transform_t transform;
+    pixman_image_t *image;
+} cairo_image_gradient_entry_t;
+
+typedef struct _cairo_image_source_cache {
+    cairo_image_solid_cache_t solid;
+    cairo_cache_t gradients;
+} cairo_image_source_cache_t;
+
+static cairo_bool_t
+_gradient_cache_entry_equal (const void *A, const void *B)
+{
+    const cairo_image_gradient_entry_t *a = A, *b = B;
+
+    if (a->pattern.base.type != b->pattern.base.type)
+	return FALSE;
+
+    if (a->pattern.base.extend != b->pattern.base.extend)
+	return FALSE;
+
+    if (memcmp (&a->transform, &b->transform, sizeof (a->transform)))
+	return FALSE;
+
+    if (a->pattern.base.type == CAIRO_PATTERN_TYPE_LINEAR) {
+	return _cairo_linear_pattern_equal (&a->pattern.gradient.linear,
+					    &b->pattern.gradient.linear);
+    } else {
+	return _cairo_radial_pattern_equal (&a->pattern.gradient.radial,
+					    &b->pattern.gradient.radial);
+    }
+}
+
+static void
+_gradient_cache_entry_destroy (void *closure)
+{
+    cairo_image_gradient_entry_t *entry = closure;
+
+    _cairo_pattern_fini (&entry->pattern.base);
+    pixman_image_unref (entry->image);
+    free (entry);
+}
+
+static void
+_source_cache_fini (cairo_image_source_cache_t *cache)
+{
+    int i, j;
+
+    for (i = 0; i < SOLID_CACHE_SETS; i++) {
+	for (j = 0; j < SOLID_CACHE_WAYS; j++) {
+	    if (cache->solid.entry[i][j].image) {
+		pixman_image_unref (cache->solid.entry[i][j].image);
+		cache->solid.entry[i][j].image = NULL;
+	    }
+	}
+    }
+
+    if (cache->gradients.hash_table != NULL) {
+	_cairo_cache_fini (&cache->gradients);
+	cache->gradients.hash_table = NULL;
+    }
+}
+
+#if PIXMAN_HAS_ATOMIC_OPS
+static cairo_image_source_cache_t source_cache;
+
+static cairo_image_source_cache_t *
+_source_cache_get (cairo_bool_t create)
+{
+    return &source_cache;
+}
+#else
+#include <pthread.h>
+
+static pthread_key_t source_cache_key;
+static pthread_once_t source_cache_once = PTHREAD_ONCE_INIT;
+static cairo_bool_t source_cache_key_valid;
+
+static void
+_source_cache_destroy (void *closure)
+{
+    _source_cache_fini (closure);
+    free (closure);
+}
+
+static void
+_source_cache_key_init (void)
+{
+    source_cache_key_valid =
+	pthread_key_create (&source_cache_key, _source_cache_destroy) == 0;
+}
+
+static cairo_image_source_cache_t *
+_source_cache_get (cairo_bool_t create)
+{
+    cairo_image_source_cache_t *cache;
+
+    pthread_once (&source_cache_once, _source_cache_key_init);
+    if (unlikely (! source_cache_key_valid))
+	return NULL;
+
+    cache = pthread_getspecific (source_cache_key);
+    if (cache == NULL && create) {
+	cache = calloc (1, sizeof (cairo_image_source_cache_t));
+	if (cache != NULL && pthread_setspecific (source_cache_key, cache)) {
+	    free (cache);
+	    cache = NULL;
+	}
+    }
+
+    return cache;
+}
+#endif
+
+static cairo_cache_t *
+_gradient_cache_get (void)
+{
+    cairo_image_source_cache_t *cache;
+
+    cache = _source_cache_get (TRUE);
+    if (unlikely (cache == NULL))
+	return NULL;
+
+    if (cache->gradients.hash_table == NULL) {
+	if (_cairo_cache_init (&cache->gradients,
+			       _gradient_cache_entry_equal,
+			       NULL,
+			       _gradient_cache_entry_destroy,
+			       GRADIENT_CACHE_SIZE))
+	{
+	    cache->gradients.hash_table = NULL;
+	    return NULL;
+	}
+    }
+
+    return &cache->gradients;
+}
+
+static unsigned int
+_solid_cache_hash (const cairo_color_t *color)
+{
+    unsigned int hash;
+
+    hash  = color->red_short;
+    hash ^= color->green_short * 31;
+    hash ^= color->blue_short * 131;
+    hash ^= color->alpha_short * 257;
+    hash ^= hash >> 8;
+
+    return hash & (SOLID_CACHE_SETS - 1);
+}
+
+static pixman_image_t *
+_solid_cache_lookup (cairo_image_solid_cache_t *cache,
+		     const cairo_color_t *cairo_color)
+{
+    pixman_color_t color;
+    pixman_image_t *image;
+    unsigned int hash;
+    int i, lru;
+
+    hash = _solid_cache_hash (cairo_color);
+    for (i = 0; i < SOLID_CACHE_WAYS; i++) {
+	if (cache->entry[hash][i].image &&
+	    _cairo_color_equal (&cache->entry[hash][i].color, cairo_color))
+	{
+	    cache->entry[hash][i].stamp = ++cache->clock;
+	    cache->hits++;
+	    return pixman_image_ref (cache->entry[hash][i].image);
+	}
+    }
+    cache->misses++;
+
+    color.red   = cairo_color->red_short;
+    color.green = cairo_color->green_short;
+    color.blue  = cairo_color->blue_short;
+    color.alpha = cairo_color->alpha_short;
+
+    image = pixman_image_create_solid_fill (&color);
+    if (unlikely (image == NULL))
+	return NULL;
+
+    lru = 0;
+    for (i = 0; i < SOLID_CACHE_WAYS; i++) {
+	if (cache->entry[hash][i].image == NULL) {
+	    lru = i;
+	    break;
+	}
+	if (cache->entry[hash][i].stamp < cache->entry[hash][lru].stamp)
+	    lru = i;
+    }
+
+    if (cache->entry[hash][lru].image)
+	pixman_image_unref (cache->entry[hash][lru].image);
+    cache->entry[hash][lru].image = pixman_image_ref (image);
+    cache->entry[hash][lru].color = *cairo_color;
+    cache->entry[hash][lru].stamp = ++cache->clock;
+
+    return image;
+}
+#endif
+
 pixman_image_t *
 _pixman_image_for_color (const cairo_color_t *cairo_color)
 {
     pixman_color_t color;
-    pixman_image_t *image;
+#if SOURCE_CACHE
+    cairo_image_source_cache_t *cache;
+#endif
 
 #if PIXMAN_HAS_ATOMIC_OPS
-    int i;
-
     if (CAIRO_COLOR_IS_CLEAR (cairo_color))
 	return _pixman_transparent_image ();
 
@@ -228,14 +441,12 @@ _pixman_image_for_color (const cairo_color_t *cairo_color)
 	    return _pixman_white_image ();
 	}
     }
+#endif
 
-    CAIRO_MUTEX_LOCK (_cairo_image_solid_cache_mutex);
-    for (i = 0; i < n_cached; i++) {
-	if (_cairo_color_equal (&cache[i].color, cairo_color)) {
-	    image = pixman_image_ref (cache[i].image);
-	    goto UNLOCK;
-	}
-    }
+#if SOURCE_CACHE
+    cache = _source_cache_get (TRUE);
+    if (likely (cache != NULL))
+	return _solid_cache_lookup (&cache->solid, cairo_color);
 #endif
 
     color.red   = cairo_color->red_short;
@@ -243,34 +454,47 @@ _pixman_image_for_color (const cairo_color_t *cairo_color)
     color.blue  = cairo_color->blue_short;
     color.alpha = cairo_color->alpha_short;
 
-    image = pixman_image_create_solid_fill (&color);
-#if PIXMAN_HAS_ATOMIC_OPS
-    if (image == NULL)
-	goto UNLOCK;
+    return pixman_image_create_solid_fill (&color);
+}
 
-    if (n_cached < ARRAY_LENGTH (cache)) {
-	i = n_cached++;
-    } else {
-	i = hars_petruska_f54_1_random () % ARRAY_LENGTH (cache);
-	pixman_image_unref (cache[i].image);
+/**
+ * _cairo_image_solid_cache_get_stats:
+ * @hits: return location for the number of lookups found in the cache
+ * @misses: return location for the number of lookups that created an image
+ *
+ * Reports the solid colour cache counters for the calling thread.
+ **/
+void
+_cairo_image_solid_cache_get_stats (unsigned long *hits,
+				    unsigned long *misses)
+{
+#if SOURCE_CACHE
+    cairo_image_source_cache_t *cache;
+
+    cache = _source_cache_get (FALSE);
+    if (cache != NULL) {
+	*hits = cache->solid.hits;
+	*misses = cache->solid.misses;
+	return;
     }
-    cache[i].image = pixman_image_ref (image);
-    cache[i].color = *cairo_color;
-
-UNLOCK:
-    CAIRO_MUTEX_UNLOCK (_cairo_image_solid_cache_mutex);
 #endif
-    return image;
-}
 
+    *hits = *misses = 0;
+}
 
 void
 _cairo_image_reset_static_data (void)
 {
-#if PIXMAN_HAS_ATOMIC_OPS
-    while (n_cached)
-	pixman_image_unref (cache[--n_cached].image);
+#if SOURCE_CACHE
+    cairo_image_source_cache_t *cache;
+
+    /* the caches of other threads are released as those threads exit */
+    cache = _source_cache_get (FALSE);
+    if (cache != NULL)
+	_source_cache_fini (cache);
+#endif
 
+#if PIXMAN_HAS_ATOMIC_OPS
     if (__pixman_transparent_image) {
 	pixman_image_unref (__pixman_transparent_image);
 	__pixman_transparent_image = NULL;
@@ -289,21 +513,15 @@ _cairo_image_reset_static_data (void)
 }
 
 static pixman_image_t *
-_pixman_image_for_gradient (const cairo_gradient_pattern_t *pattern,
-			    const cairo_rectangle_int_t *extents,
-			    int *ix, int *iy)
+_pixman_image_create_gradient (const cairo_gradient_pattern_t *pattern,
+			       const cairo_circle_double_t extremes[2],
+			       const pixman_transform_t *pixman_transform)
 {
     pixman_image_t	  *pixman_image;
     pixman_gradient_stop_t pixman_stops_static[2];
     pixman_gradient_stop_t *pixman_stops = pixman_stops_static;
-    pixman_transform_t      pixman_transform;
-    cairo_matrix_t matrix;
-    cairo_circle_double_t extremes[2];
     pixman_point_fixed_t p1, p2;
     unsigned int i;
-    cairo_int_status_t status;
-
-    TRACE ((stderr, "%s\n", __FUNCTION__));
 
     if (pattern->n_stops > ARRAY_LENGTH(pixman_stops_static)) {
 	pixman_stops = _cairo_malloc_ab (pattern->n_stops,
@@ -320,8 +538,6 @@ _pixman_image_for_gradient (const cairo_gradient_pattern_t *pattern,
 	pixman_stops[i].color.alpha = pattern->stops[i].color.alpha_short;
     }
 
-    _cairo_gradient_pattern_fit_to_range (pattern, PIXMAN_MAX_INT >> 1, &matrix, extremes);
-
     p1.x = _cairo_fixed_16_16_from_double (extremes[0].center.x);
     p1.y = _cairo_fixed_16_16_from_double (extremes[0].center.y);
     p2.x = _cairo_fixed_16_16_from_double (extremes[1].center.x);
@@ -348,18 +564,12 @@ _pixman_image_for_gradient (const cairo_gradient_pattern_t *pattern,
     if (unlikely (pixman_image == NULL))
 	return NULL;
 
-    *ix = *iy = 0;
-    status = _cairo_matrix_to_pixman_matrix_offset (&matrix, pattern->base.filter,
-						    extents->x + extents->width/2.,
-						    extents->y + extents->height/2.,
-						    &pixman_transform, ix, iy);
-    if (status != CAIRO_INT_STATUS_NOTHING_TO_DO) {
-	if (unlikely (status != CAIRO_INT_STATUS_SUCCESS) ||
-	    ! pixman_image_set_transform (pixman_image, &pixman_transform))
-	{
-	    pixman_image_unref (pixman_image);
-	    return NULL;
-	}
+    /* an all-zero transform marks the identity */
+    if (pixman_transform->matrix[2][2] != 0 &&
+	! pixman_image_set_transform (pixman_image, pixman_transform))
+    {
+	pixman_image_unref (pixman_image);
+	return NULL;
     }
 
     {
@@ -387,6 +597,96 @@ _pixman_image_for_gradient (const cairo_gradient_pattern_t *pattern,
     return pixman_image;
 }
 
+static pixman_image_t *
+_pixman_image_for_gradient (const cairo_gradient_pattern_t *pattern,
+			    const cairo_rectangle_int_t *extents,
+			    int *ix, int *iy)
+{
+    pixman_image_t	  *pixman_image;
+    pixman_transform_t      pixman_transform;
+    cairo_matrix_t matrix;
+    cairo_circle_double_t extremes[2];
+    cairo_int_status_t status;
+#if SOURCE_CACHE
+    cairo_image_gradient_entry_t tmpl, *entry;
+    cairo_cache_t *cache;
+#endif
+
+    TRACE ((stderr, "%s\n", __FUNCTION__));
+
+    _cairo_gradient_pattern_fit_to_range (pattern, PIXMAN_MAX_INT >> 1, &matrix, extremes);
+
+    *ix = *iy = 0;
+    status = _cairo_matrix_to_pixman_matrix_offset (&matrix, pattern->base.filter,
+						    extents->x + extents->width/2.,
+						    extents->y + extents->height/2.,
+						    &pixman_transform, ix, iy);
+    if (status == CAIRO_INT_STATUS_NOTHING_TO_DO)
+	memset (&pixman_transform, 0, sizeof (pixman_transform));
+    else if (unlikely (status != CAIRO_INT_STATUS_SUCCESS))
+	return NULL;
+
+#if SOURCE_CACHE
+    /* The prepared image depends only upon the geometry and colour stops,
+     * the extend mode and the residual transform, so reuse it whenever the
+     * same gradient is painted again.
+     */
+    cache = _gradient_cache_get ();
+    if (likely (cache != NULL)) {
+	tmpl.key.hash = _cairo_hash_bytes (_CAIRO_HASH_INIT_VALUE,
+					   &pattern->base.extend,
+					   sizeof (pattern->base.extend));
+	tmpl.key.hash = _cairo_hash_bytes (tmpl.key.hash,
+					   &pixman_transform,
+					   sizeof (pixman_transform));
+	if (pattern->base.type == CAIRO_PATTERN_TYPE_LINEAR) {
+	    tmpl.key.hash =
+		_cairo_linear_pattern_hash (tmpl.key.hash,
+					    (cairo_linear_pattern_t *) pattern);
+	} else {
+	    tmpl.key.hash =
+		_cairo_radial_pattern_hash (tmpl.key.hash,
+					    (cairo_radial_pattern_t *) pattern);
+	}
+	_cairo_pattern_init_static_copy (&tmpl.pattern.base, &pattern->base);
+	tmpl.transform = pixman_transform;
+
+	entry = _cairo_cache_lookup (cache, &tmpl.key);
+	if (entry != NULL)
+	    return pixman_image_ref (entry->image);
+    }
+#endif
+
+    pixman_image = _pixman_image_create_gradient (pattern, extremes,
+						  &pixman_transform);
+    if (unlikely (pixman_image == NULL))
+	return NULL;
+
+#if SOURCE_CACHE
+    if (likely (cache != NULL)) {
+	entry = malloc (sizeof (cairo_image_gradient_entry_t));
+	if (unlikely (entry == NULL))
+	    return pixman_image;
+
+	if (unlikely (_cairo_pattern_init_copy (&entry->pattern.base,
+						&pattern->base)))
+	{
+	    free (entry);
+	    return pixman_image;
+	}
+
+	entry->key.hash = tmpl.key.hash;
+	entry->key.size = 1;
+	entry->transform = pixman_transform;
+	entry->image = pixman_image_ref (pixman_image);
+	if (unlikely (_cairo_cache_insert (cache, &entry->key)))
+	    _gradient_cache_entry_destroy (entry);
+    }
+#endif
+
+    return pixman_image;
+}
+
 static pixman_image_t *
 _pixman_image_for_mesh (const cairo_mesh_pattern_t *pattern,
 			const cairo_rectangle_int_t *extents,
@@ -573,11 +873,9 @@ _pixman_image_set_properties (pixman_image_t *pixman_image,
 	    pixman_filter = PIXMAN_FILTER_BILINEAR;
 	    break;
 	case CAIRO_FILTER_GAUSSIAN:
-	    /* XXX: The GAUSSIAN value has no implementation in cairo
-	     * whatsoever, so it was really a mistake to have it in the
-	     * API. We could fix this by officially deprecating it, or
-	     * else inventing semantics and providing an actual
-	     * implementation for it. */
+	    /* Image sources are blurred up front, see
+	     * _pixman_image_for_gaussian(); anything else that reaches
+	     * here gets the best that pixman can do. */
 	default:
 	    pixman_filter = PIXMAN_FILTER_BEST;
 	}
@@ -799,6 +1097,597 @@ done:
     return pixman_image;
 }
 
+/* Downscaling by more than a factor of two through a bilinear filter
+ * skips over source pixels and aliases badly. So for GOOD and BEST we
+ * instead sample from a pyramid of successively halved, box filtered,
+ * copies of the source. The pyramid is attached to the source as a
+ * snapshot and so is discarded as soon as the source is modified.
+ * Levels are built on demand by whichever thread first needs them, so
+ * the pyramid is only examined or extended whilst holding
+ * _cairo_image_source_snapshot_mutex.
+ */
+#define MIPMAP_MAX_LEVELS 12
+
+struct mipmap {
+    cairo_surface_t base;
+    cairo_image_surface_t *level[MIPMAP_MAX_LEVELS];
+};
+
+static cairo_status_t
+mipmap_finish (void *abstract_surface)
+{
+    struct mipmap *mipmap = abstract_surface;
+    int i;
+
+    for (i = 0; i < MIPMAP_MAX_LEVELS; i++) {
+	if (mipmap->level[i] != NULL) {
+	    cairo_surface_destroy (&mipmap->level[i]->base);
+	    mipmap->level[i] = NULL;
+	}
+    }
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static const cairo_surface_backend_t mipmap_backend = {
+    CAIRO_INTERNAL_SURFACE_TYPE_NULL,
+    mipmap_finish,
+};
+
+static cairo_image_surface_t *
+_mipmap_downsample (cairo_image_surface_t *src)
+{
+    cairo_image_surface_t *dst;
+    int width, height, cpp, x, y, c;
+
+    width  = (src->width  + 1) / 2;
+    height = (src->height + 1) / 2;
+    cpp = PIXMAN_FORMAT_BPP (src->pixman_format) / 8;
+
+    dst = (cairo_image_surface_t *)
+	_cairo_image_surface_create_with_pixman_format (NULL,
+							src->pixman_format,
+							width, height, 0);
+    if (unlikely (dst->base.status)) {
+	cairo_surface_destroy (&dst->base);
+	return NULL;
+    }
+
+    /* Average each 2x2 block channel by channel, replicating the last
+     * row and column of odd sized sources.
+     */
+    for (y = 0; y < height; y++) {
+	const uint8_t *s0 = src->data + 2 * y * src->stride;
+	const uint8_t *s1 = 2 * y + 1 < src->height ? s0 + src->stride : s0;
+	uint8_t *d = dst->data + y * dst->stride;
+
+	for (x = 0; x < width; x++) {
+	    int x0 = 2 * x * cpp;
+	    int x1 = 2 * x + 1 < src->width ? x0 + cpp : x0;
+
+	    for (c = 0; c < cpp; c++) {
+		*d++ = (s0[x0 + c] + s0[x1 + c] +
+			s1[x0 + c] + s1[x1 + c] + 2) >> 2;
+	    }
+	}
+    }
+
+    dst->base.is_clear = FALSE;
+    return dst;
+}
+
+/* Returns a reference to the level, which remains valid even if the
+ * pyramid is discarded by another thread modifying the source.
+ */
+static cairo_image_surface_t *
+_mipmap_get_level (cairo_image_surface_t *source, int level)
+{
+    struct mipmap *mipmap;
+    cairo_image_surface_t *image;
+    int i;
+
+    CAIRO_MUTEX_LOCK (_cairo_image_source_snapshot_mutex);
+
+    mipmap = (struct mipmap *)
+	_cairo_surface_has_snapshot (&source->base, &mipmap_backend);
+    if (mipmap == NULL) {
+	mipmap = calloc (1, sizeof (struct mipmap));
+	if (unlikely (mipmap == NULL)) {
+	    image = NULL;
+	    goto unlock;
+	}
+
+	_cairo_surface_init (&mipmap->base, &mipmap_backend,
+			     NULL, source->base.content);
+	_cairo_surface_attach_snapshot (&source->base, &mipmap->base, NULL);
+	cairo_surface_destroy (&mipmap->base);
+    }
+
+    image = source;
+    for (i = 0; i <= level; i++) {
+	if (mipmap->level[i] == NULL) {
+	    mipmap->level[i] = _mipmap_downsample (image);
+	    if (unlikely (mipmap->level[i] == NULL)) {
+		image = NULL;
+		goto unlock;
+	    }
+	}
+	image = mipmap->level[i];
+    }
+    cairo_surface_reference (&image->base);
+
+unlock:
+    CAIRO_MUTEX_UNLOCK (_cairo_image_source_snapshot_mutex);
+    return image;
+}
+
+static pixman_image_t *
+_pixman_image_for_mipmap (cairo_image_surface_t *source,
+			  const cairo_pattern_t *pattern,
+			  cairo_extend_t extend,
+			  const cairo_rectangle_int_t *extents,
+			  int *ix, int *iy)
+{
+    const cairo_matrix_t *m = &pattern->matrix;
+    cairo_pattern_t scaled;
+    cairo_image_surface_t *image;
+    pixman_image_t *pixman_image;
+    cairo_matrix_t reduce;
+    double scale;
+    int level;
+
+    if (pattern->filter != CAIRO_FILTER_GOOD &&
+	pattern->filter != CAIRO_FILTER_BEST)
+	return NULL;
+
+    /* Repeating a reduced copy would not preserve the period. */
+    if (extend != CAIRO_EXTEND_NONE && extend != CAIRO_EXTEND_PAD)
+	return NULL;
+
+    switch ((int) source->pixman_format) {
+    case PIXMAN_a8r8g8b8:
+    case PIXMAN_x8r8g8b8:
+    case PIXMAN_a8:
+	break;
+    default:
+	return NULL;
+    }
+
+    /* the number of source pixels stepped over per destination pixel */
+    scale = MIN (hypot (m->xx, m->yx), hypot (m->xy, m->yy));
+    if (scale < 2.)
+	return NULL;
+
+    level = 0;
+    while (scale >= 4. && level + 1 < MIPMAP_MAX_LEVELS) {
+	scale /= 2;
+	level++;
+    }
+
+    image = _mipmap_get_level (source, level);
+    if (image == NULL)
+	return NULL;
+
+    pixman_image = pixman_image_create_bits (image->pixman_format,
+					     image->width,
+					     image->height,
+					     (uint32_t *) image->data,
+					     image->stride);
+    if (unlikely (pixman_image == NULL)) {
+	cairo_surface_destroy (&image->base);
+	return NULL;
+    }
+
+    pixman_image_set_destroy_function (pixman_image,
+				       _defer_free_cleanup,
+				       &image->base);
+
+    /* Odd sized levels round up, so map the level onto exactly the
+     * extents of the source rather than scaling by a power of two.
+     */
+    scaled = *pattern;
+    scaled.extend = extend;
+    cairo_matrix_init_scale (&reduce,
+			     (double) image->width / source->width,
+			     (double) image->height / source->height);
+    cairo_matrix_multiply (&scaled.matrix, m, &reduce);
+
+    if (! _pixman_image_set_properties (pixman_image, &scaled, extents,
+					ix, iy))
+    {
+	pixman_image_unref (pixman_image);
+	return NULL;
+    }
+
+    return pixman_image;
+}
+
+/* CAIRO_FILTER_GAUSSIAN blurs the source with a Gaussian whose standard
+ * deviations are given by _cairo_pattern_gaussian_sigma(). The Gaussian
+ * is approximated by three successive box filters applied separably,
+ * first along the rows and then down the columns, so the cost per pixel
+ * is independent of the radius. The blurred copy is then sampled
+ * bilinearly.
+ *
+ * The result is attached to the source as a snapshot, and so is reused
+ * until either the source is modified or a different radius is asked
+ * for. As with the mip pyramid, the snapshot is only examined or
+ * replaced whilst holding _cairo_image_source_snapshot_mutex.
+ */
+#define GAUSSIAN_ROWS 32
+#define GAUSSIAN_COLUMNS 64
+
+struct gaussian {
+    cairo_surface_t base;
+    cairo_image_surface_t *image;
+    int radius[2][3];
+    int margin[2];
+};
+
+struct gaussian_pass {
+    const uint8_t *src;
+    uint8_t *dst;
+    const uint8_t *zero;
+    int width, height, stride, cpp;
+    int radius;
+    uint32_t inv;
+    cairo_bool_t clamp;
+};
+
+static cairo_status_t
+gaussian_finish (void *abstract_surface)
+{
+    struct gaussian *gaussian = abstract_surface;
+
+    if (gaussian->image != NULL) {
+	cairo_surface_destroy (&gaussian->image->base);
+	gaussian->image = NULL;
+    }
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static const cairo_surface_backend_t gaussian_backend = {
+    CAIRO_INTERNAL_SURFACE_TYPE_NULL,
+    gaussian_finish,
+};
+
+/* Split sigma into the radii of three boxes whose convolution has
+ * (close to) the same variance, see W. Jarosz, "Fast Image Convolutions".
+ */
+static void
+_gaussian_boxes (double sigma, int radius[3])
+{
+    double ideal;
+    int wl, wu, m, i;
+
+    ideal = sqrt (12 * sigma * sigma / 3 + 1);
+    wl = floor (ideal);
+    if ((wl & 1) == 0)
+	wl--;
+    wu = wl + 2;
+
+    m = floor ((12 * sigma * sigma - 3 * wl * wl - 12 * wl - 9) /
+	       (-4 * wl - 4) + .5);
+
+    for (i = 0; i < 3; i++)
+	radius[i] = (i < m ? wl : wu) / 2;
+}
+
+static inline uint32_t
+_gaussian_fetch (const uint8_t *row, int x, int width, int cpp,
+		 cairo_bool_t clamp)
+{
+    if (x < 0) {
+	if (! clamp)
+	    return 0;
+	x = 0;
+    } else if (x >= width) {
+	if (! clamp)
+	    return 0;
+	x = width - 1;
+    }
+
+    return row[x * cpp];
+}
+
+static void
+_gaussian_blur_rows (void *closure, int index)
+{
+    const struct gaussian_pass *pass = closure;
+    int r = pass->radius;
+    int y, y_end, x, c;
+
+    y = index * GAUSSIAN_ROWS;
+    y_end = MIN (y + GAUSSIAN_ROWS, pass->height);
+    for (; y < y_end; y++) {
+	const uint8_t *s = pass->src + y * pass->stride;
+	uint8_t *d = pass->dst + y * pass->stride;
+
+	for (c = 0; c < pass->cpp; c++) {
+	    uint32_t sum = 0;
+
+	    for (x = -r; x <= r; x++)
+		sum += _gaussian_fetch (s + c, x, pass->width, pass->cpp,
+					pass->clamp);
+
+	    for (x = 0; x < pass->width; x++) {
+		d[x * pass->cpp + c] = (sum * pass->inv + (1 << 15)) >> 16;
+		sum += _gaussian_fetch (s + c, x + r + 1,
+					pass->width, pass->cpp, pass->clamp);
+		sum -= _gaussian_fetch (s + c, x - r,
+					pass->width, pass->cpp, pass->clamp);
+	    }
+	}
+    }
+}
+
+static inline const uint8_t *
+_gaussian_row (const struct gaussian_pass *pass, int y)
+{
+    if (y < 0) {
+	if (! pass->clamp)
+	    return pass->zero;
+	y = 0;
+    } else if (y >= pass->height) {
+	if (! pass->clamp)
+	    return pass->zero;
+	y = pass->height - 1;
+    }
+
+    return pass->src + y * pass->stride;
+}
+
+/* The vertical pass walks a strip of columns at a time, keeping a
+ * running sum for every byte of the strip. The inner loops are then
+ * straight runs over contiguous bytes which the compiler turns into
+ * vector code.
+ */
+static void
+_gaussian_blur_columns (void *closure, int index)
+{
+    const struct gaussian_pass *pass = closure;
+    uint32_t sum[GAUSSIAN_COLUMNS];
+    int r = pass->radius;
+    int b0, n, y, b;
+
+    b0 = index * GAUSSIAN_COLUMNS;
+    n = MIN (GAUSSIAN_COLUMNS, pass->width * pass->cpp - b0);
+
+    memset (sum, 0, sizeof (sum));
+    for (y = -r; y <= r; y++) {
+	const uint8_t *s = _gaussian_row (pass, y) + b0;
+	for (b = 0; b < n; b++)
+	    sum[b] += s[b];
+    }
+
+    for (y = 0; y < pass->height; y++) {
+	const uint8_t *add = _gaussian_row (pass, y + r + 1) + b0;
+	const uint8_t *sub = _gaussian_row (pass, y - r) + b0;
+	uint8_t *d = pass->dst + y * pass->stride + b0;
+
+	for (b = 0; b < n; b++) {
+	    d[b] = (sum[b] * pass->inv + (1 << 15)) >> 16;
+	    sum[b] += add[b] - sub[b];
+	}
+    }
+}
+
+static cairo_image_surface_t *
+_gaussian_blur (cairo_image_surface_t *source,
+		const int radius[2][3],
+		const int margin[2],
+		cairo_bool_t clamp)
+{
+    cairo_image_surface_t *image;
+    struct gaussian_pass pass;
+    pixman_format_code_t format;
+    uint8_t *tmp, *buf[2];
+    int width, height, row_bytes, y, i;
+
+    /* Blurring into transparent edges needs an alpha channel. */
+    format = source->pixman_format;
+    if (format == PIXMAN_x8r8g8b8 && ! clamp)
+	format = PIXMAN_a8r8g8b8;
+
+    width  = source->width  + 2 * margin[0];
+    height = source->height + 2 * margin[1];
+    image = (cairo_image_surface_t *)
+	_cairo_image_surface_create_with_pixman_format (NULL, format,
+							width, height, 0);
+    if (unlikely (image->base.status)) {
+	cairo_surface_destroy (&image->base);
+	return NULL;
+    }
+
+    /* The scratch plane, followed by a row of zeroes for the edges. */
+    tmp = _cairo_malloc_ab_plus_c (height, image->stride, image->stride);
+    if (unlikely (tmp == NULL)) {
+	cairo_surface_destroy (&image->base);
+	return NULL;
+    }
+    memset (tmp + height * image->stride, 0, image->stride);
+
+    pass.cpp = PIXMAN_FORMAT_BPP (format) / 8;
+    row_bytes = source->width * pass.cpp;
+    for (y = 0; y < source->height; y++) {
+	uint8_t *d = image->data + (y + margin[1]) * image->stride;
+
+	memcpy (d + margin[0] * pass.cpp,
+		source->data + y * source->stride,
+		row_bytes);
+	if (format != source->pixman_format) {
+	    uint32_t *p = (uint32_t *) d + margin[0];
+	    int x;
+
+	    for (x = 0; x < source->width; x++)
+		p[x] |= 0xff000000;
+	}
+    }
+
+    pass.zero = tmp + height * image->stride;
+    pass.width = width;
+    pass.height = height;
+    pass.stride = image->stride;
+    pass.clamp = clamp;
+
+    /* Three horizontal passes then three vertical, ping-ponging between
+     * the image and the scratch plane so that the result lands back in
+     * the image.
+     */
+    buf[0] = image->data;
+    buf[1] = tmp;
+    for (i = 0; i < 6; i++) {
+	int w;
+
+	pass.src = buf[i & 1];
+	pass.dst = buf[(i + 1) & 1];
+	pass.radius = radius[i / 3][i % 3];
+	w = 2 * pass.radius + 1;
+	pass.inv = ((1 << 16) + w / 2) / w;
+
+	if (i < 3) {
+	    _cairo_thread_pool_run (_gaussian_blur_rows, &pass,
+				    (height + GAUSSIAN_ROWS - 1) / GAUSSIAN_ROWS);
+	} else {
+	    _cairo_thread_pool_run (_gaussian_blur_columns, &pass,
+				    (width * pass.cpp + GAUSSIAN_COLUMNS - 1) / GAUSSIAN_COLUMNS);
+	}
+    }
+
+    free (tmp);
+
+    image->base.is_clear = FALSE;
+    return image;
+}
+
+/* Returns a reference to the blurred copy of the source. */
+static cairo_image_surface_t *
+_gaussian_get (cairo_image_surface_t *source,
+	       const int radius[2][3],
+	       const int margin[2],
+	       cairo_bool_t clamp)
+{
+    struct gaussian *gaussian;
+    cairo_image_surface_t *image = NULL;
+
+    CAIRO_MUTEX_LOCK (_cairo_image_source_snapshot_mutex);
+
+    gaussian = (struct gaussian *)
+	_cairo_surface_has_snapshot (&source->base, &gaussian_backend);
+    if (gaussian != NULL) {
+	if (memcmp (gaussian->margin, margin, sizeof (gaussian->margin)) == 0 &&
+	    memcmp (gaussian->radius, radius, sizeof (gaussian->radius)) == 0)
+	{
+	    image = gaussian->image;
+	    goto done;
+	}
+
+	_cairo_surface_detach_snapshot (&gaussian->base);
+    }
+
+    gaussian = calloc (1, sizeof (struct gaussian));
+    if (unlikely (gaussian == NULL))
+	goto unlock;
+
+    _cairo_surface_init (&gaussian->base, &gaussian_backend,
+			 NULL, source->base.content);
+    memcpy (gaussian->radius, radius, sizeof (gaussian->radius));
+    memcpy (gaussian->margin, margin, sizeof (gaussian->margin));
+    gaussian->image = _gaussian_blur (source, radius, margin, clamp);
+    if (unlikely (gaussian->image == NULL)) {
+	cairo_surface_destroy (&gaussian->base);
+	goto unlock;
+    }
+
+    _cairo_surface_attach_snapshot (&source->base, &gaussian->base, NULL);
+    cairo_surface_destroy (&gaussian->base);
+    image = gaussian->image;
+
+done:
+    cairo_surface_reference (&image->base);
+unlock:
+    CAIRO_MUTEX_UNLOCK (_cairo_image_source_snapshot_mutex);
+    return image;
+}
+
+static pixman_image_t *
+_pixman_image_for_gaussian (cairo_image_surface_t *source,
+			    const cairo_pattern_t *pattern,
+			    const cairo_rectangle_int_t *extents,
+			    int *ix, int *iy)
+{
+    const cairo_matrix_t *m = &pattern->matrix;
+    cairo_pattern_t blurred;
+    cairo_image_surface_t *image;
+    pixman_image_t *pixman_image;
+    cairo_matrix_t offset;
+    cairo_bool_t clamp;
+    double x_sigma, y_sigma;
+    int radius[2][3], margin[2], i;
+
+    if (pattern->filter != CAIRO_FILTER_GAUSSIAN)
+	return NULL;
+
+    /* The blur would have to wrap around the tile. */
+    if (pattern->extend == CAIRO_EXTEND_REPEAT ||
+	pattern->extend == CAIRO_EXTEND_REFLECT)
+	return NULL;
+
+    switch ((int) source->pixman_format) {
+    case PIXMAN_a8r8g8b8:
+    case PIXMAN_x8r8g8b8:
+    case PIXMAN_a8:
+	break;
+    default:
+	return NULL;
+    }
+
+    _cairo_pattern_gaussian_sigma (pattern, &x_sigma, &y_sigma);
+    _gaussian_boxes (x_sigma, radius[0]);
+    _gaussian_boxes (y_sigma, radius[1]);
+
+    /* Without PAD the source fades out into transparency beyond its
+     * edges, so grow the blurred copy by the reach of the kernel.
+     */
+    clamp = pattern->extend == CAIRO_EXTEND_PAD;
+    for (i = 0; i < 2; i++)
+	margin[i] = clamp ? 0 : radius[i][0] + radius[i][1] + radius[i][2];
+
+    image = _gaussian_get (source, radius, margin, clamp);
+    if (image == NULL)
+	return NULL;
+
+    pixman_image = pixman_image_create_bits (image->pixman_format,
+					     image->width,
+					     image->height,
+					     (uint32_t *) image->data,
+					     image->stride);
+    if (unlikely (pixman_image == NULL)) {
+	cairo_surface_destroy (&image->base);
+	return NULL;
+    }
+
+    pixman_image_set_destroy_function (pixman_image,
+				       _defer_free_cleanup,
+				       &image->base);
+
+    blurred = *pattern;
+    blurred.extend = clamp ? CAIRO_EXTEND_PAD : CAIRO_EXTEND_NONE;
+    blurred.filter = CAIRO_FILTER_BILINEAR;
+    cairo_matrix_init_translate (&offset, margin[0], margin[1]);
+    cairo_matrix_multiply (&blurred.matrix, m, &offset);
+
+    if (! _pixman_image_set_properties (pixman_image, &blurred, extents,
+					ix, iy))
+    {
+	pixman_image_unref (pixman_image);
+	return NULL;
+    }
+
+    return pixman_image;
+}
+
 static pixman_image_t *
 _pixman_image_for_surface (cairo_image_surface_t *dst,
 			   const cairo_surface_pattern_t *pattern,
@@ -865,6 +1754,22 @@ _pixman_image_for_surface (cairo_image_surface_t *dst,
 		}
 	    }
 
+	    pixman_image = _pixman_image_for_gaussian (source, &pattern->base,
+						       extents,
+						       ix, iy);
+	    if (pixman_image) {
+		cairo_surface_destroy (defer_free);
+		return pixman_image;
+	    }
+
+	    pixman_image = _pixman_image_for_mipmap (source, &pattern->base,
+						     extend, extents,
+						     ix, iy);
+	    if (pixman_image) {
+		cairo_surface_destroy (defer_free);
+		return pixman_image;
+	    }
+
 #if PIXMAN_HAS_ATOMIC_OPS
 	    /* avoid allocating a 'pattern' image if we can reuse the original */
 	    if (extend == CAIRO_EXTEND_NONE &&
@@ -198,6 +198,22 @@ _cairo_image_surface_finish (void *abstract_surface);
 cairo_private pixman_image_t *
 _pixman_image_for_color (const cairo_color_t *cairo_color);
 
+typedef struct _cairo_image_scratch_stats {
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long discards;
+    size_t pooled_bytes;
+} cairo_image_scratch_stats_t;
+
+cairo_private pixman_image_t *
+_pixman_image_create_scratch (pixman_format_code_t format,
+			      int width, int height,
+			      cairo_bool_t clear,
+			      cairo_bool_t *is_clear);
+
+cairo_private void
+_cairo_image_scratch_get_stats (cairo_image_scratch_stats_t *stats);
+
 cairo_private pixman_image_t *
 _pixman_image_for_pattern (cairo_image_surface_t *dst,
 			   const cairo_pattern_t *pattern,
@@ -730,21 +730,40 @@ _cairo_image_surface_create_similar (void	       *abstract_other,
 				     int		height)
 {
     cairo_image_surface_t *other = abstract_other;
+    pixman_format_code_t pixman_format;
+    pixman_image_t *pixman_image;
+    cairo_surface_t *surface;
+    cairo_bool_t is_clear;
 
     TRACE ((stderr, "%s (other=%u)\n", __FUNCTION__, other->base.unique_id));
 
     if (! _cairo_image_surface_is_size_valid (width, height))
 	return _cairo_surface_create_in_error (_cairo_error (CAIRO_STATUS_INVALID_SIZE));
 
-    if (content == other->base.content) {
-	return _cairo_image_surface_create_with_pixman_format (NULL,
-							       other->pixman_format,
-							       width, height,
-							       0);
+    if (content == other->base.content)
+	pixman_format = other->pixman_format;
+    else
+	pixman_format = _cairo_format_to_pixman_format_code (_cairo_format_from_content (content));
+
+    /* Similar surfaces are mostly compositor temporaries, and all users
+     * of a scratch surface check is_clear, so recycle the pixels without
+     * clearing them.
+     */
+    pixman_image = _pixman_image_create_scratch (pixman_format,
+						 width, height,
+						 FALSE, &is_clear);
+    if (unlikely (pixman_image == NULL))
+	return _cairo_surface_create_in_error (_cairo_error (CAIRO_STATUS_NO_MEMORY));
+
+    surface = _cairo_image_surface_create_for_pixman_image (pixman_image,
+							    pixman_format);
+    if (unlikely (surface->status)) {
+	pixman_image_unref (pixman_image);
+	return surface;
     }
 
-    return _cairo_image_surface_create_with_content (content,
-						     width, height);
+    surface->is_clear = is_clear;
+    return surface;
 }
 
 cairo_surface_t *
@@ -38,12 +38,22 @@
 
 CAIRO_MUTEX_DECLARE (_cairo_pattern_solid_surface_cache_lock)
 
-CAIRO_MUTEX_DECLARE (_cairo_image_solid_cache_mutex)
+CAIRO_MUTEX_DECLARE (_cairo_image_glyph_cache_mutex)
+CAIRO_MUTEX_DECLARE (_cairo_image_scratch_pool_mutex)
+CAIRO_MUTEX_DECLARE (_cairo_image_source_snapshot_mutex)
+CAIRO_MUTEX_DECLARE (_cairo_spans_coverage_cache_mutex_0)
+CAIRO_MUTEX_DECLARE (_cairo_spans_coverage_cache_mutex_1)
+CAIRO_MUTEX_DECLARE (_cairo_spans_coverage_cache_mutex_2)
+CAIRO_MUTEX_DECLARE (_cairo_spans_coverage_cache_mutex_3)
+
+CAIRO_MUTEX_DECLARE (_cairo_pen_cache_mutex)
+CAIRO_MUTEX_DECLARE (_cairo_arc_cache_mutex)
 
 CAIRO_MUTEX_DECLARE (_cairo_toy_font_face_mutex)
 CAIRO_MUTEX_DECLARE (_cairo_intern_string_mutex)
 CAIRO_MUTEX_DECLARE (_cairo_scaled_font_map_mutex)
 CAIRO_MUTEX_DECLARE (_cairo_scaled_glyph_page_cache_mutex)
+CAIRO_MUTEX_DECLARE (_cairo_scaled_glyph_private_mutex)
 CAIRO_MUTEX_DECLARE (_cairo_scaled_font_error_mutex)
 
 #if CAIRO_HAS_FT_FONT
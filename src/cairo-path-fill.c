@@ -104,7 +104,10 @@ _cairo_filler_curve_to (void		*closure,
 			const cairo_point_t	*p3)
 {
     cairo_filler_t *filler = closure;
+    cairo_point_t points[CAIRO_STACK_ARRAY_LENGTH (cairo_point_t)];
     cairo_spline_t spline;
+    cairo_status_t status;
+    int num_points, i;
 
     if (filler->has_limits) {
 	if (! _cairo_spline_intersects (&filler->current_point, p1, p2, p3,
@@ -112,6 +115,23 @@ _cairo_filler_curve_to (void		*closure,
 	    return _cairo_filler_line_to (filler, p3);
     }
 
+    num_points = _cairo_spline_flatten (&filler->current_point, p1, p2, p3,
+					filler->tolerance,
+					points, ARRAY_LENGTH (points));
+    if (num_points) {
+	for (i = 0; i < num_points; i++) {
+	    status = _cairo_polygon_add_external_edge (filler->polygon,
+						       &filler->current_point,
+						       &points[i]);
+	    if (unlikely (status))
+		return status;
+
+	    filler->current_point = points[i];
+	}
+
+	return CAIRO_STATUS_SUCCESS;
+    }
+
     if (! _cairo_spline_init (&spline,
 			      (cairo_spline_add_point_func_t)_cairo_filler_line_to, filler,
 			      &filler->current_point, p1, p2, p3))
@@ -115,6 +115,10 @@ _cairo_path_fixed_append (cairo_path_fixed_t		    *path,
 cairo_private unsigned long
 _cairo_path_fixed_hash (const cairo_path_fixed_t *path);
 
+cairo_private unsigned long
+_cairo_path_fixed_hash_relative (const cairo_path_fixed_t *path,
+				 cairo_fixed_t dx, cairo_fixed_t dy);
+
 cairo_private unsigned long
 _cairo_path_fixed_size (const cairo_path_fixed_t *path);
 
@@ -211,6 +211,31 @@ _cairo_path_fixed_hash (const cairo_path_fixed_t *path)
     return hash;
 }
 
+/* Hashes @path as if it were translated by (-@dx, -@dy), so that copies
+ * of a path at different offsets may be matched without copying them. */
+unsigned long
+_cairo_path_fixed_hash_relative (const cairo_path_fixed_t *path,
+				 cairo_fixed_t dx, cairo_fixed_t dy)
+{
+    unsigned long hash = _CAIRO_HASH_INIT_VALUE;
+    const cairo_path_buf_t *buf;
+    unsigned int i;
+
+    cairo_path_foreach_buf_start (buf, path) {
+	hash = _cairo_hash_bytes (hash, buf->op,
+			          buf->num_ops * sizeof (buf->op[0]));
+	for (i = 0; i < buf->num_points; i++) {
+	    cairo_point_t p;
+
+	    p.x = buf->points[i].x - dx;
+	    p.y = buf->points[i].y - dy;
+	    hash = _cairo_hash_bytes (hash, &p, sizeof (p));
+	}
+    } cairo_path_foreach_buf_end (buf, path);
+
+    return hash;
+}
+
 unsigned long
 _cairo_path_fixed_size (const cairo_path_fixed_t *path)
 {
@@ -956,6 +956,46 @@ _cairo_stroker_line_to (void *closure,
     return CAIRO_STATUS_SUCCESS;
 }
 
+/* Clips one axis of a line, starting at p and moving by d, to [min, max] */
+static cairo_bool_t
+_clip_line_axis (double p, double d, double min, double max,
+		 double *t0, double *t1)
+{
+    double a, b;
+
+    if (d == 0)
+	return p >= min && p <= max;
+
+    a = (min - p) / d;
+    b = (max - p) / d;
+    if (a > b) {
+	double t = a;
+	a = b;
+	b = t;
+    }
+
+    if (a > *t0)
+	*t0 = a;
+    if (b < *t1)
+	*t1 = b;
+    return *t0 <= *t1;
+}
+
+/* Finds the portion [t0, t1] of the line p1-p2 that lies within the box,
+ * as fractions of its length. */
+static cairo_bool_t
+_clip_line_to_box (const cairo_box_t *box,
+		   const cairo_point_t *p1, const cairo_point_t *p2,
+		   double *t0, double *t1)
+{
+    *t0 = 0;
+    *t1 = 1;
+
+    return
+	_clip_line_axis (p1->x, p2->x - p1->x, box->p1.x, box->p2.x, t0, t1) &&
+	_clip_line_axis (p1->y, p2->y - p1->y, box->p1.y, box->p2.y, t0, t1);
+}
+
 /*
  * Dashed lines.  Cap each dash end, join around turns when on
  */
@@ -965,6 +1005,7 @@ _cairo_stroker_line_to_dashed (void *closure,
 {
     cairo_stroker_t *stroker = closure;
     double mag, remain, step_length = 0;
+    double visible_start, visible_end;
     double slope_dx, slope_dy;
     double dx2, dy2;
     cairo_stroke_face_t sub_start, sub_end;
@@ -998,9 +1039,56 @@ _cairo_stroker_line_to_dashed (void *closure,
 	return CAIRO_STATUS_SUCCESS;
     }
 
+    /* Whole periods of the pattern lying outside the bounds can be
+     * skipped over without affecting the dash state, so that only the
+     * visible portion of a long line is walked dash by dash. */
+    visible_start = 0;
+    visible_end = mag;
+    if (! fully_in_bounds && stroker->dash.period > 0) {
+	double t0, t1;
+
+	if (_clip_line_to_box (&stroker->bounds, p1, p2, &t0, &t1)) {
+	    visible_start = t0 * mag;
+	    visible_end = t1 * mag;
+	} else {
+	    visible_start = visible_end = mag;
+	}
+    }
+
     remain = mag;
     segment.p1 = *p1;
     while (remain) {
+	double pos = mag - remain, skip = 0;
+
+	/* ...but the first dash is always kept for the closing join */
+	if (stroker->has_first_face || ! stroker->dash.dash_starts_on) {
+	    double period = stroker->dash.period;
+
+	    if (pos + period <= visible_start)
+		skip = floor ((visible_start - pos) / period) * period;
+	    else if (pos >= visible_end && period <= remain)
+		skip = floor (remain / period) * period;
+	}
+	if (skip > 0) {
+	    if (stroker->has_current_face) {
+		/* Cap final face from previous segment */
+		status = _cairo_stroker_add_trailing_cap (stroker,
+							  &stroker->current_face);
+		if (unlikely (status))
+		    return status;
+
+		stroker->has_current_face = FALSE;
+	    }
+
+	    remain -= skip;
+	    dx2 = slope_dx * (mag - remain);
+	    dy2 = slope_dy * (mag - remain);
+	    cairo_matrix_transform_distance (stroker->ctm, &dx2, &dy2);
+	    segment.p1.x = _cairo_fixed_from_double (dx2) + p1->x;
+	    segment.p1.y = _cairo_fixed_from_double (dy2) + p1->y;
+	    continue;
+	}
+
 	step_length = MIN (stroker->dash.dash_remain, remain);
 	remain -= step_length;
 	dx2 = slope_dx * (mag - remain);
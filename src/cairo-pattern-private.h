@@ -75,6 +75,10 @@ struct _cairo_pattern {
 
     cairo_matrix_t		matrix;
     double			opacity;
+
+    /* the blur of CAIRO_FILTER_GAUSSIAN, zero for the default */
+    double			x_sigma;
+    double			y_sigma;
 };
 
 struct _cairo_solid_pattern {
@@ -288,6 +292,10 @@ _cairo_mesh_pattern_coord_box (const cairo_mesh_pattern_t *mesh,
 			       double                     *out_xmax,
 			       double                     *out_ymax);
 
+cairo_private void
+_cairo_pattern_gaussian_sigma (const cairo_pattern_t *pattern,
+			       double *x_sigma, double *y_sigma);
+
 cairo_private_no_warn cairo_filter_t
 _cairo_pattern_sampled_area (const cairo_pattern_t *pattern,
 			     const cairo_rectangle_int_t *extents,
@@ -231,6 +231,8 @@ _cairo_pattern_init (cairo_pattern_t *pattern, cairo_pattern_type_t type)
 
     pattern->filter    = CAIRO_FILTER_DEFAULT;
     pattern->opacity   = 1.0;
+    pattern->x_sigma   = 0.;
+    pattern->y_sigma   = 0.;
 
     pattern->has_component_alpha = FALSE;
 
@@ -2083,6 +2085,62 @@ cairo_pattern_get_filter (cairo_pattern_t *pattern)
     return pattern->filter;
 }
 
+/**
+ * cairo_pattern_set_sigma:
+ * @pattern: a #cairo_pattern_t
+ * @x_sigma: the standard deviation of the blur along the x axis
+ * @y_sigma: the standard deviation of the blur along the y axis
+ *
+ * Sets the size of the blur applied by %CAIRO_FILTER_GAUSSIAN. The
+ * standard deviations are measured in pattern space, that is in pixels
+ * of the source surface, and so a @pattern drawn at its natural size
+ * with a sigma of 4 gives a soft shadow about a dozen pixels wide.
+ *
+ * A sigma of zero selects the default for that axis, which is just
+ * enough blur to avoid aliasing when the pattern is scaled down. A
+ * blur smaller than that is increased to it, negative sigmas are treated
+ * as zero and sigmas are limited to 128.
+ *
+ * Since: 1.14
+ **/
+void
+cairo_pattern_set_sigma (cairo_pattern_t *pattern,
+			 double x_sigma, double y_sigma)
+{
+    if (pattern->status)
+	return;
+
+    if (! (x_sigma >= 0.))
+	x_sigma = 0.;
+    if (! (y_sigma >= 0.))
+	y_sigma = 0.;
+
+    pattern->x_sigma = x_sigma;
+    pattern->y_sigma = y_sigma;
+    _cairo_pattern_notify_observers (pattern, CAIRO_PATTERN_NOTIFY_FILTER);
+}
+
+/**
+ * cairo_pattern_get_sigma:
+ * @pattern: a #cairo_pattern_t
+ * @x_sigma: return location for the standard deviation along the x axis, or %NULL
+ * @y_sigma: return location for the standard deviation along the y axis, or %NULL
+ *
+ * Gets the size of the blur set with cairo_pattern_set_sigma(). Zero
+ * indicates the default.
+ *
+ * Since: 1.14
+ **/
+void
+cairo_pattern_get_sigma (cairo_pattern_t *pattern,
+			 double *x_sigma, double *y_sigma)
+{
+    if (x_sigma)
+	*x_sigma = pattern->x_sigma;
+    if (y_sigma)
+	*y_sigma = pattern->y_sigma;
+}
+
 /**
  * cairo_pattern_set_extend:
  * @pattern: a #cairo_pattern_t
@@ -3328,6 +3386,43 @@ _cairo_pattern_is_clear (const cairo_pattern_t *abstract_pattern)
     return FALSE;
 }
 
+/**
+ * _cairo_pattern_gaussian_sigma:
+ * @pattern: a pattern using %CAIRO_FILTER_GAUSSIAN
+ * @x_sigma: return location for the standard deviation along x
+ * @y_sigma: return location for the standard deviation along y
+ *
+ * Computes the standard deviations, in pattern space, of the blur that
+ * %CAIRO_FILTER_GAUSSIAN applies to @pattern. Those set by
+ * cairo_pattern_set_sigma() are used, but never less than half the size
+ * of a destination pixel in the source. Without them the blur defaults
+ * to that, but at least one source pixel.
+ **/
+#define GAUSSIAN_MAX_SIGMA 128.
+
+static double
+_gaussian_sigma (double sigma, double scale)
+{
+    if (sigma > 0.)
+	sigma = MAX (sigma, scale);
+    else
+	sigma = MAX (scale, 1.);
+
+    return MIN (sigma, GAUSSIAN_MAX_SIGMA);
+}
+
+void
+_cairo_pattern_gaussian_sigma (const cairo_pattern_t *pattern,
+			       double *x_sigma, double *y_sigma)
+{
+    const cairo_matrix_t *m = &pattern->matrix;
+    double scale;
+
+    scale = .5 * MIN (hypot (m->xx, m->yx), hypot (m->xy, m->yy));
+    *x_sigma = _gaussian_sigma (pattern->x_sigma, scale);
+    *y_sigma = _gaussian_sigma (pattern->y_sigma, scale);
+}
+
 /**
  * _cairo_pattern_analyze_filter:
  * @pattern: surface pattern
@@ -3371,9 +3466,21 @@ _cairo_pattern_analyze_filter (const cairo_pattern_t	*pattern,
 	}
 	break;
 
+    case CAIRO_FILTER_GAUSSIAN:
+	/* The three box passes together reach at most 3 sigma + 3
+	 * pixels, plus half a pixel for the bilinear resampling.
+	 */
+	{
+	    double x_sigma, y_sigma;
+
+	    _cairo_pattern_gaussian_sigma (pattern, &x_sigma, &y_sigma);
+	    pad = 3 * MAX (x_sigma, y_sigma) + 3.5;
+	}
+	optimized_filter = pattern->filter;
+	break;
+
     case CAIRO_FILTER_FAST:
     case CAIRO_FILTER_NEAREST:
-    case CAIRO_FILTER_GAUSSIAN:
     default:
 	pad = 0.;
 	optimized_filter = pattern->filter;
@@ -3790,6 +3897,12 @@ _cairo_pattern_hash (const cairo_pattern_t *pattern)
 				  &pattern->matrix, sizeof (pattern->matrix));
 	hash = _cairo_hash_bytes (hash,
 				  &pattern->filter, sizeof (pattern->filter));
+	if (pattern->filter == CAIRO_FILTER_GAUSSIAN) {
+	    hash = _cairo_hash_bytes (hash,
+				      &pattern->x_sigma, sizeof (pattern->x_sigma));
+	    hash = _cairo_hash_bytes (hash,
+				      &pattern->y_sigma, sizeof (pattern->y_sigma));
+	}
 	hash = _cairo_hash_bytes (hash,
 				  &pattern->extend, sizeof (pattern->extend));
 	hash = _cairo_hash_bytes (hash,
@@ -3945,6 +4058,10 @@ _cairo_pattern_equal (const cairo_pattern_t *a, const cairo_pattern_t *b)
 	if (a->filter != b->filter)
 	    return FALSE;
 
+	if (a->filter == CAIRO_FILTER_GAUSSIAN &&
+	    (a->x_sigma != b->x_sigma || a->y_sigma != b->y_sigma))
+	    return FALSE;
+
 	if (a->extend != b->extend)
 	    return FALSE;
     }
@@ -49,12 +49,132 @@ _cairo_pen_vertices_needed (double tolerance,
 static void
 _cairo_pen_compute_slopes (cairo_pen_t *pen);
 
+/* Drawing many small circles, or many strokes with round caps and joins,
+ * builds the same pen over and over. The most recently built pens are
+ * kept in a small direct-mapped cache, keyed by everything that
+ * determines the vertices, so a repeated pen costs a copy instead of the
+ * trigonometry and slope computation.
+ */
+#define PEN_CACHE_SIZE 16
+#define PEN_CACHE_MAX_VERTICES 256
+
+typedef struct _cairo_pen_key {
+    double radius;
+    double tolerance;
+    double xx, yx, xy, yy;
+} cairo_pen_key_t;
+
+typedef struct _cairo_pen_cache_entry {
+    cairo_pen_key_t key;
+    int num_vertices;
+    cairo_pen_vertex_t *vertices;
+} cairo_pen_cache_entry_t;
+
+static cairo_pen_cache_entry_t pen_cache[PEN_CACHE_SIZE];
+
+static void
+_cairo_pen_key_init (cairo_pen_key_t *key,
+		     double radius,
+		     double tolerance,
+		     const cairo_matrix_t *ctm)
+{
+    key->radius = radius;
+    key->tolerance = tolerance;
+    key->xx = ctm->xx;
+    key->yx = ctm->yx;
+    key->xy = ctm->xy;
+    key->yy = ctm->yy;
+}
+
+static cairo_pen_cache_entry_t *
+_cairo_pen_cache_slot (const cairo_pen_key_t *key)
+{
+    unsigned long hash;
+
+    hash = _cairo_hash_bytes (_CAIRO_HASH_INIT_VALUE, key, sizeof (*key));
+    return &pen_cache[hash % PEN_CACHE_SIZE];
+}
+
+static cairo_int_status_t
+_cairo_pen_cache_lookup (cairo_pen_t *pen, const cairo_pen_key_t *key)
+{
+    cairo_pen_cache_entry_t *entry;
+    cairo_int_status_t status = CAIRO_INT_STATUS_UNSUPPORTED;
+
+    CAIRO_MUTEX_LOCK (_cairo_pen_cache_mutex);
+    entry = _cairo_pen_cache_slot (key);
+    if (entry->vertices != NULL &&
+	memcmp (&entry->key, key, sizeof (*key)) == 0)
+    {
+	pen->num_vertices = entry->num_vertices;
+	pen->vertices = pen->vertices_embedded;
+	if (pen->num_vertices > ARRAY_LENGTH (pen->vertices_embedded)) {
+	    pen->vertices = _cairo_malloc_ab (pen->num_vertices,
+					      sizeof (cairo_pen_vertex_t));
+	}
+
+	if (likely (pen->vertices != NULL)) {
+	    memcpy (pen->vertices, entry->vertices,
+		    pen->num_vertices * sizeof (cairo_pen_vertex_t));
+	    status = CAIRO_INT_STATUS_SUCCESS;
+	} else {
+	    status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
+	}
+    }
+    CAIRO_MUTEX_UNLOCK (_cairo_pen_cache_mutex);
+
+    return status;
+}
+
+static void
+_cairo_pen_cache_insert (const cairo_pen_t *pen, const cairo_pen_key_t *key)
+{
+    cairo_pen_cache_entry_t *entry;
+    cairo_pen_vertex_t *vertices, *evicted;
+
+    if (pen->num_vertices > PEN_CACHE_MAX_VERTICES)
+	return;
+
+    vertices = _cairo_malloc_ab (pen->num_vertices,
+				 sizeof (cairo_pen_vertex_t));
+    if (unlikely (vertices == NULL))
+	return;
+
+    memcpy (vertices, pen->vertices,
+	    pen->num_vertices * sizeof (cairo_pen_vertex_t));
+
+    CAIRO_MUTEX_LOCK (_cairo_pen_cache_mutex);
+    entry = _cairo_pen_cache_slot (key);
+    entry->key = *key;
+    entry->num_vertices = pen->num_vertices;
+    evicted = entry->vertices;
+    entry->vertices = vertices;
+    CAIRO_MUTEX_UNLOCK (_cairo_pen_cache_mutex);
+
+    free (evicted);
+}
+
+void
+_cairo_pen_reset_static_data (void)
+{
+    int i;
+
+    CAIRO_MUTEX_LOCK (_cairo_pen_cache_mutex);
+    for (i = 0; i < PEN_CACHE_SIZE; i++) {
+	free (pen_cache[i].vertices);
+	pen_cache[i].vertices = NULL;
+    }
+    CAIRO_MUTEX_UNLOCK (_cairo_pen_cache_mutex);
+}
+
 cairo_status_t
 _cairo_pen_init (cairo_pen_t	*pen,
 		 double		 radius,
 		 double		 tolerance,
 		 const cairo_matrix_t	*ctm)
 {
+    cairo_pen_key_t key;
+    cairo_int_status_t status;
     int i;
     int reflect;
 
@@ -66,6 +186,11 @@ _cairo_pen_init (cairo_pen_t	*pen,
     pen->radius = radius;
     pen->tolerance = tolerance;
 
+    _cairo_pen_key_init (&key, radius, tolerance, ctm);
+    status = _cairo_pen_cache_lookup (pen, &key);
+    if (status != CAIRO_INT_STATUS_UNSUPPORTED)
+	return status;
+
     reflect = _cairo_matrix_compute_determinant (ctm) < 0.;
 
     pen->num_vertices = _cairo_pen_vertices_needed (tolerance,
@@ -99,6 +224,8 @@ _cairo_pen_init (cairo_pen_t	*pen,
 
     _cairo_pen_compute_slopes (pen);
 
+    _cairo_pen_cache_insert (pen, &key);
+
     return CAIRO_STATUS_SUCCESS;
 }
 
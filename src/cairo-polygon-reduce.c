@@ -41,6 +41,7 @@
 #include "cairo-error-private.h"
 #include "cairo-freelist-private.h"
 #include "cairo-combsort-inline.h"
+#include "cairo-thread-pool-private.h"
 
 typedef cairo_point_t cairo_bo_point32_t;
 
@@ -1430,9 +1431,9 @@ _cairo_bentley_ottmann_tessellate_bo_edges (cairo_bo_event_t   **start_events,
     return status;
 }
 
-cairo_status_t
-_cairo_polygon_reduce (cairo_polygon_t *polygon,
-		       cairo_fill_rule_t fill_rule)
+static cairo_status_t
+_cairo_polygon_reduce_serial (cairo_polygon_t *polygon,
+			      cairo_fill_rule_t fill_rule)
 {
     cairo_status_t status;
     cairo_bo_start_event_t stack_events[CAIRO_STACK_ARRAY_LENGTH (cairo_bo_start_event_t)];
@@ -1475,7 +1476,9 @@ _cairo_polygon_reduce (cairo_polygon_t *polygon,
 	events[i].edge.next = NULL;
     }
 
-    num_limits = polygon->num_limits; polygon->num_limits = 0;
+    /* the edges were clipped when first added */
+    num_limits = polygon->num_limits;
+    polygon->num_limits = 0;
     polygon->num_edges = 0;
 
     status = _cairo_bentley_ottmann_tessellate_bo_edges (event_ptrs,
@@ -1489,3 +1492,118 @@ _cairo_polygon_reduce (cairo_polygon_t *polygon,
 
     return status;
 }
+
+/* Polygons with fewer edges are not worth splitting across threads */
+#define REDUCE_PARALLEL_MIN_EDGES 4096
+#define REDUCE_CLUSTERS_PER_THREAD 4
+
+typedef struct _cairo_reduce_cluster_task {
+    const cairo_polygon_cluster_t *cluster;
+    cairo_fill_rule_t fill_rule;
+    cairo_polygon_t polygon;
+    cairo_status_t status;
+} cairo_reduce_cluster_task_t;
+
+static void
+_cairo_polygon_reduce_cluster (void *closure, int index)
+{
+    cairo_reduce_cluster_task_t *task = (cairo_reduce_cluster_task_t *) closure + index;
+    const cairo_polygon_cluster_t *cluster = task->cluster;
+    cairo_status_t status = CAIRO_STATUS_SUCCESS;
+    int i;
+
+    for (i = 0; i < cluster->num_edges && status == CAIRO_STATUS_SUCCESS; i++) {
+	const cairo_edge_t *e = &cluster->edges[i];
+
+	status = _cairo_polygon_add_line (&task->polygon, &e->line,
+					  e->top, e->bottom, e->dir);
+    }
+
+    if (status == CAIRO_STATUS_SUCCESS)
+	status = _cairo_polygon_reduce_serial (&task->polygon,
+					       task->fill_rule);
+    task->status = status;
+}
+
+/* Reduce the independent clusters of a large polygon on the worker
+ * threads, then gather their edges back into the polygon. */
+static cairo_status_t
+_cairo_polygon_reduce_clusters (cairo_polygon_t *polygon,
+				const cairo_polygon_cluster_t *clusters,
+				int num_clusters,
+				cairo_fill_rule_t fill_rule)
+{
+    cairo_reduce_cluster_task_t *tasks;
+    cairo_status_t status;
+    int num_limits, i, j;
+
+    tasks = _cairo_malloc_ab (num_clusters,
+			      sizeof (cairo_reduce_cluster_task_t));
+    if (unlikely (tasks == NULL))
+	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+
+    for (i = 0; i < num_clusters; i++) {
+	tasks[i].cluster = &clusters[i];
+	tasks[i].fill_rule = fill_rule;
+	_cairo_polygon_init (&tasks[i].polygon, NULL, 0);
+    }
+
+    _cairo_thread_pool_run (_cairo_polygon_reduce_cluster, tasks, num_clusters);
+
+    /* the edges were clipped when first added */
+    num_limits = polygon->num_limits;
+    polygon->num_limits = 0;
+    polygon->num_edges = 0;
+
+    status = CAIRO_STATUS_SUCCESS;
+    for (i = 0; i < num_clusters; i++) {
+	cairo_reduce_cluster_task_t *task = &tasks[i];
+
+	if (status == CAIRO_STATUS_SUCCESS)
+	    status = task->status;
+
+	for (j = 0; j < task->polygon.num_edges && status == CAIRO_STATUS_SUCCESS; j++) {
+	    const cairo_edge_t *e = &task->polygon.edges[j];
+
+	    status = _cairo_polygon_add_line (polygon, &e->line,
+					      e->top, e->bottom, e->dir);
+	}
+
+	_cairo_polygon_fini (&task->polygon);
+    }
+
+    polygon->num_limits = num_limits;
+
+    free (tasks);
+    return status;
+}
+
+cairo_status_t
+_cairo_polygon_reduce (cairo_polygon_t *polygon,
+		       cairo_fill_rule_t fill_rule)
+{
+    if (polygon->num_edges >= REDUCE_PARALLEL_MIN_EDGES &&
+	_cairo_thread_pool_get_num_threads () > 1)
+    {
+	cairo_polygon_cluster_t *clusters;
+	cairo_status_t status;
+	int num_clusters;
+
+	status = _cairo_polygon_partition (polygon,
+					   _cairo_thread_pool_get_num_threads () *
+					   REDUCE_CLUSTERS_PER_THREAD,
+					   &clusters, &num_clusters);
+	if (unlikely (status))
+	    return status;
+
+	if (num_clusters) {
+	    status = _cairo_polygon_reduce_clusters (polygon,
+						     clusters, num_clusters,
+						     fill_rule);
+	    free (clusters);
+	    return status;
+	}
+    }
+
+    return _cairo_polygon_reduce_serial (polygon, fill_rule);
+}
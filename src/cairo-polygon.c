@@ -38,6 +38,7 @@
 #include "cairoint.h"
 
 #include "cairo-boxes-private.h"
+#include "cairo-combsort-inline.h"
 #include "cairo-contour-private.h"
 #include "cairo-error-private.h"
 
@@ -588,3 +589,420 @@ _cairo_polygon_translate (cairo_polygon_t *polygon, int dx, int dy)
 	e->line.p2.y += dy;
     }
 }
+
+/* Partitioning into independent clusters.
+ *
+ * Two sets of edges may be tessellated separately if no edge of one
+ * can intersect an edge of the other, and if neither changes the
+ * winding number anywhere inside the other. A set whose edges have zero
+ * net winding on every scanline, i.e. forms closed contours, can only
+ * affect points between its leftmost and rightmost edges on that
+ * scanline. A set opened up by clipping to the limits affects
+ * everything to the right of its leftmost edge.
+ *
+ * So we cut the polygon into rows and, within each row, take the span
+ * of every set from the bounding boxes of its edges. Sets whose spans
+ * overlap in any row are joined, starting from the individual edges,
+ * and the spans recomputed until they are all disjoint.
+ */
+
+#define PARTITION_MIN_ROWS 16
+#define PARTITION_MAX_SPANS_PER_EDGE 8
+#define PARTITION_MAX_ITERATIONS 8
+
+typedef struct _cairo_partition_span {
+    int set;
+    int32_t x1, x2;
+} cairo_partition_span_t;
+
+typedef struct _cairo_edge_crossing {
+    int32_t y;
+    int dir;
+} cairo_edge_crossing_t;
+
+#define _cairo_partition_span_compare_set(a, b) ((a).set - (b).set)
+#define _cairo_partition_span_compare_x1(a, b) ((a).x1 - (b).x1)
+#define _cairo_edge_crossing_compare(a, b) ((a).y - (b).y)
+
+CAIRO_COMBSORT_DECLARE (_cairo_partition_span_sort_by_set,
+			cairo_partition_span_t,
+			_cairo_partition_span_compare_set)
+
+CAIRO_COMBSORT_DECLARE (_cairo_partition_span_sort_by_x1,
+			cairo_partition_span_t,
+			_cairo_partition_span_compare_x1)
+
+CAIRO_COMBSORT_DECLARE (_cairo_edge_crossing_sort,
+			cairo_edge_crossing_t,
+			_cairo_edge_crossing_compare)
+
+static int
+_partition_find (int *parent, int i)
+{
+    while (parent[i] != i) {
+	parent[i] = parent[parent[i]];
+	i = parent[i];
+    }
+    return i;
+}
+
+/* The lowest index always becomes the root of the joined set, so that
+ * every edge follows the root of its set. */
+static cairo_bool_t
+_partition_join (int *parent, int a, int b)
+{
+    a = _partition_find (parent, a);
+    b = _partition_find (parent, b);
+    if (a == b)
+	return FALSE;
+
+    if (a < b)
+	parent[b] = a;
+    else
+	parent[a] = b;
+    return TRUE;
+}
+
+/* Flags the sets whose edges do not sum to zero on every scanline.
+ * Expects each edge to point directly at the root of its set. */
+static void
+_partition_find_open_sets (const cairo_polygon_t *polygon,
+			   const int *parent,
+			   int *set_end,
+			   cairo_edge_crossing_t *crossings,
+			   int *open)
+{
+    int num_edges = polygon->num_edges;
+    int set, start, winding, i;
+
+    /* bucket the crossings of each set together */
+    memset (set_end, 0, num_edges * sizeof (int));
+    for (i = 0; i < num_edges; i++)
+	set_end[parent[i]] += 2;
+    for (start = i = 0; i < num_edges; i++) {
+	int count = set_end[i];
+
+	set_end[i] = start;
+	start += count;
+    }
+    for (i = 0; i < num_edges; i++) {
+	const cairo_edge_t *e = &polygon->edges[i];
+	cairo_edge_crossing_t *c = &crossings[set_end[parent[i]]];
+
+	c[0].y = e->top;
+	c[0].dir = e->dir;
+	c[1].y = e->bottom;
+	c[1].dir = -e->dir;
+	set_end[parent[i]] += 2;
+    }
+
+    for (start = set = 0; set < num_edges; start = set_end[set++]) {
+	open[set] = FALSE;
+	if (parent[set] != set)
+	    continue;
+
+	_cairo_edge_crossing_sort (crossings + start, set_end[set] - start);
+
+	winding = 0;
+	for (i = start; i < set_end[set]; i++) {
+	    winding += crossings[i].dir;
+	    if (winding != 0 &&
+		(i + 1 == set_end[set] || crossings[i+1].y != crossings[i].y))
+	    {
+		open[set] = TRUE;
+		break;
+	    }
+	}
+    }
+}
+
+/* Reduces the spans of a row to one per set, and joins the sets whose
+ * spans overlap. Returns TRUE if any sets were joined. */
+static cairo_bool_t
+_partition_join_row (cairo_partition_span_t *spans, int num_spans,
+		     const int *open, int32_t right, int *parent)
+{
+    cairo_bool_t joined = FALSE;
+    int32_t x2;
+    int set, i, n;
+
+    if (num_spans == 0)
+	return FALSE;
+
+    _cairo_partition_span_sort_by_set (spans, num_spans);
+    for (n = 0, i = 1; i < num_spans; i++) {
+	if (spans[i].set == spans[n].set) {
+	    if (spans[i].x1 < spans[n].x1)
+		spans[n].x1 = spans[i].x1;
+	    if (spans[i].x2 > spans[n].x2)
+		spans[n].x2 = spans[i].x2;
+	} else
+	    spans[++n] = spans[i];
+    }
+    num_spans = n + 1;
+
+    for (i = 0; i < num_spans; i++) {
+	if (open[spans[i].set])
+	    spans[i].x2 = right;
+    }
+
+    _cairo_partition_span_sort_by_x1 (spans, num_spans);
+    set = spans[0].set;
+    x2 = spans[0].x2;
+    for (i = 1; i < num_spans; i++) {
+	if (spans[i].x1 <= x2) {
+	    joined |= _partition_join (parent, set, spans[i].set);
+	    if (spans[i].x2 > x2)
+		x2 = spans[i].x2;
+	} else {
+	    set = spans[i].set;
+	    x2 = spans[i].x2;
+	}
+    }
+
+    return joined;
+}
+
+static void
+_box_add_box (cairo_box_t *box, const cairo_box_t *other)
+{
+    if (other->p1.x < box->p1.x)
+	box->p1.x = other->p1.x;
+    if (other->p1.y < box->p1.y)
+	box->p1.y = other->p1.y;
+    if (other->p2.x > box->p2.x)
+	box->p2.x = other->p2.x;
+    if (other->p2.y > box->p2.y)
+	box->p2.y = other->p2.y;
+}
+
+/**
+ * _cairo_polygon_partition:
+ * @polygon: the polygon to split
+ * @max_clusters: the most clusters to return
+ * @clusters_out: return location for the array of clusters
+ * @num_clusters_out: return location for the number of clusters
+ *
+ * Splits the edges of @polygon into clusters that can be tessellated
+ * independently of each other and whose results, taken together, are
+ * equivalent to tessellating the whole polygon. Small clusters are
+ * coalesced so that at most @max_clusters are returned.
+ *
+ * The clusters and copies of their edges are returned in a single
+ * allocation to be released with free(). If the polygon cannot be
+ * split, no clusters are returned and @num_clusters_out is set to 0.
+ *
+ * Return value: %CAIRO_STATUS_SUCCESS or %CAIRO_STATUS_NO_MEMORY.
+ **/
+cairo_status_t
+_cairo_polygon_partition (const cairo_polygon_t *polygon,
+			  int max_clusters,
+			  cairo_polygon_cluster_t **clusters_out,
+			  int *num_clusters_out)
+{
+    cairo_polygon_cluster_t *clusters, *cluster;
+    cairo_partition_span_t *spans = NULL;
+    cairo_edge_crossing_t *crossings;
+    cairo_box_t *boxes, bounds;
+    cairo_edge_t *edges;
+    int *parent, *open, *scratch, *row_start, *row_end;
+    int num_edges = polygon->num_edges;
+    int num_rows, row_height, num_spans;
+    int64_t height;
+    int num_clusters, target, count, iteration, i, j;
+    cairo_status_t status;
+    cairo_bool_t joined;
+    void *buf;
+
+    *clusters_out = NULL;
+    *num_clusters_out = 0;
+
+    if (max_clusters < 2 || num_edges < 2)
+	return CAIRO_STATUS_SUCCESS;
+
+    /* size the rows to the edges so that each crosses only a few */
+    height = 0;
+    for (i = 0; i < num_edges; i++)
+	height += polygon->edges[i].bottom - polygon->edges[i].top;
+    row_height = height / num_edges + 1;
+
+    num_rows = (polygon->extents.p2.y - polygon->extents.p1.y) / row_height + 1;
+    if (num_rows < PARTITION_MIN_ROWS)
+	num_rows = PARTITION_MIN_ROWS;
+    if (num_rows > num_edges)
+	num_rows = num_edges;
+
+    buf = _cairo_malloc_ab_plus_c (num_edges,
+				   sizeof (cairo_box_t) +
+				   2 * sizeof (cairo_edge_crossing_t) +
+				   3 * sizeof (int),
+				   2 * (num_rows + 1) * sizeof (int));
+    if (unlikely (buf == NULL))
+	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+
+    boxes = buf;
+    crossings = (cairo_edge_crossing_t *) (boxes + num_edges);
+    parent = (int *) (crossings + 2 * num_edges);
+    open = parent + num_edges;
+    scratch = open + num_edges;
+    row_start = scratch + num_edges;
+    row_end = row_start + num_rows + 1;
+
+    bounds.p1.x = bounds.p1.y = INT32_MAX;
+    bounds.p2.x = bounds.p2.y = INT32_MIN;
+    for (i = 0; i < num_edges; i++) {
+	const cairo_edge_t *e = &polygon->edges[i];
+	cairo_fixed_t xt, xb;
+
+	xt = e->line.p1.x;
+	if (e->top != e->line.p1.y)
+	    xt = _cairo_edge_compute_intersection_x_for_y (&e->line.p1,
+							   &e->line.p2,
+							   e->top);
+	xb = e->line.p2.x;
+	if (e->bottom != e->line.p2.y)
+	    xb = _cairo_edge_compute_intersection_x_for_y (&e->line.p1,
+							   &e->line.p2,
+							   e->bottom);
+
+	/* pad by a unit to absorb any rounding of the intersections */
+	boxes[i].p1.x = MIN (xt, xb) - 1;
+	boxes[i].p2.x = MAX (xt, xb) + 1;
+	boxes[i].p1.y = e->top;
+	boxes[i].p2.y = e->bottom;
+	_box_add_box (&bounds, &boxes[i]);
+
+	parent[i] = i;
+	open[i] = FALSE;
+    }
+
+    /* count the rows crossed by each edge */
+    row_height = (bounds.p2.y - bounds.p1.y) / num_rows + 1;
+    memset (row_start, 0, (num_rows + 1) * sizeof (int));
+    for (i = 0; i < num_edges; i++) {
+	int r1 = (boxes[i].p1.y - bounds.p1.y) / row_height;
+	int r2 = (boxes[i].p2.y - 1 - bounds.p1.y) / row_height;
+
+	for (j = r1; j <= r2; j++)
+	    row_start[j]++;
+    }
+    for (num_spans = j = 0; j <= num_rows; j++) {
+	int n = row_start[j];
+
+	row_start[j] = num_spans;
+	num_spans += n;
+    }
+
+    status = CAIRO_STATUS_SUCCESS;
+
+    /* tall edges will join most everything anyway */
+    if (num_spans > PARTITION_MAX_SPANS_PER_EDGE * num_edges)
+	goto FAIL;
+
+    spans = _cairo_malloc_ab (num_spans, sizeof (cairo_partition_span_t));
+    if (unlikely (spans == NULL)) {
+	status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
+	goto FAIL;
+    }
+
+    /* The first pass joins just the edges that meet; only then is it
+     * worth looking for the sets that are open. */
+    for (iteration = 0; ; iteration++) {
+	if (iteration == PARTITION_MAX_ITERATIONS)
+	    goto FAIL;
+
+	for (i = 0; i < num_edges; i++)
+	    parent[i] = parent[parent[i]];
+
+	if (iteration)
+	    _partition_find_open_sets (polygon, parent, scratch, crossings, open);
+
+	memcpy (row_end, row_start, (num_rows + 1) * sizeof (int));
+	for (i = 0; i < num_edges; i++) {
+	    int r1 = (boxes[i].p1.y - bounds.p1.y) / row_height;
+	    int r2 = (boxes[i].p2.y - 1 - bounds.p1.y) / row_height;
+
+	    for (j = r1; j <= r2; j++) {
+		cairo_partition_span_t *span = &spans[row_end[j]++];
+
+		span->set = parent[i];
+		span->x1 = boxes[i].p1.x;
+		span->x2 = boxes[i].p2.x;
+	    }
+	}
+
+	joined = FALSE;
+	for (j = 0; j < num_rows; j++) {
+	    joined |= _partition_join_row (spans + row_start[j],
+					   row_end[j] - row_start[j],
+					   open, bounds.p2.x, parent);
+	}
+
+	if (iteration && ! joined)
+	    break;
+    }
+
+    /* coalesce the sets into clusters of roughly equal size */
+    memset (scratch, 0, num_edges * sizeof (int));
+    for (i = 0; i < num_edges; i++)
+	scratch[parent[i]]++;
+
+    target = (num_edges + max_clusters - 1) / max_clusters;
+    num_clusters = 0;
+    count = 0;
+    for (i = 0; i < num_edges; i++) {
+	if (parent[i] != i)
+	    continue;
+
+	if (num_clusters == 0 ||
+	    (count >= target && num_clusters < max_clusters))
+	{
+	    num_clusters++;
+	    count = 0;
+	}
+	count += scratch[i];
+	scratch[i] = num_clusters - 1;
+    }
+    if (num_clusters < 2)
+	goto FAIL;
+
+    clusters = _cairo_malloc_ab_plus_c (num_clusters,
+					sizeof (cairo_polygon_cluster_t),
+					num_edges * sizeof (cairo_edge_t));
+    if (unlikely (clusters == NULL)) {
+	status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
+	goto FAIL;
+    }
+    edges = (cairo_edge_t *) (clusters + num_clusters);
+
+    for (i = 0; i < num_clusters; i++) {
+	clusters[i].extents.p1.x = clusters[i].extents.p1.y = INT32_MAX;
+	clusters[i].extents.p2.x = clusters[i].extents.p2.y = INT32_MIN;
+	clusters[i].num_edges = 0;
+    }
+    for (i = 0; i < num_edges; i++) {
+	cluster = &clusters[scratch[parent[i]]];
+	_box_add_box (&cluster->extents, &boxes[i]);
+	cluster->num_edges++;
+    }
+
+    /* and distribute the edges */
+    for (j = i = 0; i < num_clusters; i++) {
+	clusters[i].edges = edges + j;
+	j += clusters[i].num_edges;
+	clusters[i].num_edges = 0;
+    }
+    for (i = 0; i < num_edges; i++) {
+	cluster = &clusters[scratch[parent[i]]];
+	cluster->edges[cluster->num_edges++] = polygon->edges[i];
+    }
+
+    *clusters_out = clusters;
+    *num_clusters_out = num_clusters;
+    status = CAIRO_STATUS_SUCCESS;
+
+FAIL:
+    free (spans);
+    free (buf);
+    return status;
+}
@@ -41,6 +41,7 @@
 #include "cairo.h"
 
 #include "cairo-types-private.h"
+#include "cairo-atomic-private.h"
 #include "cairo-list-private.h"
 #include "cairo-mutex-type-private.h"
 #include "cairo-reference-count-private.h"
@@ -49,6 +50,8 @@ CAIRO_BEGIN_DECLS
 
 typedef struct _cairo_scaled_glyph_page cairo_scaled_glyph_page_t;
 
+#define CAIRO_SCALED_GLYPH_LOOKUP_SIZE 256
+
 struct _cairo_scaled_font {
     /* For most cairo objects, the rule for multiple threads is that
      * the user is responsible for any locking if the same object is
@@ -73,11 +76,26 @@ struct _cairo_scaled_font {
      *    map itself, (and the magic holdovers array).
      *
      * 2. The cache of glyphs (scaled_font->glyphs)
+     *
+     *    Modifications to the glyph hash table and the list of glyph
+     *    pages are protected by scaled_font->glyph_mutex. Glyphs are
+     *    pinned, so that their pages cannot be evicted, for as long
+     *    as scaled_font->cache_frozen is non-zero. Glyphs that are
+     *    already cached are found through scaled_font->glyph_lookup
+     *    without taking any lock.
+     *
      * 3. The backend private data (scaled_font->surface_backend,
      *				    scaled_font->surface_private)
      *
      *    Modifications to these fields are protected with locks on
      *    scaled_font->mutex in the generic scaled_font code.
+     *
+     * 4. The cache of text converted to glyphs (scaled_font->text_cache,
+     *					       scaled_font->text_lru)
+     *
+     *    Lookups and modifications are protected by
+     *    scaled_font->text_mutex, which is never held whilst taking
+     *    any other lock.
      */
 
     cairo_hash_entry_t hash_entry;
@@ -98,6 +116,7 @@ struct _cairo_scaled_font {
     unsigned int placeholder : 1; /*  protected by fontmap mutex */
     unsigned int holdover : 1;
     unsigned int finished : 1;
+    unsigned int glyph_phases : 1;
 
     /* "live" scaled_font members */
     cairo_matrix_t scale;	     /* font space => device space */
@@ -109,16 +128,26 @@ struct _cairo_scaled_font {
     /* The mutex protects modification to all subsequent fields. */
     cairo_mutex_t mutex;
 
+    cairo_mutex_t glyph_mutex;
     cairo_hash_table_t *glyphs;
     cairo_list_t glyph_pages;
-    cairo_bool_t cache_frozen;
-    cairo_bool_t global_cache_frozen;
+    cairo_atomic_int_t cache_frozen;
+    unsigned int overfull_glyph_shards;
+
+    cairo_mutex_t text_mutex;
+    cairo_hash_table_t *text_cache;
+    cairo_list_t text_lru;
+    unsigned int num_texts;
 
     cairo_list_t dev_privates;
 
     /* font backend managing this scaled font */
     const cairo_scaled_font_backend_t *backend;
     cairo_list_t link;
+
+    /* direct-mapped by glyph index and written under glyph_mutex; each
+     * entry is a glyph tagged with the info it had when it was stored */
+    void *glyph_lookup[CAIRO_SCALED_GLYPH_LOOKUP_SIZE];
 };
 
 struct _cairo_scaled_font_private {
@@ -141,6 +170,7 @@ struct _cairo_scaled_glyph {
     cairo_image_surface_t   *surface;		/* device-space image */
     cairo_path_fixed_t	    *path;		/* device-space outline */
     cairo_surface_t         *recording_surface;	/* device-space recording-surface */
+    cairo_scaled_glyph_page_t *page;		/* the page holding this glyph */
 
     const void		   *dev_private_key;
     void		   *dev_private;
@@ -178,6 +208,10 @@ _cairo_scaled_glyph_attach_private (cairo_scaled_glyph_t *scaled_glyph,
 						    cairo_scaled_glyph_t *,
 						    cairo_scaled_font_t *));
 
+cairo_private void
+_cairo_scaled_glyph_detach_private (cairo_scaled_glyph_t *scaled_glyph,
+				   cairo_scaled_glyph_private_t *priv);
+
 CAIRO_END_DECLS
 
 #endif /* CAIRO_SCALED_FONT_PRIVATE_H */
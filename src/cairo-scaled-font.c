@@ -42,7 +42,9 @@
 #include "cairo-error-private.h"
 #include "cairo-image-surface-private.h"
 #include "cairo-list-inline.h"
+#include "cairo-path-fixed-private.h"
 #include "cairo-pattern-private.h"
+#include "cairo-recording-surface-private.h"
 #include "cairo-scaled-font-private.h"
 #include "cairo-surface-backend-private.h"
 
@@ -80,20 +82,120 @@ _cairo_scaled_font_compute_hash (cairo_scaled_font_t *scaled_font);
  * global pool and ameliorates the memory allocation pressure.
  */
 
-/* XXX: This number is arbitrary---we've never done any measurement of this. */
-#define MAX_GLYPH_PAGES_CACHED 512
-static cairo_cache_t cairo_scaled_glyph_page_cache;
+/* The pool is limited by the memory held by the glyphs and their images,
+ * paths and recordings, rather than by the number of glyphs, see
+ * cairo_glyph_cache_set_max_size(). The default is about what 512 pages
+ * of small text glyphs take.
+ */
+#define CAIRO_SCALED_GLYPH_CACHE_DEFAULT_SIZE (8 << 20)
+
+/* Glyphs of fonts larger than this many device pixels are not cached as
+ * images but filled from their outlines, as a single one of them takes
+ * about as much room as a page of body text, see
+ * cairo_glyph_cache_set_max_glyph_size().
+ */
+#define CAIRO_SCALED_GLYPH_CACHE_DEFAULT_MAX_GLYPH_SIZE 256.
+
+/* To keep threads that are creating glyphs from contending for a single
+ * lock, the pool is split into shards, each with its own mutex and an
+ * equal share of the budget. The pages of every font are spread across
+ * all the shards, so a single heavily used font may still fill the pool.
+ *
+ * Each shard keeps its pages on a clock: a page is marked whenever one of
+ * its glyphs is found, and the hand gives marked pages a second chance.
+ * Of the first few unmarked pages the hand passes, the largest is evicted.
+ *
+ * A page can only be evicted whilst its font is not frozen. The evictor
+ * claims the font by swapping its freeze count from 0 to
+ * CAIRO_SCALED_FONT_EVICTING, and anyone trying to freeze the font in the
+ * meantime waits for the shard to be released.
+ */
+#define CAIRO_SCALED_GLYPH_PAGE_SHARDS 8
+#define CAIRO_SCALED_GLYPH_PAGE_CANDIDATES 4
+#define CAIRO_SCALED_FONT_EVICTING -1
+
+typedef struct _cairo_scaled_glyph_page_shard {
+    cairo_mutex_t mutex;
+    cairo_list_t pages;
+    unsigned int num_pages;
+    unsigned long size;
+    unsigned int evictions;
+} cairo_scaled_glyph_page_shard_t;
+
+static cairo_scaled_glyph_page_shard_t
+cairo_scaled_glyph_page_shards[CAIRO_SCALED_GLYPH_PAGE_SHARDS];
+static cairo_atomic_int_t cairo_scaled_glyph_page_shards_initialized;
+static unsigned long cairo_scaled_glyph_cache_max_size =
+    CAIRO_SCALED_GLYPH_CACHE_DEFAULT_SIZE;
+static double cairo_scaled_glyph_cache_max_glyph_size =
+    CAIRO_SCALED_GLYPH_CACHE_DEFAULT_MAX_GLYPH_SIZE;
+
+/* Lookups are counted in a few stripes, chosen by where the calling
+ * thread's stack lies, so that threads finding glyphs do not all write to
+ * the same cache line. */
+#define CAIRO_SCALED_GLYPH_CACHE_STRIPES 16
+
+typedef struct _cairo_scaled_glyph_cache_stripe {
+    cairo_atomic_int_t hits;
+    cairo_atomic_int_t misses;
+    cairo_atomic_int_t text_hits;
+    cairo_atomic_int_t text_misses;
+    cairo_atomic_int_t text_evictions;
+    char pad[64 - 5 * sizeof (cairo_atomic_int_t)];
+} cairo_scaled_glyph_cache_stripe_t;
+
+static cairo_scaled_glyph_cache_stripe_t
+cairo_scaled_glyph_cache_stripes[CAIRO_SCALED_GLYPH_CACHE_STRIPES];
 
 #define CAIRO_SCALED_GLYPH_PAGE_SIZE 32
 struct _cairo_scaled_glyph_page {
-    cairo_cache_entry_t cache_entry;
+    cairo_scaled_font_t *scaled_font;
 
     cairo_list_t link;
+    cairo_list_t shard_link;
+    unsigned int shard;
+    unsigned long size;
+    cairo_bool_t referenced; /* set without locking whenever it is used */
 
     unsigned int num_glyphs;
     cairo_scaled_glyph_t glyphs[CAIRO_SCALED_GLYPH_PAGE_SIZE];
 };
 
+/* Entries in scaled_font->glyph_lookup carry the SURFACE and PATH info the
+ * glyph had when it was stored in the low bits of the pointer, so that a
+ * single load tells a reader which fields it may use. Amending a glyph only
+ * ever adds info, and every cached glyph has its metrics.
+ */
+#define CAIRO_SCALED_GLYPH_LOOKUP_INFO \
+    (CAIRO_SCALED_GLYPH_INFO_SURFACE | CAIRO_SCALED_GLYPH_INFO_PATH)
+#define CAIRO_SCALED_GLYPH_LOOKUP_TAG_MASK ((uintptr_t) 3)
+
+COMPILE_TIME_ASSERT ((CAIRO_SCALED_GLYPH_LOOKUP_INFO >> 1) ==
+		     CAIRO_SCALED_GLYPH_LOOKUP_TAG_MASK);
+
+static inline void *
+_cairo_scaled_glyph_lookup_entry (cairo_scaled_glyph_t *scaled_glyph)
+{
+    uintptr_t tag;
+
+    tag = (scaled_glyph->has_info & CAIRO_SCALED_GLYPH_LOOKUP_INFO) >> 1;
+    return (void *) ((uintptr_t) scaled_glyph | tag);
+}
+
+static inline cairo_scaled_glyph_t *
+_cairo_scaled_glyph_lookup_entry_glyph (void *entry)
+{
+    return (cairo_scaled_glyph_t *)
+	((uintptr_t) entry & ~CAIRO_SCALED_GLYPH_LOOKUP_TAG_MASK);
+}
+
+static inline cairo_scaled_glyph_info_t
+_cairo_scaled_glyph_lookup_entry_info (void *entry)
+{
+    return CAIRO_SCALED_GLYPH_INFO_METRICS |
+	(((uintptr_t) entry & CAIRO_SCALED_GLYPH_LOOKUP_TAG_MASK) << 1);
+}
+
 /*
  *  Notes:
  *
@@ -202,15 +304,27 @@ struct _cairo_scaled_glyph_page {
 static void
 _cairo_scaled_font_fini_internal (cairo_scaled_font_t *scaled_font);
 
+static void
+_cairo_scaled_font_reset_text_cache (cairo_scaled_font_t *scaled_font);
+
 static void
 _cairo_scaled_glyph_fini (cairo_scaled_font_t *scaled_font,
 			  cairo_scaled_glyph_t *scaled_glyph)
 {
-    while (! cairo_list_is_empty (&scaled_glyph->dev_privates)) {
-	cairo_scaled_glyph_private_t *private =
-	    cairo_list_first_entry (&scaled_glyph->dev_privates,
-				    cairo_scaled_glyph_private_t,
-				    link);
+    while (TRUE) {
+	cairo_scaled_glyph_private_t *private = NULL;
+
+	CAIRO_MUTEX_LOCK (_cairo_scaled_glyph_private_mutex);
+	if (! cairo_list_is_empty (&scaled_glyph->dev_privates)) {
+	    private = cairo_list_first_entry (&scaled_glyph->dev_privates,
+					      cairo_scaled_glyph_private_t,
+					      link);
+	}
+	CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_private_mutex);
+	if (private == NULL)
+	    break;
+
+	/* the destroy callback detaches the private */
 	private->destroy (private, scaled_glyph, scaled_font);
     }
 
@@ -243,16 +357,22 @@ static const cairo_scaled_font_t _cairo_scaled_font_nil = {
     FALSE,			/* placeholder */
     FALSE,			/* holdover */
     TRUE,			/* finished */
+    FALSE,			/* glyph_phases */
     { 1., 0., 0., 1., 0, 0},	/* scale */
     { 1., 0., 0., 1., 0, 0},	/* scale_inverse */
     1.,				/* max_scale */
     { 0., 0., 0., 0., 0. },	/* extents */
     { 0., 0., 0., 0., 0. },	/* fs_extents */
     CAIRO_MUTEX_NIL_INITIALIZER,/* mutex */
+    CAIRO_MUTEX_NIL_INITIALIZER,/* glyph_mutex */
     NULL,			/* glyphs */
     { NULL, NULL },		/* pages */
-    FALSE,			/* cache_frozen */
-    FALSE,			/* global_cache_frozen */
+    0,				/* cache_frozen */
+    0,				/* overfull_glyph_shards */
+    CAIRO_MUTEX_NIL_INITIALIZER,/* text_mutex */
+    NULL,			/* text_cache */
+    { NULL, NULL },		/* text_lru */
+    0,				/* num_texts */
     { NULL, NULL },		/* privates */
     NULL			/* backend */
 };
@@ -449,27 +569,235 @@ _cairo_scaled_font_map_destroy (void)
  CLEANUP_MUTEX_LOCK:
     CAIRO_MUTEX_UNLOCK (_cairo_scaled_font_map_mutex);
 }
+static cairo_scaled_glyph_page_shard_t *
+_cairo_scaled_glyph_page_shards_get (void)
+{
+    int n;
+
+    if (_cairo_atomic_int_get (&cairo_scaled_glyph_page_shards_initialized))
+	return cairo_scaled_glyph_page_shards;
+
+    CAIRO_MUTEX_LOCK (_cairo_scaled_glyph_page_cache_mutex);
+    if (! _cairo_atomic_int_get (&cairo_scaled_glyph_page_shards_initialized)) {
+	for (n = 0; n < CAIRO_SCALED_GLYPH_PAGE_SHARDS; n++) {
+	    cairo_scaled_glyph_page_shard_t *shard = &cairo_scaled_glyph_page_shards[n];
+
+	    CAIRO_MUTEX_INIT (shard->mutex);
+	    cairo_list_init (&shard->pages);
+	    shard->num_pages = 0;
+	    shard->size = 0;
+	    shard->evictions = 0;
+	}
+	_cairo_atomic_int_cmpxchg (&cairo_scaled_glyph_page_shards_initialized,
+				   0, 1);
+    }
+    CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_page_cache_mutex);
+
+    return cairo_scaled_glyph_page_shards;
+}
+
+/* Wait for any eviction in progress to finish. Pages are only ever evicted
+ * with their shard locked, so passing through every shard is enough. */
+static void
+_cairo_scaled_glyph_page_shards_wait (void)
+{
+    cairo_scaled_glyph_page_shard_t *shards;
+    int n;
+
+    shards = _cairo_scaled_glyph_page_shards_get ();
+    for (n = 0; n < CAIRO_SCALED_GLYPH_PAGE_SHARDS; n++) {
+	CAIRO_MUTEX_LOCK (shards[n].mutex);
+	CAIRO_MUTEX_UNLOCK (shards[n].mutex);
+    }
+}
+
+/* Pin the glyphs of @scaled_font, so that none of its pages are evicted. */
 static void
-_cairo_scaled_glyph_page_destroy (void *closure)
+_cairo_scaled_font_pin_glyphs (cairo_scaled_font_t *scaled_font)
+{
+    int count;
+
+    for (;;) {
+	count = _cairo_atomic_int_get (&scaled_font->cache_frozen);
+	if (unlikely (count == CAIRO_SCALED_FONT_EVICTING)) {
+	    _cairo_scaled_glyph_page_shards_wait ();
+	    continue;
+	}
+
+	if (_cairo_atomic_int_cmpxchg (&scaled_font->cache_frozen,
+				       count, count + 1))
+	    break;
+    }
+}
+
+/* Claim an unfrozen @scaled_font for the removal of its pages. */
+static cairo_bool_t
+_cairo_scaled_font_claim_glyphs (cairo_scaled_font_t *scaled_font)
+{
+    return _cairo_atomic_int_cmpxchg (&scaled_font->cache_frozen,
+				      0, CAIRO_SCALED_FONT_EVICTING);
+}
+
+static void
+_cairo_scaled_font_release_glyphs (cairo_scaled_font_t *scaled_font)
+{
+    _cairo_atomic_int_cmpxchg (&scaled_font->cache_frozen,
+			       CAIRO_SCALED_FONT_EVICTING, 0);
+}
+
+/* Called with the page's shard locked, and its font claimed or unused. */
+static void
+_cairo_scaled_glyph_page_destroy (cairo_scaled_glyph_page_shard_t *shard,
+				  cairo_scaled_glyph_page_t *page)
 {
-    cairo_scaled_glyph_page_t *page = closure;
     cairo_scaled_font_t *scaled_font;
     unsigned int n;
 
     assert (! cairo_list_is_empty (&page->link));
 
-    scaled_font = (cairo_scaled_font_t *) page->cache_entry.hash;
+    scaled_font = page->scaled_font;
     for (n = 0; n < page->num_glyphs; n++) {
+	cairo_scaled_glyph_t *scaled_glyph = &page->glyphs[n];
+	unsigned long index = _cairo_scaled_glyph_index (scaled_glyph);
+	void **slot;
+
+	slot = &scaled_font->glyph_lookup[_cairo_scaled_glyph_index_hash (index) %
+					  CAIRO_SCALED_GLYPH_LOOKUP_SIZE];
+	if (_cairo_scaled_glyph_lookup_entry_glyph (*slot) == scaled_glyph)
+	    *slot = NULL;
+
 	_cairo_hash_table_remove (scaled_font->glyphs,
-				  &page->glyphs[n].hash_entry);
-	_cairo_scaled_glyph_fini (scaled_font, &page->glyphs[n]);
+				  &scaled_glyph->hash_entry);
+	_cairo_scaled_glyph_fini (scaled_font, scaled_glyph);
     }
 
     cairo_list_del (&page->link);
+    cairo_list_del (&page->shard_link);
+    shard->num_pages--;
+    shard->size -= page->size;
 
     free (page);
 }
 
+static unsigned long
+_cairo_scaled_glyph_size (const cairo_scaled_glyph_t *scaled_glyph)
+{
+    unsigned long size = 0;
+
+    if (scaled_glyph->surface != NULL) {
+	size += sizeof (cairo_image_surface_t);
+	size += (unsigned long) scaled_glyph->surface->stride *
+		scaled_glyph->surface->height;
+    }
+
+    if (scaled_glyph->path != NULL) {
+	size += sizeof (cairo_path_fixed_t);
+	size += _cairo_path_fixed_size (scaled_glyph->path);
+    }
+
+    if (scaled_glyph->recording_surface != NULL) {
+	const cairo_recording_surface_t *recording;
+
+	recording = (const cairo_recording_surface_t *) scaled_glyph->recording_surface;
+	size += sizeof (cairo_recording_surface_t);
+	size += recording->commands.num_elements * sizeof (cairo_command_t);
+    }
+
+    return size;
+}
+
+static cairo_scaled_glyph_cache_stripe_t *
+_cairo_scaled_glyph_cache_stripe (void)
+{
+    uint32_t stack;
+
+    /* The stacks of different threads lie far apart. */
+    stack = (uint32_t) ((uintptr_t) &stack >> 12) * 2654435761u;
+    return &cairo_scaled_glyph_cache_stripes[stack >> 28];
+}
+
+/* Move the clock hand over the pages of @shard, and claim the font of the
+ * page to evict. Called with the shard locked. */
+static cairo_scaled_glyph_page_t *
+_cairo_scaled_glyph_page_shard_victim (cairo_scaled_glyph_page_shard_t *shard)
+{
+    cairo_scaled_glyph_page_t *victim = NULL;
+    unsigned int n, candidates = 0;
+
+    for (n = 0; n < 2 * shard->num_pages; n++) {
+	cairo_scaled_glyph_page_t *page;
+
+	page = cairo_list_first_entry (&shard->pages,
+				       cairo_scaled_glyph_page_t,
+				       shard_link);
+	cairo_list_move_tail (&page->shard_link, &shard->pages);
+
+	if (page->referenced) {
+	    page->referenced = FALSE;
+	    continue;
+	}
+
+	if (_cairo_atomic_int_get (&page->scaled_font->cache_frozen))
+	    continue;
+
+	if (victim == NULL || page->size > victim->size)
+	    victim = page;
+	if (++candidates == CAIRO_SCALED_GLYPH_PAGE_CANDIDATES)
+	    break;
+    }
+
+    if (victim != NULL && ! _cairo_scaled_font_claim_glyphs (victim->scaled_font))
+	victim = NULL;
+
+    return victim;
+}
+
+/* Evict pages of unfrozen fonts until @shard is within its share of the
+ * budget. Called with the shard locked; returns FALSE if it is still over. */
+static cairo_bool_t
+_cairo_scaled_glyph_page_shard_trim (cairo_scaled_glyph_page_shard_t *shard)
+{
+    unsigned long max_size;
+
+    max_size = cairo_scaled_glyph_cache_max_size / CAIRO_SCALED_GLYPH_PAGE_SHARDS;
+    while (shard->size > max_size) {
+	cairo_scaled_glyph_page_t *page;
+	cairo_scaled_font_t *scaled_font;
+
+	page = _cairo_scaled_glyph_page_shard_victim (shard);
+	if (page == NULL)
+	    return FALSE;
+
+	scaled_font = page->scaled_font;
+	shard->evictions += page->num_glyphs;
+	_cairo_scaled_glyph_page_destroy (shard, page);
+	_cairo_scaled_font_release_glyphs (scaled_font);
+    }
+
+    return TRUE;
+}
+
+/* Charge the change in size of @scaled_glyph to its page, and evict to
+ * make room. Called with scaled_font->glyph_mutex held. */
+static void
+_cairo_scaled_glyph_page_resize (cairo_scaled_font_t *scaled_font,
+				 cairo_scaled_glyph_page_t *page,
+				 long delta)
+{
+    cairo_scaled_glyph_page_shard_t *shard;
+
+    if (delta == 0)
+	return;
+
+    shard = &cairo_scaled_glyph_page_shards[page->shard];
+    CAIRO_MUTEX_LOCK (shard->mutex);
+    page->size += delta;
+    shard->size += delta;
+    if (delta > 0 && ! _cairo_scaled_glyph_page_shard_trim (shard))
+	scaled_font->overfull_glyph_shards |= 1 << page->shard;
+    CAIRO_MUTEX_UNLOCK (shard->mutex);
+}
+
 /* If a scaled font wants to unlock the font map while still being
  * created (needed for user-fonts), we need to take extra care not
  * ending up with multiple identical scaled fonts being created.
@@ -752,11 +1080,17 @@ _cairo_scaled_font_init (cairo_scaled_font_t               *scaled_font,
 	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
 
     cairo_list_init (&scaled_font->glyph_pages);
-    scaled_font->cache_frozen = FALSE;
-    scaled_font->global_cache_frozen = FALSE;
+    scaled_font->cache_frozen = 0;
+    scaled_font->overfull_glyph_shards = 0;
+    memset (scaled_font->glyph_lookup, 0, sizeof (scaled_font->glyph_lookup));
+
+    scaled_font->text_cache = NULL;
+    cairo_list_init (&scaled_font->text_lru);
+    scaled_font->num_texts = 0;
 
     scaled_font->holdover = FALSE;
     scaled_font->finished = FALSE;
+    scaled_font->glyph_phases = FALSE;
 
     CAIRO_REFERENCE_COUNT_INIT (&scaled_font->ref_count, 1);
 
@@ -766,6 +1100,8 @@ _cairo_scaled_font_init (cairo_scaled_font_t               *scaled_font,
     scaled_font->original_font_face = NULL;
 
     CAIRO_MUTEX_INIT (scaled_font->mutex);
+    CAIRO_MUTEX_INIT (scaled_font->glyph_mutex);
+    CAIRO_MUTEX_INIT (scaled_font->text_mutex);
 
     cairo_list_init (&scaled_font->dev_privates);
 
@@ -782,38 +1118,128 @@ _cairo_scaled_font_freeze_cache (cairo_scaled_font_t *scaled_font)
     assert (scaled_font->status == CAIRO_STATUS_SUCCESS);
 
     CAIRO_MUTEX_LOCK (scaled_font->mutex);
-    scaled_font->cache_frozen = TRUE;
+    _cairo_scaled_font_pin_glyphs (scaled_font);
 }
 
-void
-_cairo_scaled_font_thaw_cache (cairo_scaled_font_t *scaled_font)
+/* Trim the shards that @scaled_font could not make room in whilst frozen. */
+static void
+_cairo_scaled_font_thaw_global_cache (cairo_scaled_font_t *scaled_font)
 {
-    scaled_font->cache_frozen = FALSE;
+    cairo_scaled_glyph_page_shard_t *shards;
+    unsigned int overfull;
+    int n;
 
-    if (scaled_font->global_cache_frozen) {
-	CAIRO_MUTEX_LOCK (_cairo_scaled_glyph_page_cache_mutex);
-	_cairo_cache_thaw (&cairo_scaled_glyph_page_cache);
-	CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_page_cache_mutex);
+    /* Unlocked peek: a thread always sees the shards it filled itself, and
+     * trimming on somebody else's behalf merely evicts a little early. */
+    if (scaled_font->overfull_glyph_shards == 0)
+	return;
 
-	scaled_font->global_cache_frozen = FALSE;
+    CAIRO_MUTEX_LOCK (scaled_font->glyph_mutex);
+    overfull = scaled_font->overfull_glyph_shards;
+    scaled_font->overfull_glyph_shards = 0;
+    CAIRO_MUTEX_UNLOCK (scaled_font->glyph_mutex);
+
+    shards = _cairo_scaled_glyph_page_shards_get ();
+    for (n = 0; overfull; n++, overfull >>= 1) {
+	if (overfull & 1) {
+	    CAIRO_MUTEX_LOCK (shards[n].mutex);
+	    _cairo_scaled_glyph_page_shard_trim (&shards[n]);
+	    CAIRO_MUTEX_UNLOCK (shards[n].mutex);
+	}
     }
+}
+
+void
+_cairo_scaled_font_thaw_cache (cairo_scaled_font_t *scaled_font)
+{
+    _cairo_atomic_int_dec (&scaled_font->cache_frozen);
+    _cairo_scaled_font_thaw_global_cache (scaled_font);
 
     CAIRO_MUTEX_UNLOCK (scaled_font->mutex);
 }
 
+/**
+ * _cairo_scaled_font_freeze_cache_shared:
+ * @scaled_font: a #cairo_scaled_font_t
+ *
+ * Pins the glyphs of @scaled_font like _cairo_scaled_font_freeze_cache(),
+ * but without excluding other threads. Only use this where the glyphs are
+ * merely looked up and read, and the scaled font has no private data
+ * attached or modified. Private data may be attached to the glyphs, as
+ * that is always done under _cairo_scaled_glyph_private_mutex, but the
+ * caller must serialise its own use of whatever it attaches.
+ **/
+void
+_cairo_scaled_font_freeze_cache_shared (cairo_scaled_font_t *scaled_font)
+{
+    assert (scaled_font->status == CAIRO_STATUS_SUCCESS);
+
+    _cairo_scaled_font_pin_glyphs (scaled_font);
+}
+
+void
+_cairo_scaled_font_thaw_cache_shared (cairo_scaled_font_t *scaled_font)
+{
+    _cairo_atomic_int_dec (&scaled_font->cache_frozen);
+    _cairo_scaled_font_thaw_global_cache (scaled_font);
+}
+
 void
 _cairo_scaled_font_reset_cache (cairo_scaled_font_t *scaled_font)
 {
-    assert (! scaled_font->cache_frozen);
+    cairo_scaled_glyph_page_shard_t *shards;
 
-    CAIRO_MUTEX_LOCK (_cairo_scaled_glyph_page_cache_mutex);
+    assert (_cairo_atomic_int_get (&scaled_font->cache_frozen) <= 0);
+
+    if (cairo_list_is_empty (&scaled_font->glyph_pages))
+	return;
+
+    while (! _cairo_scaled_font_claim_glyphs (scaled_font))
+	_cairo_scaled_glyph_page_shards_wait ();
+
+    shards = _cairo_scaled_glyph_page_shards_get ();
     while (! cairo_list_is_empty (&scaled_font->glyph_pages)) {
-	_cairo_cache_remove (&cairo_scaled_glyph_page_cache,
-                             &cairo_list_first_entry (&scaled_font->glyph_pages,
-                                                      cairo_scaled_glyph_page_t,
-                                                      link)->cache_entry);
+	cairo_scaled_glyph_page_t *page;
+	cairo_scaled_glyph_page_shard_t *shard;
+
+	page = cairo_list_first_entry (&scaled_font->glyph_pages,
+				       cairo_scaled_glyph_page_t,
+				       link);
+	shard = &shards[page->shard];
+
+	CAIRO_MUTEX_LOCK (shard->mutex);
+	_cairo_scaled_glyph_page_destroy (shard, page);
+	CAIRO_MUTEX_UNLOCK (shard->mutex);
     }
-    CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_page_cache_mutex);
+
+    _cairo_scaled_font_release_glyphs (scaled_font);
+}
+
+/**
+ * _cairo_scaled_font_enable_glyph_phases:
+ * @scaled_font: a #cairo_scaled_font_t
+ *
+ * Called by backends, as the scaled font is created, if they render the
+ * surface of a glyph offset to the right by _cairo_scaled_glyph_xphase()
+ * quarters of a pixel. The image compositor then draws glyphs at their
+ * fractional positions, instead of rounding them to whole pixels, by
+ * looking up the variant for the nearest phase.
+ *
+ * The phases are only used where the metrics are not hinted, that is
+ * where glyphs are asked to be placed precisely; not where the glyph
+ * positions are rounded anyway, as the extents of the text then leave no
+ * room for the offset; and not for aliased text, whose glyphs would
+ * change shape from one phase to the next.
+ **/
+void
+_cairo_scaled_font_enable_glyph_phases (cairo_scaled_font_t *scaled_font)
+{
+    const cairo_font_options_t *options = &scaled_font->options;
+
+    scaled_font->glyph_phases =
+	options->hint_metrics == CAIRO_HINT_METRICS_OFF &&
+	options->antialias != CAIRO_ANTIALIAS_NONE &&
+	_cairo_font_options_get_round_glyph_positions (options) != CAIRO_ROUND_GLYPH_POS_ON;
 }
 
 cairo_status_t
@@ -852,11 +1278,14 @@ _cairo_scaled_font_fini_internal (cairo_scaled_font_t *scaled_font)
 
     _cairo_scaled_font_reset_cache (scaled_font);
     _cairo_hash_table_destroy (scaled_font->glyphs);
+    _cairo_scaled_font_reset_text_cache (scaled_font);
 
     cairo_font_face_destroy (scaled_font->font_face);
     cairo_font_face_destroy (scaled_font->original_font_face);
 
     CAIRO_MUTEX_FINI (scaled_font->mutex);
+    CAIRO_MUTEX_FINI (scaled_font->glyph_mutex);
+    CAIRO_MUTEX_FINI (scaled_font->text_mutex);
 
     while (! cairo_list_is_empty (&scaled_font->dev_privates)) {
 	cairo_scaled_font_private_t *private =
@@ -913,6 +1342,13 @@ _cairo_scaled_font_find_private (cairo_scaled_font_t *scaled_font,
     return NULL;
 }
 
+/* The private data of glyphs is attached, found and detached under
+ * _cairo_scaled_glyph_private_mutex, and never with any other lock taken
+ * inside it. The image compositor reads the glyphs of a font frozen only
+ * with _cairo_scaled_font_freeze_cache_shared(), whilst the other
+ * backends hold the font's mutex, and an atlas may evict the glyphs of
+ * any font, so no lock belonging to one font or one backend suffices.
+ */
 void
 _cairo_scaled_glyph_attach_private (cairo_scaled_glyph_t *scaled_glyph,
 				   cairo_scaled_glyph_private_t *private,
@@ -923,26 +1359,41 @@ _cairo_scaled_glyph_attach_private (cairo_scaled_glyph_t *scaled_glyph,
 {
     private->key = key;
     private->destroy = destroy;
+
+    CAIRO_MUTEX_LOCK (_cairo_scaled_glyph_private_mutex);
     cairo_list_add (&private->link, &scaled_glyph->dev_privates);
+    CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_private_mutex);
+}
+
+void
+_cairo_scaled_glyph_detach_private (cairo_scaled_glyph_t *scaled_glyph,
+				    cairo_scaled_glyph_private_t *private)
+{
+    CAIRO_MUTEX_LOCK (_cairo_scaled_glyph_private_mutex);
+    cairo_list_del (&private->link);
+    CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_private_mutex);
 }
 
 cairo_scaled_glyph_private_t *
 _cairo_scaled_glyph_find_private (cairo_scaled_glyph_t *scaled_glyph,
 				 const void *key)
 {
-    cairo_scaled_glyph_private_t *priv;
+    cairo_scaled_glyph_private_t *priv, *found = NULL;
 
+    CAIRO_MUTEX_LOCK (_cairo_scaled_glyph_private_mutex);
     cairo_list_foreach_entry (priv, cairo_scaled_glyph_private_t,
 			      &scaled_glyph->dev_privates, link)
     {
 	if (priv->key == key) {
 	    if (priv->link.prev != &scaled_glyph->dev_privates)
 		cairo_list_move (&priv->link, &scaled_glyph->dev_privates);
-	    return priv;
+	    found = priv;
+	    break;
 	}
     }
+    CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_private_mutex);
 
-    return NULL;
+    return found;
 }
 
 /**
@@ -1222,12 +1673,160 @@ _cairo_scaled_font_reset_static_data (void)
     }
     CAIRO_MUTEX_UNLOCK (_cairo_scaled_font_error_mutex);
 
-    CAIRO_MUTEX_LOCK (_cairo_scaled_glyph_page_cache_mutex);
-    if (cairo_scaled_glyph_page_cache.hash_table != NULL) {
-	_cairo_cache_fini (&cairo_scaled_glyph_page_cache);
-	cairo_scaled_glyph_page_cache.hash_table = NULL;
+    if (_cairo_atomic_int_get (&cairo_scaled_glyph_page_shards_initialized)) {
+	int n;
+
+	for (n = 0; n < CAIRO_SCALED_GLYPH_PAGE_SHARDS; n++) {
+	    cairo_scaled_glyph_page_shard_t *shard = &cairo_scaled_glyph_page_shards[n];
+
+	    CAIRO_MUTEX_LOCK (shard->mutex);
+	    while (! cairo_list_is_empty (&shard->pages)) {
+		_cairo_scaled_glyph_page_destroy (shard,
+						  cairo_list_first_entry (&shard->pages,
+									  cairo_scaled_glyph_page_t,
+									  shard_link));
+	    }
+	    CAIRO_MUTEX_UNLOCK (shard->mutex);
+	}
     }
-    CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_page_cache_mutex);
+}
+
+/**
+ * cairo_glyph_cache_set_max_size:
+ * @max_size: the number of bytes that cached glyphs may hold
+ *
+ * Sets the budget for the glyph cache shared by all scaled fonts. The
+ * glyphs, and the images, paths and recordings made of them, are counted
+ * against it. Glyphs that have not been used lately are dropped to keep
+ * within it, the larger ones first. Glyphs of fonts that are being drawn
+ * with are kept regardless, so the budget may be overrun for a while.
+ *
+ * Since: 1.14
+ **/
+void
+cairo_glyph_cache_set_max_size (unsigned long max_size)
+{
+    cairo_scaled_glyph_page_shard_t *shards;
+    int n;
+
+    shards = _cairo_scaled_glyph_page_shards_get ();
+
+    cairo_scaled_glyph_cache_max_size = max_size;
+    for (n = 0; n < CAIRO_SCALED_GLYPH_PAGE_SHARDS; n++) {
+	CAIRO_MUTEX_LOCK (shards[n].mutex);
+	_cairo_scaled_glyph_page_shard_trim (&shards[n]);
+	CAIRO_MUTEX_UNLOCK (shards[n].mutex);
+    }
+}
+
+/**
+ * cairo_glyph_cache_get_max_size:
+ *
+ * Returns the budget for the glyph cache, see
+ * cairo_glyph_cache_set_max_size().
+ *
+ * Return value: the number of bytes that cached glyphs may hold
+ *
+ * Since: 1.14
+ **/
+unsigned long
+cairo_glyph_cache_get_max_size (void)
+{
+    return cairo_scaled_glyph_cache_max_size;
+}
+
+/**
+ * cairo_glyph_cache_set_max_glyph_size:
+ * @max_glyph_size: the largest font size, in device pixels, whose glyphs
+ *   are cached as images
+ *
+ * Sets the size above which glyphs are no longer rendered to images and
+ * kept in the glyph cache, but filled from their outlines whenever they
+ * are drawn, as paths are. A few strings of display text would otherwise
+ * fill the cache and evict the glyphs of the body text. Fonts that cannot
+ * provide outlines are always cached as images.
+ *
+ * The size is compared with the larger scale of the font in device space,
+ * so a 12 point font shown at 2400% zoom counts as 288 pixels. The
+ * default is 256 pixels. The edges of glyphs filled from their outlines
+ * are antialiased by cairo rather than the font backend, and may differ
+ * from the images by a few levels; pass %HUGE_VAL to cache every glyph
+ * as an image.
+ *
+ * Since: 1.14
+ **/
+void
+cairo_glyph_cache_set_max_glyph_size (double max_glyph_size)
+{
+    cairo_scaled_glyph_cache_max_glyph_size = max_glyph_size;
+}
+
+/**
+ * cairo_glyph_cache_get_max_glyph_size:
+ *
+ * Returns the size above which glyphs are filled as paths rather than
+ * cached as images, see cairo_glyph_cache_set_max_glyph_size().
+ *
+ * Return value: the largest font size, in device pixels, whose glyphs
+ *   are cached as images
+ *
+ * Since: 1.14
+ **/
+double
+cairo_glyph_cache_get_max_glyph_size (void)
+{
+    return cairo_scaled_glyph_cache_max_glyph_size;
+}
+
+/**
+ * _cairo_scaled_font_has_large_glyphs:
+ * @scaled_font: a #cairo_scaled_font_t
+ *
+ * Returns whether the glyphs of @scaled_font are too large to be cached
+ * as images, and should be filled with _cairo_scaled_font_glyph_outlines()
+ * instead.
+ **/
+cairo_bool_t
+_cairo_scaled_font_has_large_glyphs (cairo_scaled_font_t *scaled_font)
+{
+    return scaled_font->max_scale > cairo_scaled_glyph_cache_max_glyph_size;
+}
+
+/**
+ * cairo_glyph_cache_get_stats:
+ * @stats: return value for the glyph cache statistics
+ *
+ * Reports how well the glyph cache is doing, see
+ * #cairo_glyph_cache_stats_t.
+ *
+ * Since: 1.14
+ **/
+void
+cairo_glyph_cache_get_stats (cairo_glyph_cache_stats_t *stats)
+{
+    cairo_scaled_glyph_page_shard_t *shards;
+    int n;
+
+    stats->hits = stats->misses = stats->evictions = 0;
+    stats->text_hits = stats->text_misses = stats->text_evictions = 0;
+    for (n = 0; n < CAIRO_SCALED_GLYPH_CACHE_STRIPES; n++) {
+	stats->hits += _cairo_atomic_int_get (&cairo_scaled_glyph_cache_stripes[n].hits);
+	stats->misses += _cairo_atomic_int_get (&cairo_scaled_glyph_cache_stripes[n].misses);
+	stats->text_hits += _cairo_atomic_int_get (&cairo_scaled_glyph_cache_stripes[n].text_hits);
+	stats->text_misses += _cairo_atomic_int_get (&cairo_scaled_glyph_cache_stripes[n].text_misses);
+	stats->text_evictions += _cairo_atomic_int_get (&cairo_scaled_glyph_cache_stripes[n].text_evictions);
+    }
+
+    stats->size = 0;
+    shards = _cairo_scaled_glyph_page_shards_get ();
+    for (n = 0; n < CAIRO_SCALED_GLYPH_PAGE_SHARDS; n++) {
+	CAIRO_MUTEX_LOCK (shards[n].mutex);
+	stats->evictions += shards[n].evictions;
+	stats->size += shards[n].size;
+	CAIRO_MUTEX_UNLOCK (shards[n].mutex);
+    }
+
+    stats->max_size = cairo_scaled_glyph_cache_max_size;
 }
 
 /**
@@ -1565,7 +2164,7 @@ cairo_scaled_font_glyph_extents (cairo_scaled_font_t   *scaled_font,
 	goto ZERO_EXTENTS;
     }
 
-    _cairo_scaled_font_freeze_cache (scaled_font);
+    _cairo_scaled_font_freeze_cache_shared (scaled_font);
 
     for (i = 0; i < num_glyphs; i++) {
 	double			left, top, right, bottom;
@@ -1632,7 +2231,7 @@ cairo_scaled_font_glyph_extents (cairo_scaled_font_t   *scaled_font,
     }
 
  UNLOCK:
-    _cairo_scaled_font_thaw_cache (scaled_font);
+    _cairo_scaled_font_thaw_cache_shared (scaled_font);
     return;
 
 ZERO_EXTENTS:
@@ -1645,6 +2244,271 @@ ZERO_EXTENTS:
 }
 slim_hidden_def (cairo_scaled_font_glyph_extents);
 
+/* Strings converted to glyphs are remembered per scaled font, for fonts
+ * that leave the conversion to us, so that text drawn over and over, such
+ * as labels redrawn every frame, is not decoded, mapped to glyph indices
+ * and measured each time. Only the glyph indices and advances are kept,
+ * and the glyphs are placed from them exactly as a fresh conversion would
+ * place them, from whatever origin is given. The least recently used
+ * strings are dropped to make room for new ones.
+ */
+#define CAIRO_SCALED_FONT_TEXT_CACHE_SIZE 64
+#define CAIRO_SCALED_FONT_TEXT_MAX_LENGTH 256
+
+typedef struct _cairo_scaled_font_text_glyph {
+    unsigned long index;
+    double x_advance;
+    double y_advance;
+    int num_bytes;
+} cairo_scaled_font_text_glyph_t;
+
+typedef struct _cairo_scaled_font_text {
+    cairo_hash_entry_t hash_entry;
+    cairo_list_t link;
+
+    const char *utf8;
+    int utf8_len;
+    int num_glyphs;
+    cairo_scaled_font_text_glyph_t glyphs[1];
+} cairo_scaled_font_text_t;
+
+static cairo_bool_t
+_cairo_scaled_font_text_keys_equal (const void *abstract_key_a,
+				    const void *abstract_key_b)
+{
+    const cairo_scaled_font_text_t *key_a = abstract_key_a;
+    const cairo_scaled_font_text_t *key_b = abstract_key_b;
+
+    return key_a->utf8_len == key_b->utf8_len &&
+	   memcmp (key_a->utf8, key_b->utf8, key_a->utf8_len) == 0;
+}
+
+static void
+_cairo_scaled_font_text_init_key (cairo_scaled_font_text_t *key,
+				  const char		   *utf8,
+				  int			    utf8_len)
+{
+    key->hash_entry.hash = _cairo_hash_bytes (utf8_len, utf8, utf8_len);
+    key->utf8 = utf8;
+    key->utf8_len = utf8_len;
+}
+
+static void
+_cairo_scaled_font_text_emit (const cairo_scaled_font_text_t *text,
+			      double			      x,
+			      double			      y,
+			      cairo_glyph_t		     *glyphs,
+			      cairo_text_cluster_t	    **clusters)
+{
+    int i;
+
+    for (i = 0; i < text->num_glyphs; i++) {
+	glyphs[i].index = text->glyphs[i].index;
+	glyphs[i].x = x;
+	glyphs[i].y = y;
+
+	x += text->glyphs[i].x_advance;
+	y += text->glyphs[i].y_advance;
+
+	if (clusters) {
+	    (*clusters)[i].num_bytes  = text->glyphs[i].num_bytes;
+	    (*clusters)[i].num_glyphs = 1;
+	}
+    }
+}
+
+/* Looks @utf8 up amongst the strings converted before, and if found fills
+ * in the glyphs and clusters as cairo_scaled_font_text_to_glyphs() would.
+ * Returns %CAIRO_INT_STATUS_UNSUPPORTED if the string has to be converted. */
+static cairo_int_status_t
+_cairo_scaled_font_text_lookup (cairo_scaled_font_t	 *scaled_font,
+				double			  x,
+				double			  y,
+				const char		 *utf8,
+				int			  utf8_len,
+				cairo_glyph_t		**glyphs,
+				int			 *num_glyphs,
+				cairo_text_cluster_t	**clusters,
+				int			 *num_clusters)
+{
+    cairo_scaled_font_text_t key, *text;
+    cairo_int_status_t status;
+
+    if (utf8_len > CAIRO_SCALED_FONT_TEXT_MAX_LENGTH)
+	return CAIRO_INT_STATUS_UNSUPPORTED;
+
+    _cairo_scaled_font_text_init_key (&key, utf8, utf8_len);
+
+    CAIRO_MUTEX_LOCK (scaled_font->text_mutex);
+
+    text = NULL;
+    if (scaled_font->text_cache != NULL)
+	text = _cairo_hash_table_lookup (scaled_font->text_cache,
+					 &key.hash_entry);
+    if (text == NULL) {
+	status = CAIRO_INT_STATUS_UNSUPPORTED;
+	goto UNLOCK;
+    }
+
+    cairo_list_move (&text->link, &scaled_font->text_lru);
+
+    if (*num_glyphs < text->num_glyphs) {
+	*glyphs = cairo_glyph_allocate (text->num_glyphs);
+	if (unlikely (*glyphs == NULL)) {
+	    status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
+	    goto UNLOCK;
+	}
+    }
+    *num_glyphs = text->num_glyphs;
+
+    if (clusters) {
+	if (*num_clusters < text->num_glyphs) {
+	    *clusters = cairo_text_cluster_allocate (text->num_glyphs);
+	    if (unlikely (*clusters == NULL)) {
+		status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
+		goto UNLOCK;
+	    }
+	}
+	*num_clusters = text->num_glyphs;
+    }
+
+    _cairo_scaled_font_text_emit (text, x, y, *glyphs, clusters);
+    _cairo_atomic_int_inc (&_cairo_scaled_glyph_cache_stripe ()->text_hits);
+    status = CAIRO_INT_STATUS_SUCCESS;
+
+  UNLOCK:
+    CAIRO_MUTEX_UNLOCK (scaled_font->text_mutex);
+
+    return status;
+}
+
+/* Converts @utf8, which has been validated, for the text cache. Called
+ * with the scaled font frozen. */
+static cairo_status_t
+_cairo_scaled_font_text_create (cairo_scaled_font_t	  *scaled_font,
+				const char		  *utf8,
+				int			   utf8_len,
+				int			   num_chars,
+				cairo_scaled_font_text_t **text_out)
+{
+    cairo_scaled_font_text_t *text;
+    const char *p;
+    char *utf8_copy;
+    int i;
+
+    text = _cairo_malloc_ab_plus_c (num_chars,
+				    sizeof (cairo_scaled_font_text_glyph_t),
+				    sizeof (cairo_scaled_font_text_t) + utf8_len);
+    if (unlikely (text == NULL))
+	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+
+    utf8_copy = (char *) (text->glyphs + num_chars);
+    memcpy (utf8_copy, utf8, utf8_len);
+    _cairo_scaled_font_text_init_key (text, utf8_copy, utf8_len);
+    text->num_glyphs = num_chars;
+
+    p = utf8;
+    for (i = 0; i < num_chars; i++) {
+	cairo_scaled_glyph_t *scaled_glyph;
+	cairo_status_t status;
+	uint32_t unicode;
+	unsigned long g;
+
+	text->glyphs[i].num_bytes = _cairo_utf8_get_char_validated (p, &unicode);
+	p += text->glyphs[i].num_bytes;
+
+	g = scaled_font->backend->ucs4_to_index (scaled_font, unicode);
+	status = _cairo_scaled_glyph_lookup (scaled_font,
+					     g,
+					     CAIRO_SCALED_GLYPH_INFO_METRICS,
+					     &scaled_glyph);
+	if (unlikely (status)) {
+	    free (text);
+	    return status;
+	}
+
+	text->glyphs[i].index = g;
+	text->glyphs[i].x_advance = scaled_glyph->metrics.x_advance;
+	text->glyphs[i].y_advance = scaled_glyph->metrics.y_advance;
+    }
+
+    _cairo_atomic_int_inc (&_cairo_scaled_glyph_cache_stripe ()->text_misses);
+
+    *text_out = text;
+    return CAIRO_STATUS_SUCCESS;
+}
+
+/* Hands @text over to the text cache of @scaled_font. */
+static void
+_cairo_scaled_font_text_insert (cairo_scaled_font_t	 *scaled_font,
+				cairo_scaled_font_text_t *text)
+{
+    cairo_status_t status;
+
+    CAIRO_MUTEX_LOCK (scaled_font->text_mutex);
+
+    if (scaled_font->text_cache == NULL) {
+	scaled_font->text_cache =
+	    _cairo_hash_table_create (_cairo_scaled_font_text_keys_equal);
+	if (unlikely (scaled_font->text_cache == NULL))
+	    goto FREE;
+    }
+
+    /* another thread may have converted the same string meanwhile */
+    if (_cairo_hash_table_lookup (scaled_font->text_cache, &text->hash_entry))
+	goto FREE;
+
+    if (scaled_font->num_texts == CAIRO_SCALED_FONT_TEXT_CACHE_SIZE) {
+	cairo_scaled_font_text_t *lru;
+
+	lru = cairo_list_last_entry (&scaled_font->text_lru,
+				     cairo_scaled_font_text_t,
+				     link);
+	cairo_list_del (&lru->link);
+	_cairo_hash_table_remove (scaled_font->text_cache, &lru->hash_entry);
+	scaled_font->num_texts--;
+	free (lru);
+
+	_cairo_atomic_int_inc (&_cairo_scaled_glyph_cache_stripe ()->text_evictions);
+    }
+
+    status = _cairo_hash_table_insert (scaled_font->text_cache,
+				       &text->hash_entry);
+    if (unlikely (status))
+	goto FREE;
+
+    cairo_list_add (&text->link, &scaled_font->text_lru);
+    scaled_font->num_texts++;
+
+    CAIRO_MUTEX_UNLOCK (scaled_font->text_mutex);
+    return;
+
+  FREE:
+    CAIRO_MUTEX_UNLOCK (scaled_font->text_mutex);
+    free (text);
+}
+
+static void
+_cairo_scaled_font_reset_text_cache (cairo_scaled_font_t *scaled_font)
+{
+    while (! cairo_list_is_empty (&scaled_font->text_lru)) {
+	cairo_scaled_font_text_t *text;
+
+	text = cairo_list_first_entry (&scaled_font->text_lru,
+				       cairo_scaled_font_text_t,
+				       link);
+	cairo_list_del (&text->link);
+	_cairo_hash_table_remove (scaled_font->text_cache, &text->hash_entry);
+	free (text);
+    }
+    scaled_font->num_texts = 0;
+
+    if (scaled_font->text_cache != NULL) {
+	_cairo_hash_table_destroy (scaled_font->text_cache);
+	scaled_font->text_cache = NULL;
+    }
+}
+
 #define GLYPH_LUT_SIZE 64
 static cairo_status_t
 cairo_scaled_font_text_to_glyphs_internal_cached (cairo_scaled_font_t		 *scaled_font,
@@ -1988,6 +2852,19 @@ cairo_scaled_font_text_to_glyphs (cairo_scaled_font_t   *scaled_font,
 	goto BAIL;
     }
 
+    orig_glyphs = *glyphs;
+    orig_clusters = clusters ? *clusters : NULL;
+
+    /* a string converted before was validated then */
+    if (scaled_font->backend->text_to_glyphs == NULL) {
+	status = _cairo_scaled_font_text_lookup (scaled_font, x, y,
+						 utf8, utf8_len,
+						 glyphs, num_glyphs,
+						 clusters, num_clusters);
+	if (status != CAIRO_INT_STATUS_UNSUPPORTED)
+	    goto CACHED;
+    }
+
     /* validate input so backend does not have to */
     status = _cairo_utf8_to_ucs4 (utf8, utf8_len, NULL, &num_chars);
     if (unlikely (status))
@@ -1995,9 +2872,6 @@ cairo_scaled_font_text_to_glyphs (cairo_scaled_font_t   *scaled_font,
 
     _cairo_scaled_font_freeze_cache (scaled_font);
 
-    orig_glyphs = *glyphs;
-    orig_clusters = clusters ? *clusters : NULL;
-
     if (scaled_font->backend->text_to_glyphs) {
 	status = scaled_font->backend->text_to_glyphs (scaled_font, x, y,
 						       utf8, utf8_len,
@@ -2062,7 +2936,19 @@ cairo_scaled_font_text_to_glyphs (cairo_scaled_font_t   *scaled_font,
 	*num_clusters = num_chars;
     }
 
-    if (num_chars > CACHING_THRESHOLD)
+    if (scaled_font->backend->text_to_glyphs == NULL &&
+	num_chars > 1 && utf8_len <= CAIRO_SCALED_FONT_TEXT_MAX_LENGTH)
+    {
+	cairo_scaled_font_text_t *text;
+
+	status = _cairo_scaled_font_text_create (scaled_font,
+						 utf8, utf8_len, num_chars,
+						 &text);
+	if (likely (status == CAIRO_INT_STATUS_SUCCESS)) {
+	    _cairo_scaled_font_text_emit (text, x, y, *glyphs, clusters);
+	    _cairo_scaled_font_text_insert (scaled_font, text);
+	}
+    } else if (num_chars > CACHING_THRESHOLD)
 	status = cairo_scaled_font_text_to_glyphs_internal_cached (scaled_font,
 								     x, y,
 								     utf8,
@@ -2080,6 +2966,7 @@ cairo_scaled_font_text_to_glyphs (cairo_scaled_font_t   *scaled_font,
  DONE: /* error that should be logged on scaled_font happened */
     _cairo_scaled_font_thaw_cache (scaled_font);
 
+ CACHED:
     if (unlikely (status)) {
 	*num_glyphs = 0;
 	if (*glyphs != orig_glyphs) {
@@ -2160,12 +3047,15 @@ _cairo_scaled_font_single_glyph_device_extents (cairo_scaled_font_t	 *scaled_fon
     cairo_box_t box;
     cairo_fixed_t v;
 
+    _cairo_scaled_font_freeze_cache_shared (scaled_font);
     status = _cairo_scaled_glyph_lookup (scaled_font,
 					 glyph->index,
 					 CAIRO_SCALED_GLYPH_INFO_METRICS,
 					 &scaled_glyph);
-    if (unlikely (status))
+    if (unlikely (status)) {
+	_cairo_scaled_font_thaw_cache_shared (scaled_font);
 	return status;
+    }
 
     round_xy = _cairo_font_options_get_round_glyph_positions (&scaled_font->options);
     if (round_xy == CAIRO_ROUND_GLYPH_POS_ON)
@@ -2181,6 +3071,7 @@ _cairo_scaled_font_single_glyph_device_extents (cairo_scaled_font_t	 *scaled_fon
 	v = _cairo_fixed_from_double (glyph->y);
     box.p1.y = v + scaled_glyph->bbox.p1.y;
     box.p2.y = v + scaled_glyph->bbox.p2.y;
+    _cairo_scaled_font_thaw_cache_shared (scaled_font);
 
     _cairo_box_round_to_rectangle (&box, extents);
     return CAIRO_STATUS_SUCCESS;
@@ -2216,7 +3107,7 @@ _cairo_scaled_font_glyph_device_extents (cairo_scaled_font_t	 *scaled_font,
 							       extents);
     }
 
-    _cairo_scaled_font_freeze_cache (scaled_font);
+    _cairo_scaled_font_freeze_cache_shared (scaled_font);
 
     memset (glyph_cache, 0, sizeof (glyph_cache));
 
@@ -2271,7 +3162,7 @@ _cairo_scaled_font_glyph_device_extents (cairo_scaled_font_t	 *scaled_font,
 	prev_scaled_glyph = scaled_glyph;
     }
 
-    _cairo_scaled_font_thaw_cache (scaled_font);
+    _cairo_scaled_font_thaw_cache_shared (scaled_font);
     if (unlikely (status))
 	return _cairo_scaled_font_set_error (scaled_font, status);
 
@@ -2622,11 +3513,12 @@ BAIL:
     return status;
 }
 
-cairo_status_t
-_cairo_scaled_font_glyph_path (cairo_scaled_font_t *scaled_font,
-			       const cairo_glyph_t *glyphs,
-			       int		    num_glyphs,
-			       cairo_path_fixed_t  *path)
+static cairo_int_status_t
+_cairo_scaled_font_glyph_path_internal (cairo_scaled_font_t *scaled_font,
+					const cairo_glyph_t *glyphs,
+					int		     num_glyphs,
+					cairo_bool_t	     trace_masks,
+					cairo_path_fixed_t  *path)
 {
     cairo_int_status_t status;
     int	i;
@@ -2649,7 +3541,7 @@ _cairo_scaled_font_glyph_path (cairo_scaled_font_t *scaled_font,
 					       _cairo_fixed_from_double (glyphs[i].x),
 					       _cairo_fixed_from_double (glyphs[i].y));
 
-	} else if (status == CAIRO_INT_STATUS_UNSUPPORTED) {
+	} else if (status == CAIRO_INT_STATUS_UNSUPPORTED && trace_masks) {
 	    /* If the font is incapable of providing a path, then we'll
 	     * have to trace our own from a surface.
 	     */
@@ -2670,9 +3562,45 @@ _cairo_scaled_font_glyph_path (cairo_scaled_font_t *scaled_font,
   BAIL:
     _cairo_scaled_font_thaw_cache (scaled_font);
 
+    if (status == CAIRO_INT_STATUS_UNSUPPORTED)
+	return status;
+
     return _cairo_scaled_font_set_error (scaled_font, status);
 }
 
+cairo_status_t
+_cairo_scaled_font_glyph_path (cairo_scaled_font_t *scaled_font,
+			       const cairo_glyph_t *glyphs,
+			       int		    num_glyphs,
+			       cairo_path_fixed_t  *path)
+{
+    return _cairo_scaled_font_glyph_path_internal (scaled_font,
+						   glyphs, num_glyphs,
+						   TRUE, path);
+}
+
+/**
+ * _cairo_scaled_font_glyph_outlines:
+ * @scaled_font: a #cairo_scaled_font_t
+ * @glyphs: the glyphs
+ * @num_glyphs: the number of glyphs
+ * @path: the path to append the outlines of the glyphs to
+ *
+ * Like _cairo_scaled_font_glyph_path(), but rather than trace the images
+ * of glyphs that have no outline, which would render them anyway, gives
+ * up with %CAIRO_INT_STATUS_UNSUPPORTED.
+ **/
+cairo_int_status_t
+_cairo_scaled_font_glyph_outlines (cairo_scaled_font_t *scaled_font,
+				   const cairo_glyph_t *glyphs,
+				   int			num_glyphs,
+				   cairo_path_fixed_t  *path)
+{
+    return _cairo_scaled_font_glyph_path_internal (scaled_font,
+						   glyphs, num_glyphs,
+						   FALSE, path);
+}
+
 /**
  * _cairo_scaled_glyph_set_metrics:
  * @scaled_glyph: a #cairo_scaled_glyph_t
@@ -2813,22 +3741,13 @@ _cairo_scaled_glyph_set_recording_surface (cairo_scaled_glyph_t *scaled_glyph,
 	scaled_glyph->has_info &= ~CAIRO_SCALED_GLYPH_INFO_RECORDING_SURFACE;
 }
 
-static cairo_bool_t
-_cairo_scaled_glyph_page_can_remove (const void *closure)
-{
-    const cairo_scaled_glyph_page_t *page = closure;
-    const cairo_scaled_font_t *scaled_font;
-
-    scaled_font = (cairo_scaled_font_t *) page->cache_entry.hash;
-    return scaled_font->cache_frozen == 0;
-}
-
+/* Called with scaled_font->glyph_mutex held. */
 static cairo_status_t
 _cairo_scaled_font_allocate_glyph (cairo_scaled_font_t *scaled_font,
 				   cairo_scaled_glyph_t **scaled_glyph)
 {
+    cairo_scaled_glyph_page_shard_t *shard;
     cairo_scaled_glyph_page_t *page;
-    cairo_status_t status;
 
     /* only the first page in the list may contain available slots */
     if (! cairo_list_is_empty (&scaled_font->glyph_pages)) {
@@ -2836,7 +3755,9 @@ _cairo_scaled_font_allocate_glyph (cairo_scaled_font_t *scaled_font,
                                       cairo_scaled_glyph_page_t,
                                       link);
         if (page->num_glyphs < CAIRO_SCALED_GLYPH_PAGE_SIZE) {
-            *scaled_glyph = &page->glyphs[page->num_glyphs++];
+	    *scaled_glyph = &page->glyphs[page->num_glyphs++];
+	    memset (*scaled_glyph, 0, sizeof (cairo_scaled_glyph_t));
+	    (*scaled_glyph)->page = page;
             return CAIRO_STATUS_SUCCESS;
         }
     }
@@ -2845,43 +3766,33 @@ _cairo_scaled_font_allocate_glyph (cairo_scaled_font_t *scaled_font,
     if (unlikely (page == NULL))
 	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
 
-    page->cache_entry.hash = (unsigned long) scaled_font;
-    page->cache_entry.size = 1; /* XXX occupancy weighting? */
+    page->scaled_font = scaled_font;
+    page->size = sizeof (cairo_scaled_glyph_page_t);
+    page->referenced = FALSE;
     page->num_glyphs = 0;
 
-    CAIRO_MUTEX_LOCK (_cairo_scaled_glyph_page_cache_mutex);
-    if (scaled_font->global_cache_frozen == FALSE) {
-	if (unlikely (cairo_scaled_glyph_page_cache.hash_table == NULL)) {
-	    status = _cairo_cache_init (&cairo_scaled_glyph_page_cache,
-					NULL,
-					_cairo_scaled_glyph_page_can_remove,
-					_cairo_scaled_glyph_page_destroy,
-					MAX_GLYPH_PAGES_CACHED);
-	    if (unlikely (status)) {
-		CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_page_cache_mutex);
-		free (page);
-		return status;
-	    }
-	}
+    /* spread the pages of each font across the shards */
+    page->shard = ((uintptr_t) page / sizeof (cairo_scaled_glyph_page_t)) %
+		  CAIRO_SCALED_GLYPH_PAGE_SHARDS;
+    shard = &_cairo_scaled_glyph_page_shards_get ()[page->shard];
 
-	_cairo_cache_freeze (&cairo_scaled_glyph_page_cache);
-	scaled_font->global_cache_frozen = TRUE;
-    }
-
-    status = _cairo_cache_insert (&cairo_scaled_glyph_page_cache,
-				  &page->cache_entry);
-    CAIRO_MUTEX_UNLOCK (_cairo_scaled_glyph_page_cache_mutex);
-    if (unlikely (status)) {
-	free (page);
-	return status;
-    }
+    CAIRO_MUTEX_LOCK (shard->mutex);
+    cairo_list_add_tail (&page->shard_link, &shard->pages);
+    shard->num_pages++;
+    shard->size += page->size;
+    if (! _cairo_scaled_glyph_page_shard_trim (shard))
+	scaled_font->overfull_glyph_shards |= 1 << page->shard;
+    CAIRO_MUTEX_UNLOCK (shard->mutex);
 
     cairo_list_add_tail (&page->link, &scaled_font->glyph_pages);
 
     *scaled_glyph = &page->glyphs[page->num_glyphs++];
+    memset (*scaled_glyph, 0, sizeof (cairo_scaled_glyph_t));
+    (*scaled_glyph)->page = page;
     return CAIRO_STATUS_SUCCESS;
 }
 
+/* Called with scaled_font->glyph_mutex held. */
 static void
 _cairo_scaled_font_free_last_glyph (cairo_scaled_font_t *scaled_font,
 			           cairo_scaled_glyph_t *scaled_glyph)
@@ -2897,57 +3808,29 @@ _cairo_scaled_font_free_last_glyph (cairo_scaled_font_t *scaled_font,
     _cairo_scaled_glyph_fini (scaled_font, scaled_glyph);
 
     if (--page->num_glyphs == 0) {
-	_cairo_cache_remove (&cairo_scaled_glyph_page_cache,
-		             &page->cache_entry);
+	cairo_scaled_glyph_page_shard_t *shard;
+
+	shard = &cairo_scaled_glyph_page_shards[page->shard];
+	CAIRO_MUTEX_LOCK (shard->mutex);
+	_cairo_scaled_glyph_page_destroy (shard, page);
+	CAIRO_MUTEX_UNLOCK (shard->mutex);
     }
 }
 
-/**
- * _cairo_scaled_glyph_lookup:
- * @scaled_font: a #cairo_scaled_font_t
- * @index: the glyph to create
- * @info: a #cairo_scaled_glyph_info_t marking which portions of
- * the glyph should be filled in.
- * @scaled_glyph_ret: a #cairo_scaled_glyph_t where the glyph
- * is returned.
- *
- * If the desired info is not available, (for example, when trying to
- * get INFO_PATH with a bitmapped font), this function will return
- * %CAIRO_INT_STATUS_UNSUPPORTED.
- *
- * Note: This function must be called with the scaled font frozen, and it must
- * remain frozen for as long as the @scaled_glyph_ret is alive. (If the scaled
- * font was not frozen, then there is no guarantee that the glyph would not be
- * evicted before you tried to access it.) See
- * _cairo_scaled_font_freeze_cache() and _cairo_scaled_font_thaw_cache().
- *
- * Returns: a glyph with the requested portions filled in. Glyph
- * lookup is cached and glyph will be automatically freed along
- * with the scaled_font so no explicit free is required.
- * @info can be one or more of:
- *  %CAIRO_SCALED_GLYPH_INFO_METRICS - glyph metrics and bounding box
- *  %CAIRO_SCALED_GLYPH_INFO_SURFACE - surface holding glyph image
- *  %CAIRO_SCALED_GLYPH_INFO_PATH - path holding glyph outline in device space
- **/
-cairo_int_status_t
-_cairo_scaled_glyph_lookup (cairo_scaled_font_t *scaled_font,
-			    unsigned long index,
-			    cairo_scaled_glyph_info_t info,
-			    cairo_scaled_glyph_t **scaled_glyph_ret)
+static cairo_int_status_t
+_cairo_scaled_glyph_lookup_locked (cairo_scaled_font_t *scaled_font,
+				   unsigned long index,
+				   cairo_scaled_glyph_info_t info,
+				   cairo_scaled_glyph_t **scaled_glyph_ret)
 {
     cairo_int_status_t		 status = CAIRO_INT_STATUS_SUCCESS;
     cairo_scaled_glyph_t	*scaled_glyph;
+    void			**slot;
     cairo_scaled_glyph_info_t	 need_info;
+    cairo_bool_t		 miss = FALSE;
 
-    *scaled_glyph_ret = NULL;
-
-    if (unlikely (scaled_font->status))
-	return scaled_font->status;
-
-    assert (CAIRO_MUTEX_IS_LOCKED(scaled_font->mutex));
-
-    if (CAIRO_INJECT_FAULT ())
-	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+    slot = &scaled_font->glyph_lookup[_cairo_scaled_glyph_index_hash (index) %
+				      CAIRO_SCALED_GLYPH_LOOKUP_SIZE];
 
     /*
      * Check cache for glyph
@@ -2955,11 +3838,11 @@ _cairo_scaled_glyph_lookup (cairo_scaled_font_t *scaled_font,
     scaled_glyph = _cairo_hash_table_lookup (scaled_font->glyphs,
 					     (cairo_hash_entry_t *) &index);
     if (scaled_glyph == NULL) {
+	miss = TRUE;
 	status = _cairo_scaled_font_allocate_glyph (scaled_font, &scaled_glyph);
 	if (unlikely (status))
 	    goto err;
 
-	memset (scaled_glyph, 0, sizeof (cairo_scaled_glyph_t));
 	_cairo_scaled_glyph_set_index (scaled_glyph, index);
 	cairo_list_init (&scaled_glyph->dev_privates);
 
@@ -2979,6 +3862,9 @@ _cairo_scaled_glyph_lookup (cairo_scaled_font_t *scaled_font,
 	    _cairo_scaled_font_free_last_glyph (scaled_font, scaled_glyph);
 	    goto err;
 	}
+
+	_cairo_scaled_glyph_page_resize (scaled_font, scaled_glyph->page,
+					 _cairo_scaled_glyph_size (scaled_glyph));
     }
 
     /*
@@ -2987,9 +3873,14 @@ _cairo_scaled_glyph_lookup (cairo_scaled_font_t *scaled_font,
      */
     need_info = info & ~scaled_glyph->has_info;
     if (need_info) {
+	unsigned long size = _cairo_scaled_glyph_size (scaled_glyph);
+
+	miss = TRUE;
 	status = scaled_font->backend->scaled_glyph_init (scaled_font,
 							  scaled_glyph,
 							  need_info);
+	_cairo_scaled_glyph_page_resize (scaled_font, scaled_glyph->page,
+					 (long) (_cairo_scaled_glyph_size (scaled_glyph) - size));
 	if (unlikely (status))
 	    goto err;
 
@@ -2997,20 +3888,110 @@ _cairo_scaled_glyph_lookup (cairo_scaled_font_t *scaled_font,
 	 * backend may not even know about some of the info.  For example,
 	 * no backend other than the user-fonts knows about recording-surface
 	 * glyph info. */
-	if (info & ~scaled_glyph->has_info)
-	    return CAIRO_INT_STATUS_UNSUPPORTED;
+	if (info & ~scaled_glyph->has_info) {
+	    status = CAIRO_INT_STATUS_UNSUPPORTED;
+	    goto err;
+	}
     }
 
+    /* Only publish the new info once the fields it covers are written. */
+    _cairo_atomic_ptr_cmpxchg (slot, *slot,
+			       _cairo_scaled_glyph_lookup_entry (scaled_glyph));
+
+    if (! miss)
+	_cairo_atomic_int_inc (&_cairo_scaled_glyph_cache_stripe ()->hits);
+    else
+	_cairo_atomic_int_inc (&_cairo_scaled_glyph_cache_stripe ()->misses);
+
+    if (! scaled_glyph->page->referenced)
+	scaled_glyph->page->referenced = TRUE;
     *scaled_glyph_ret = scaled_glyph;
     return CAIRO_STATUS_SUCCESS;
 
 err:
+    if (miss)
+	_cairo_atomic_int_inc (&_cairo_scaled_glyph_cache_stripe ()->misses);
+
     /* It's not an error for the backend to not support the info we want. */
     if (status != CAIRO_INT_STATUS_UNSUPPORTED)
 	status = _cairo_scaled_font_set_error (scaled_font, status);
     return status;
 }
 
+/**
+ * _cairo_scaled_glyph_lookup:
+ * @scaled_font: a #cairo_scaled_font_t
+ * @index: the glyph to create
+ * @info: a #cairo_scaled_glyph_info_t marking which portions of
+ * the glyph should be filled in.
+ * @scaled_glyph_ret: a #cairo_scaled_glyph_t where the glyph
+ * is returned.
+ *
+ * If the desired info is not available, (for example, when trying to
+ * get INFO_PATH with a bitmapped font), this function will return
+ * %CAIRO_INT_STATUS_UNSUPPORTED.
+ *
+ * Note: This function must be called with the scaled font frozen, and it must
+ * remain frozen for as long as the @scaled_glyph_ret is alive. (If the scaled
+ * font was not frozen, then there is no guarantee that the glyph would not be
+ * evicted before you tried to access it.) See
+ * _cairo_scaled_font_freeze_cache() and _cairo_scaled_font_thaw_cache().
+ *
+ * Glyphs that are already cached with the requested info are found
+ * without taking any lock, so threads may share a font frozen with
+ * _cairo_scaled_font_freeze_cache_shared().
+ *
+ * Returns: a glyph with the requested portions filled in. Glyph
+ * lookup is cached and glyph will be automatically freed along
+ * with the scaled_font so no explicit free is required.
+ * @info can be one or more of:
+ *  %CAIRO_SCALED_GLYPH_INFO_METRICS - glyph metrics and bounding box
+ *  %CAIRO_SCALED_GLYPH_INFO_SURFACE - surface holding glyph image
+ *  %CAIRO_SCALED_GLYPH_INFO_PATH - path holding glyph outline in device space
+ **/
+cairo_int_status_t
+_cairo_scaled_glyph_lookup (cairo_scaled_font_t *scaled_font,
+			    unsigned long index,
+			    cairo_scaled_glyph_info_t info,
+			    cairo_scaled_glyph_t **scaled_glyph_ret)
+{
+    cairo_int_status_t status;
+    cairo_scaled_glyph_t *scaled_glyph;
+    void **slot, *entry;
+
+    *scaled_glyph_ret = NULL;
+
+    if (unlikely (scaled_font->status))
+	return scaled_font->status;
+
+    assert (_cairo_atomic_int_get (&scaled_font->cache_frozen) > 0);
+
+    if (CAIRO_INJECT_FAULT ())
+	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+
+    slot = &scaled_font->glyph_lookup[_cairo_scaled_glyph_index_hash (index) %
+				      CAIRO_SCALED_GLYPH_LOOKUP_SIZE];
+    entry = _cairo_atomic_ptr_get (slot);
+    scaled_glyph = _cairo_scaled_glyph_lookup_entry_glyph (entry);
+    if (scaled_glyph != NULL &&
+	_cairo_scaled_glyph_index (scaled_glyph) == index &&
+	(info & ~_cairo_scaled_glyph_lookup_entry_info (entry)) == 0)
+    {
+	_cairo_atomic_int_inc (&_cairo_scaled_glyph_cache_stripe ()->hits);
+	if (! scaled_glyph->page->referenced)
+	    scaled_glyph->page->referenced = TRUE;
+	*scaled_glyph_ret = scaled_glyph;
+	return CAIRO_INT_STATUS_SUCCESS;
+    }
+
+    CAIRO_MUTEX_LOCK (scaled_font->glyph_mutex);
+    status = _cairo_scaled_glyph_lookup_locked (scaled_font, index, info,
+						scaled_glyph_ret);
+    CAIRO_MUTEX_UNLOCK (scaled_font->glyph_mutex);
+
+    return status;
+}
+
 double
 _cairo_scaled_font_get_max_scale (cairo_scaled_font_t *scaled_font)
 {
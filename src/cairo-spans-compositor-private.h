@@ -100,6 +100,10 @@ struct cairo_spans_compositor {
 
     void (*renderer_fini) (cairo_abstract_span_renderer_t *renderer,
 			   cairo_int_status_t status);
+
+    /* optional: may the renderer generate its rows concurrently with
+     * other renderers targeting disjoint rows of the same surface? */
+    cairo_bool_t (*renderer_is_threadsafe) (const cairo_abstract_span_renderer_t *renderer);
 };
 
 cairo_private void
@@ -53,6 +53,7 @@
 #include "cairo-surface-subsurface-private.h"
 #include "cairo-surface-snapshot-private.h"
 #include "cairo-surface-observer-private.h"
+#include "cairo-thread-pool-private.h"
 
 typedef struct {
     cairo_polygon_t	*polygon;
@@ -419,6 +420,90 @@ error:
     return status;
 }
 
+/* Draws through a clip path normally intersect the clip with each shape,
+ * which repeats the work for every draw between a save and restore. Once
+ * a clip path is used a second time, its coverage is rasterised over the
+ * whole clip and attached to the clip path, so that subsequent draws
+ * need only composite through it.
+ */
+#define CLIP_COVERAGE_MAX_AREA (2048 * 2048)
+
+static cairo_bool_t
+clip_is_reused (const cairo_clip_t *clip)
+{
+    cairo_clip_path_t *clip_path = clip->path;
+    int i;
+
+    /* The shared coverage only includes the paths, so the boxes must not
+     * cut across pixels.
+     */
+    for (i = 0; i < clip->num_boxes; i++) {
+	const cairo_box_t *b = &clip->boxes[i];
+	if (!_cairo_fixed_is_integer (b->p1.x | b->p1.y |  b->p2.x | b->p2.y))
+	    return FALSE;
+    }
+
+    if (_cairo_atomic_ptr_get ((void **) &clip_path->coverage) != NULL ||
+	_cairo_atomic_int_get (&clip_path->num_uses))
+	return TRUE;
+
+    /* the clip path may be shared between threads, only one sees it first */
+    return ! _cairo_atomic_int_cmpxchg (&clip_path->num_uses, 0, 1);
+}
+
+static cairo_surface_t *
+get_shared_clip_surface (const cairo_spans_compositor_t *compositor,
+			 const cairo_composite_rectangles_t *composite,
+			 const cairo_rectangle_int_t *extents,
+			 int *x, int *y)
+{
+    cairo_clip_path_t *clip_path = composite->clip->path;
+    cairo_surface_t *surface;
+    cairo_clip_t path_only;
+    cairo_rectangle_int_t r;
+
+    surface = _cairo_clip_path_get_coverage (clip_path, composite->surface,
+					     extents, x, y);
+    if (surface != NULL)
+	return surface;
+
+    r = composite->destination;
+    for (; clip_path != NULL; clip_path = clip_path->prev) {
+	cairo_rectangle_int_t path_extents;
+
+	_cairo_path_fixed_approximate_clip_extents (&clip_path->path,
+						    &path_extents);
+	_cairo_rectangle_intersect (&r, &path_extents);
+    }
+
+    /* Fall back to a private mask if the coverage is already attached for
+     * another target, or would be too large.
+     */
+    if (composite->clip->path->coverage != NULL ||
+	! _cairo_rectangle_contains_rectangle (&r, extents) ||
+	r.width > CLIP_COVERAGE_MAX_AREA / r.height)
+    {
+	*x = extents->x;
+	*y = extents->y;
+	return get_clip_surface (compositor, composite->surface,
+				 composite->clip, extents);
+    }
+
+    path_only.path = composite->clip->path;
+    path_only.boxes = NULL;
+    path_only.num_boxes = 0;
+    surface = get_clip_surface (compositor, composite->surface,
+				&path_only, &r);
+    if (unlikely (surface->status))
+	return surface;
+
+    _cairo_clip_path_set_coverage (composite->clip->path, surface, &r);
+
+    *x = r.x;
+    *y = r.y;
+    return surface;
+}
+
 static cairo_surface_t *
 unwrap_source (const cairo_pattern_t *pattern)
 {
@@ -617,13 +702,23 @@ composite_aligned_boxes (const cairo_spans_compositor_t		*compositor,
 
 	/* All typical cases will have been resolved before now... */
 	if (need_clip_mask) {
-	    mask = get_clip_surface (compositor, dst, extents->clip,
-				     &extents->bounded);
+	    int x, y;
+
+	    /* the clip mask is only shared if it will not be modified */
+	    if (no_mask) {
+		mask = get_shared_clip_surface (compositor, extents,
+						&extents->bounded, &x, &y);
+	    } else {
+		mask = get_clip_surface (compositor, dst, extents->clip,
+					 &extents->bounded);
+		x = extents->bounded.x;
+		y = extents->bounded.y;
+	    }
 	    if (unlikely (mask->status))
 		return mask->status;
 
-	    mask_x = -extents->bounded.x;
-	    mask_y = -extents->bounded.y;
+	    mask_x = -x;
+	    mask_y = -y;
 	}
 
 	/* XXX but this is still ugly */
@@ -724,6 +819,327 @@ cleanup_converter:
     return status;
 }
 
+/* The antialias hint selects the scan converter, trading the density
+ * of the sampling grid against speed:
+ *
+ *   NONE		mono, a single sample per pixel
+ *   FAST		tor22, a 4x4 grid
+ *   DEFAULT, GOOD	tor, a 256x15 grid
+ *   BEST		area, exact analytic coverage
+ *
+ * The area converter sums the signed area swept by each edge within a
+ * pixel, which is only the true coverage whilst the winding stays within
+ * 0 and 1. So the polygon is first reduced into disjoint regions of unit
+ * winding, at the cost of a Bentley-Ottmann pass, before it is handed to
+ * the area converter. GRAY and SUBPIXEL are treated as GOOD. The antialiasing scan converter
+ * may be forced whilst testing by setting CAIRO_SCAN_CONVERTER to one of
+ * "tor", "tor22" or "area".
+ */
+enum scan_converter {
+    SCAN_CONVERTER_UNKNOWN = -1,
+    SCAN_CONVERTER_DEFAULT,
+    SCAN_CONVERTER_MONO,
+    SCAN_CONVERTER_TOR,
+    SCAN_CONVERTER_TOR22,
+    SCAN_CONVERTER_AREA,
+};
+
+static cairo_atomic_int_t forced_scan_converter = SCAN_CONVERTER_UNKNOWN;
+
+static enum scan_converter
+get_forced_scan_converter (void)
+{
+    int type;
+
+    type = _cairo_atomic_int_get (&forced_scan_converter);
+    if (unlikely (type == SCAN_CONVERTER_UNKNOWN)) {
+	const char *env = getenv ("CAIRO_SCAN_CONVERTER");
+
+	type = SCAN_CONVERTER_DEFAULT;
+	if (env != NULL) {
+	    if (strcmp (env, "tor") == 0)
+		type = SCAN_CONVERTER_TOR;
+	    else if (strcmp (env, "tor22") == 0)
+		type = SCAN_CONVERTER_TOR22;
+	    else if (strcmp (env, "area") == 0)
+		type = SCAN_CONVERTER_AREA;
+	}
+
+	/* every thread reads the same answer, so losing the race is harmless */
+	_cairo_atomic_int_cmpxchg (&forced_scan_converter,
+				   SCAN_CONVERTER_UNKNOWN, type);
+    }
+
+    return type;
+}
+
+static enum scan_converter
+scan_converter_type (cairo_antialias_t antialias)
+{
+    enum scan_converter type;
+
+    if (antialias == CAIRO_ANTIALIAS_NONE)
+	return SCAN_CONVERTER_MONO;
+
+    type = get_forced_scan_converter ();
+    if (type != SCAN_CONVERTER_DEFAULT)
+	return type;
+
+    switch (antialias) {
+    case CAIRO_ANTIALIAS_FAST:
+	return SCAN_CONVERTER_TOR22;
+    case CAIRO_ANTIALIAS_BEST:
+	return SCAN_CONVERTER_AREA;
+    default:
+    case CAIRO_ANTIALIAS_DEFAULT:
+    case CAIRO_ANTIALIAS_NONE:
+    case CAIRO_ANTIALIAS_GRAY:
+    case CAIRO_ANTIALIAS_SUBPIXEL:
+    case CAIRO_ANTIALIAS_GOOD:
+	return SCAN_CONVERTER_TOR;
+    }
+}
+
+static cairo_int_status_t
+prepare_polygon (enum scan_converter type,
+		 cairo_polygon_t *polygon,
+		 cairo_fill_rule_t *fill_rule)
+{
+    cairo_int_status_t status;
+
+    if (type != SCAN_CONVERTER_AREA)
+	return CAIRO_INT_STATUS_SUCCESS;
+
+    status = _cairo_polygon_reduce (polygon, *fill_rule);
+    *fill_rule = CAIRO_FILL_RULE_WINDING;
+    return status;
+}
+
+static cairo_int_status_t
+create_scan_converter (enum scan_converter		 type,
+		       const cairo_rectangle_int_t	*r,
+		       const cairo_polygon_t		*polygon,
+		       cairo_fill_rule_t		 fill_rule,
+		       cairo_antialias_t		 antialias,
+		       cairo_scan_converter_t		**out)
+{
+    cairo_scan_converter_t *converter;
+    cairo_int_status_t status;
+
+    if (type == SCAN_CONVERTER_AREA) {
+	converter = _cairo_area_scan_converter_create (r->x, r->y,
+						       r->x + r->width,
+						       r->y + r->height,
+						       fill_rule, antialias);
+	status = _cairo_area_scan_converter_add_polygon (converter, polygon);
+    } else if (type == SCAN_CONVERTER_TOR22) {
+	converter = _cairo_tor22_scan_converter_create (r->x, r->y,
+							r->x + r->width,
+							r->y + r->height,
+							fill_rule, antialias);
+	status = _cairo_tor22_scan_converter_add_polygon (converter, polygon);
+    } else if (type == SCAN_CONVERTER_MONO) {
+	converter = _cairo_mono_scan_converter_create (r->x, r->y,
+						       r->x + r->width,
+						       r->y + r->height,
+						       fill_rule);
+	status = _cairo_mono_scan_converter_add_polygon (converter, polygon);
+    } else {
+	converter = _cairo_tor_scan_converter_create (r->x, r->y,
+						      r->x + r->width,
+						      r->y + r->height,
+						      fill_rule, antialias);
+	status = _cairo_tor_scan_converter_add_polygon (converter, polygon);
+    }
+
+    *out = converter;
+    return status;
+}
+
+/**
+ * _cairo_scan_converter_create_for_polygon:
+ * @r: the rows and columns to generate
+ * @polygon: the polygon to convert
+ * @fill_rule: the fill rule of @polygon
+ * @antialias: the antialias hint, which selects the scan converter
+ * @out: return location for the new converter
+ *
+ * Creates the scan converter the spans compositor would use for
+ * @polygon and adds the polygon to it, first reducing @polygon in place
+ * if the converter requires it. If that reduction fails, @out is set to
+ * %NULL; otherwise the converter is returned even if adding the polygon
+ * fails, and must then still be destroyed.
+ **/
+cairo_int_status_t
+_cairo_scan_converter_create_for_polygon (const cairo_rectangle_int_t	*r,
+					  cairo_polygon_t		*polygon,
+					  cairo_fill_rule_t		 fill_rule,
+					  cairo_antialias_t		 antialias,
+					  cairo_scan_converter_t	**out)
+{
+    enum scan_converter type;
+    cairo_int_status_t status;
+
+    type = scan_converter_type (antialias);
+    status = prepare_polygon (type, polygon, &fill_rule);
+    if (unlikely (status)) {
+	*out = NULL;
+	return status;
+    }
+
+    return create_scan_converter (type, r, polygon,
+				  fill_rule, antialias, out);
+}
+
+/* Band-parallel rasterisation.
+ *
+ * Large polygons may be split into horizontal bands, each with its own
+ * scan converter and span renderer limited to those rows, so that the
+ * bands can be converted and composited on the thread pool. The scan
+ * converters clip edges to their extents using exact arithmetic, so the
+ * coverage (and hence the result) is identical to the serial path.
+ *
+ * The renderers are always created and finished on the calling thread,
+ * only the span generation is run concurrently, and only if the backend
+ * reports that the renderer is safe to use in that manner.
+ */
+#define BAND_MIN_HEIGHT 32
+#define BAND_MIN_AREA (256 * 256)
+#define BANDS_PER_THREAD 2
+
+typedef struct _composite_band {
+    cairo_composite_rectangles_t extents;
+    cairo_abstract_span_renderer_t renderer;
+    cairo_scan_converter_t *converter;
+    cairo_int_status_t status;
+} composite_band_t;
+
+static cairo_bool_t
+pattern_is_threadsafe (const cairo_pattern_t *pattern)
+{
+    switch (pattern->type) {
+    case CAIRO_PATTERN_TYPE_SOLID:
+    case CAIRO_PATTERN_TYPE_LINEAR:
+    case CAIRO_PATTERN_TYPE_RADIAL:
+	return TRUE;
+    case CAIRO_PATTERN_TYPE_SURFACE:
+	/* avoid replaying recording surfaces for every band */
+	return ((const cairo_surface_pattern_t *) pattern)->surface->type == CAIRO_SURFACE_TYPE_IMAGE;
+    case CAIRO_PATTERN_TYPE_MESH:
+    case CAIRO_PATTERN_TYPE_RASTER_SOURCE:
+    default:
+	return FALSE;
+    }
+}
+
+static void
+generate_band (void *closure, int index)
+{
+    composite_band_t *band = (composite_band_t *) closure + index;
+
+    band->status = band->converter->generate (band->converter,
+					      &band->renderer.base);
+}
+
+static cairo_int_status_t
+composite_polygon_bands (const cairo_spans_compositor_t	*compositor,
+			 cairo_composite_rectangles_t	*extents,
+			 enum scan_converter		 type,
+			 const cairo_polygon_t		*polygon,
+			 cairo_fill_rule_t		 fill_rule,
+			 cairo_antialias_t		 antialias)
+{
+    const cairo_rectangle_int_t *r = &extents->unbounded;
+    composite_band_t *bands;
+    cairo_int_status_t status;
+    int num_threads, num_bands, band_height;
+    int i, n;
+
+    if (compositor->renderer_is_threadsafe == NULL)
+	return CAIRO_INT_STATUS_UNSUPPORTED;
+
+    if (r->height < 2 * BAND_MIN_HEIGHT || r->width * r->height < BAND_MIN_AREA)
+	return CAIRO_INT_STATUS_UNSUPPORTED;
+
+    num_threads = _cairo_thread_pool_get_num_threads ();
+    if (num_threads <= 1)
+	return CAIRO_INT_STATUS_UNSUPPORTED;
+
+    if (! pattern_is_threadsafe (&extents->source_pattern.base) ||
+	extents->mask_pattern.base.type != CAIRO_PATTERN_TYPE_SOLID)
+	return CAIRO_INT_STATUS_UNSUPPORTED;
+
+    num_bands = MIN (num_threads * BANDS_PER_THREAD, r->height / BAND_MIN_HEIGHT);
+    band_height = (r->height + num_bands - 1) / num_bands;
+    num_bands = (r->height + band_height - 1) / band_height;
+
+    bands = _cairo_malloc_ab (num_bands, sizeof (composite_band_t));
+    if (unlikely (bands == NULL))
+	return CAIRO_INT_STATUS_UNSUPPORTED;
+
+    status = CAIRO_INT_STATUS_SUCCESS;
+    for (n = 0; n < num_bands; n++) {
+	composite_band_t *band = &bands[n];
+	int y1 = r->y + n * band_height;
+	int y2 = MIN (y1 + band_height, r->y + r->height);
+
+	band->extents = *extents;
+	band->extents.unbounded.y = y1;
+	band->extents.unbounded.height = y2 - y1;
+	if (! _cairo_rectangle_intersect (&band->extents.bounded,
+					  &band->extents.unbounded))
+	{
+	    band->extents.bounded.y = y1;
+	    band->extents.bounded.height = 0;
+	}
+
+	status = create_scan_converter (type, &band->extents.unbounded,
+					polygon, fill_rule, antialias,
+					&band->converter);
+	if (unlikely (status)) {
+	    band->converter->destroy (band->converter);
+	    break;
+	}
+
+	status = compositor->renderer_init (&band->renderer, &band->extents,
+					    antialias, FALSE);
+	if (likely (status == CAIRO_INT_STATUS_SUCCESS) &&
+	    ! compositor->renderer_is_threadsafe (&band->renderer))
+	{
+	    status = CAIRO_INT_STATUS_UNSUPPORTED;
+	}
+	if (unlikely (status)) {
+	    compositor->renderer_fini (&band->renderer, status);
+	    band->converter->destroy (band->converter);
+
+	    /* let the serial path decide what to do with the whole */
+	    if (! _cairo_int_status_is_error (status))
+		status = CAIRO_INT_STATUS_UNSUPPORTED;
+	    break;
+	}
+
+	band->status = CAIRO_INT_STATUS_SUCCESS;
+    }
+
+    if (likely (status == CAIRO_INT_STATUS_SUCCESS))
+	_cairo_thread_pool_run (generate_band, bands, num_bands);
+
+    for (i = 0; i < n; i++) {
+	composite_band_t *band = &bands[i];
+
+	if (status == CAIRO_INT_STATUS_SUCCESS)
+	    status = band->status;
+	else if (band->status == CAIRO_INT_STATUS_SUCCESS)
+	    band->status = status;
+
+	compositor->renderer_fini (&band->renderer, band->status);
+	band->converter->destroy (band->converter);
+    }
+
+    free (bands);
+    return status;
+}
+
 static cairo_int_status_t
 composite_polygon (const cairo_spans_compositor_t	*compositor,
 		   cairo_composite_rectangles_t		 *extents,
@@ -745,27 +1161,20 @@ composite_polygon (const cairo_spans_compositor_t	*compositor,
 							   polygon,
 							   fill_rule, antialias);
     } else {
-	const cairo_rectangle_int_t *r = &extents->unbounded;
-
-	if (antialias == CAIRO_ANTIALIAS_FAST) {
-	    converter = _cairo_tor22_scan_converter_create (r->x, r->y,
-							    r->x + r->width,
-							    r->y + r->height,
-							    fill_rule, antialias);
-	    status = _cairo_tor22_scan_converter_add_polygon (converter, polygon);
-	} else if (antialias == CAIRO_ANTIALIAS_NONE) {
-	    converter = _cairo_mono_scan_converter_create (r->x, r->y,
-							   r->x + r->width,
-							   r->y + r->height,
-							   fill_rule);
-	    status = _cairo_mono_scan_converter_add_polygon (converter, polygon);
-	} else {
-	    converter = _cairo_tor_scan_converter_create (r->x, r->y,
-							  r->x + r->width,
-							  r->y + r->height,
-							  fill_rule, antialias);
-	    status = _cairo_tor_scan_converter_add_polygon (converter, polygon);
-	}
+	enum scan_converter type = scan_converter_type (antialias);
+
+	status = prepare_polygon (type, polygon, &fill_rule);
+	if (unlikely (status))
+	    return status;
+
+	status = composite_polygon_bands (compositor, extents, type, polygon,
+					  fill_rule, antialias);
+	if (status != CAIRO_INT_STATUS_UNSUPPORTED)
+	    return status;
+
+	status = create_scan_converter (type, &extents->unbounded,
+					polygon, fill_rule, antialias,
+					&converter);
     }
     if (unlikely (status))
 	goto cleanup_converter;
@@ -819,6 +1228,18 @@ clip_and_composite_boxes (const cairo_spans_compositor_t	*compositor,
 	return fixup_unbounded_boxes (compositor, extents, boxes);
     }
 
+    /* Composite through the shared coverage of a clip used before? */
+    if (extents->clip->path != NULL && extents->is_bounded &&
+	boxes->is_pixel_aligned &&
+	extents->mask_pattern.base.type == CAIRO_PATTERN_TYPE_SOLID &&
+	CAIRO_COLOR_IS_OPAQUE (&extents->mask_pattern.solid.color) &&
+	clip_is_reused (extents->clip))
+    {
+	status = composite_aligned_boxes (compositor, extents, boxes);
+	if (status != CAIRO_INT_STATUS_UNSUPPORTED)
+	    return status;
+    }
+
     /* Can we reduce drawing through a clip-mask to simply drawing the clip? */
     if (extents->clip->path != NULL && extents->is_bounded) {
 	cairo_polygon_t polygon;
@@ -978,6 +1399,464 @@ _cairo_spans_compositor_mask (const cairo_compositor_t		*_compositor,
     return status;
 }
 
+/* Coverage mask cache.
+ *
+ * User interfaces tend to fill the same small shapes, icons, buttons,
+ * checkmarks and the like, at a different integer offset on every frame.
+ * Such shapes are rasterised once into an A8 mask, keyed by the path
+ * relative to its integer origin (so the fractional offset forms part of
+ * the key) and by every parameter that affects the coverage. Later draws
+ * then composite the mask as if by cairo_mask().
+ *
+ * One-off paths must not pay for the cache, so a shape is first only
+ * hashed, in place, and the hash remembered. Only once the same hash is
+ * seen again is the path copied and its mask rasterised into the cache.
+ * The cache is split into shards by hash, each under its own lock, so
+ * that threads drawing different shapes do not contend. Only image
+ * destinations use the cache, which lets the masks be shared by all
+ * surfaces.
+ */
+#define COVERAGE_CACHE_MAX_SIZE (4 << 20)
+#define COVERAGE_CACHE_MAX_AREA (256 * 256)
+#define COVERAGE_CACHE_NUM_SHARDS 4
+#define COVERAGE_CACHE_NUM_SEEN 64
+
+typedef struct _coverage_entry {
+    cairo_cache_entry_t base;
+
+    cairo_path_fixed_t path; /* translated to the integer origin */
+    const cairo_stroke_style_t *style; /* NULL for fills */
+    cairo_stroke_style_t style_copy;
+    cairo_matrix_t ctm;
+    cairo_fill_rule_t fill_rule;
+    cairo_antialias_t antialias;
+    double tolerance;
+
+    cairo_rectangle_int_t mask_extents; /* relative to the origin */
+    cairo_surface_t *mask;
+} coverage_entry_t;
+
+typedef struct _coverage_shard {
+    cairo_mutex_t *mutex;
+    cairo_cache_t cache;
+    cairo_bool_t cache_initialized;
+    unsigned long seen[COVERAGE_CACHE_NUM_SEEN];
+} coverage_shard_t;
+
+static coverage_shard_t coverage_shards[COVERAGE_CACHE_NUM_SHARDS] = {
+    { &_cairo_spans_coverage_cache_mutex_0 },
+    { &_cairo_spans_coverage_cache_mutex_1 },
+    { &_cairo_spans_coverage_cache_mutex_2 },
+    { &_cairo_spans_coverage_cache_mutex_3 },
+};
+
+static cairo_bool_t
+stroke_style_equal (const cairo_stroke_style_t *a,
+		    const cairo_stroke_style_t *b)
+{
+    if (a->line_width != b->line_width ||
+	a->line_cap != b->line_cap ||
+	a->line_join != b->line_join ||
+	a->miter_limit != b->miter_limit ||
+	a->num_dashes != b->num_dashes ||
+	a->dash_offset != b->dash_offset)
+	return FALSE;
+
+    return a->num_dashes == 0 ||
+	memcmp (a->dash, b->dash, a->num_dashes * sizeof (double)) == 0;
+}
+
+static cairo_bool_t
+coverage_entry_equal (const void *A, const void *B)
+{
+    const coverage_entry_t *a = A, *b = B;
+
+    if (a->fill_rule != b->fill_rule ||
+	a->antialias != b->antialias ||
+	a->tolerance != b->tolerance)
+	return FALSE;
+
+    if (a->style != NULL || b->style != NULL) {
+	if (a->style == NULL || b->style == NULL)
+	    return FALSE;
+
+	/* the translation of the ctm does not affect the pen */
+	if (a->ctm.xx != b->ctm.xx || a->ctm.yx != b->ctm.yx ||
+	    a->ctm.xy != b->ctm.xy || a->ctm.yy != b->ctm.yy)
+	    return FALSE;
+
+	if (! stroke_style_equal (a->style, b->style))
+	    return FALSE;
+    }
+
+    return _cairo_path_fixed_equal (&a->path, &b->path);
+}
+
+static unsigned long
+coverage_entry_hash (unsigned long hash, const coverage_entry_t *entry)
+{
+    hash = _cairo_hash_bytes (hash, &entry->fill_rule, sizeof (entry->fill_rule));
+    hash = _cairo_hash_bytes (hash, &entry->antialias, sizeof (entry->antialias));
+    hash = _cairo_hash_bytes (hash, &entry->tolerance, sizeof (entry->tolerance));
+    if (entry->style != NULL) {
+	hash = _cairo_hash_bytes (hash, &entry->style->line_width,
+				  sizeof (entry->style->line_width));
+	hash = _cairo_hash_bytes (hash, &entry->ctm, 4 * sizeof (double));
+    }
+
+    return hash;
+}
+
+static void
+coverage_entry_destroy (void *closure)
+{
+    coverage_entry_t *entry = closure;
+
+    cairo_surface_destroy (entry->mask);
+    if (entry->style == &entry->style_copy)
+	_cairo_stroke_style_fini (&entry->style_copy);
+    _cairo_path_fixed_fini (&entry->path);
+    free (entry);
+}
+
+/* Records a sighting of @hash, and returns whether it was seen before.
+ * Called with the shard mutex held. */
+static cairo_bool_t
+coverage_shard_seen (coverage_shard_t *shard, unsigned long hash)
+{
+    unsigned long *seen;
+
+    seen = &shard->seen[(hash / COVERAGE_CACHE_NUM_SHARDS) % COVERAGE_CACHE_NUM_SEEN];
+    if (*seen == hash)
+	return TRUE;
+
+    *seen = hash;
+    return FALSE;
+}
+
+/* Copies the key and its mask into a new entry owned by the cache.
+ * Called with the shard mutex held. */
+static cairo_status_t
+coverage_shard_insert (coverage_shard_t *shard, const coverage_entry_t *key)
+{
+    coverage_entry_t *entry;
+    cairo_status_t status;
+
+    if (! shard->cache_initialized) {
+	status = _cairo_cache_init (&shard->cache,
+				    coverage_entry_equal,
+				    NULL,
+				    coverage_entry_destroy,
+				    COVERAGE_CACHE_MAX_SIZE / COVERAGE_CACHE_NUM_SHARDS);
+	if (unlikely (status))
+	    return status;
+
+	shard->cache_initialized = TRUE;
+    }
+
+    entry = malloc (sizeof (coverage_entry_t));
+    if (unlikely (entry == NULL))
+	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+
+    status = _cairo_path_fixed_init_copy (&entry->path, &key->path);
+    if (unlikely (status)) {
+	free (entry);
+	return status;
+    }
+
+    entry->style = NULL;
+    if (key->style != NULL) {
+	status = _cairo_stroke_style_init_copy (&entry->style_copy,
+						key->style);
+	if (unlikely (status)) {
+	    _cairo_path_fixed_fini (&entry->path);
+	    free (entry);
+	    return status;
+	}
+
+	entry->style = &entry->style_copy;
+    }
+
+    entry->base.hash = key->base.hash;
+    entry->ctm = key->ctm;
+    entry->fill_rule = key->fill_rule;
+    entry->antialias = key->antialias;
+    entry->tolerance = key->tolerance;
+    entry->mask_extents = key->mask_extents;
+    entry->mask = cairo_surface_reference (key->mask);
+
+    entry->base.size = sizeof (coverage_entry_t) +
+		       _cairo_path_fixed_size (&entry->path) +
+		       entry->mask_extents.width * entry->mask_extents.height;
+
+    status = _cairo_cache_insert (&shard->cache, &entry->base);
+    if (unlikely (status))
+	coverage_entry_destroy (entry);
+
+    return status;
+}
+
+void
+_cairo_spans_compositor_reset_static_data (void)
+{
+    int i;
+
+    for (i = 0; i < COVERAGE_CACHE_NUM_SHARDS; i++) {
+	coverage_shard_t *shard = &coverage_shards[i];
+
+	CAIRO_MUTEX_LOCK (*shard->mutex);
+	if (shard->cache_initialized) {
+	    _cairo_cache_fini (&shard->cache);
+	    shard->cache_initialized = FALSE;
+	}
+	memset (shard->seen, 0, sizeof (shard->seen));
+	CAIRO_MUTEX_UNLOCK (*shard->mutex);
+    }
+}
+
+static cairo_int_status_t
+coverage_entry_rasterise (const cairo_spans_compositor_t *compositor,
+			  coverage_entry_t *entry,
+			  const cairo_matrix_t *ctm_inverse)
+{
+    const cairo_rectangle_int_t *r = &entry->mask_extents;
+    cairo_composite_rectangles_t composite;
+    cairo_polygon_t polygon;
+    cairo_int_status_t status;
+
+    _cairo_polygon_init (&polygon, NULL, 0);
+    if (entry->style != NULL)
+	status = _cairo_path_fixed_stroke_to_polygon (&entry->path,
+						      entry->style,
+						      &entry->ctm, ctm_inverse,
+						      entry->tolerance,
+						      &polygon);
+    else
+	status = _cairo_path_fixed_fill_to_polygon (&entry->path,
+						    entry->tolerance,
+						    &polygon);
+    if (unlikely (status))
+	goto cleanup_polygon;
+
+    entry->mask = _cairo_image_surface_create_with_content (CAIRO_CONTENT_ALPHA,
+							    r->width,
+							    r->height);
+    status = entry->mask->status;
+    if (unlikely (status))
+	goto cleanup_polygon;
+
+    _cairo_polygon_translate (&polygon, -r->x, -r->y);
+    status = _cairo_composite_rectangles_init_for_polygon (&composite,
+							   entry->mask,
+							   CAIRO_OPERATOR_ADD,
+							   &_cairo_pattern_white.base,
+							   &polygon,
+							   NULL);
+    if (status == CAIRO_INT_STATUS_NOTHING_TO_DO) {
+	status = CAIRO_INT_STATUS_SUCCESS;
+    } else if (likely (status == CAIRO_INT_STATUS_SUCCESS)) {
+	status = composite_polygon (compositor, &composite, &polygon,
+				    entry->fill_rule, entry->antialias);
+	_cairo_composite_rectangles_fini (&composite);
+    }
+
+cleanup_polygon:
+    _cairo_polygon_fini (&polygon);
+    return status;
+}
+
+static cairo_int_status_t
+composite_coverage_mask (const cairo_spans_compositor_t *compositor,
+			 const cairo_composite_rectangles_t *extents,
+			 cairo_surface_t *mask,
+			 int x, int y)
+{
+    cairo_composite_rectangles_t composite;
+    cairo_surface_pattern_t pattern;
+    cairo_int_status_t status;
+
+    _cairo_pattern_init_for_surface (&pattern, mask);
+    cairo_matrix_init_translate (&pattern.base.matrix, -x, -y);
+    pattern.base.filter = CAIRO_FILTER_NEAREST;
+    pattern.base.extend = CAIRO_EXTEND_NONE;
+
+    status = _cairo_composite_rectangles_init_for_mask (&composite,
+							extents->surface,
+							extents->op,
+							extents->original_source_pattern,
+							&pattern.base,
+							extents->clip);
+    if (likely (status == CAIRO_INT_STATUS_SUCCESS)) {
+	status = _cairo_spans_compositor_mask (&compositor->base, &composite);
+	_cairo_composite_rectangles_fini (&composite);
+    }
+
+    _cairo_pattern_fini (&pattern.base);
+    return status;
+}
+
+static cairo_int_status_t
+composite_cached_coverage (const cairo_spans_compositor_t	*compositor,
+			   cairo_composite_rectangles_t		*extents,
+			   const cairo_path_fixed_t		*path,
+			   cairo_fill_rule_t			 fill_rule,
+			   const cairo_stroke_style_t		*style,
+			   const cairo_matrix_t			*ctm,
+			   const cairo_matrix_t			*ctm_inverse,
+			   double				 tolerance,
+			   cairo_antialias_t			 antialias)
+{
+    coverage_shard_t *shard;
+    coverage_entry_t key, *cached;
+    cairo_surface_t *mask = NULL;
+    cairo_rectangle_int_t r;
+    cairo_int_status_t status;
+    cairo_bool_t seen;
+    int ox, oy;
+
+    if (extents->surface->backend->type != CAIRO_SURFACE_TYPE_IMAGE)
+	return CAIRO_INT_STATUS_UNSUPPORTED;
+
+    if (style != NULL)
+	_cairo_path_fixed_approximate_stroke_extents (path, style, ctm, &r);
+    else
+	_cairo_path_fixed_approximate_fill_extents (path, &r);
+    if (r.width <= 0 || r.height <= 0 ||
+	r.width > COVERAGE_CACHE_MAX_AREA / r.height)
+	return CAIRO_INT_STATUS_UNSUPPORTED;
+
+    ox = _cairo_fixed_integer_floor (path->extents.p1.x);
+    oy = _cairo_fixed_integer_floor (path->extents.p1.y);
+
+    key.style = style;
+    if (ctm != NULL)
+	key.ctm = *ctm;
+    else
+	cairo_matrix_init_identity (&key.ctm);
+    key.fill_rule = style != NULL ? CAIRO_FILL_RULE_WINDING : fill_rule;
+    key.antialias = antialias;
+    key.tolerance = tolerance;
+    key.base.hash = _cairo_path_fixed_hash_relative (path,
+						     _cairo_fixed_from_int (ox),
+						     _cairo_fixed_from_int (oy));
+    key.base.hash = coverage_entry_hash (key.base.hash, &key);
+
+    shard = &coverage_shards[key.base.hash % COVERAGE_CACHE_NUM_SHARDS];
+    CAIRO_MUTEX_LOCK (*shard->mutex);
+    seen = coverage_shard_seen (shard, key.base.hash);
+    CAIRO_MUTEX_UNLOCK (*shard->mutex);
+    if (! seen)
+	return CAIRO_INT_STATUS_UNSUPPORTED;
+
+    status = _cairo_path_fixed_init_copy (&key.path, path);
+    if (unlikely (status))
+	return status;
+
+    _cairo_path_fixed_translate (&key.path,
+				 _cairo_fixed_from_int (-ox),
+				 _cairo_fixed_from_int (-oy));
+    key.mask_extents = r;
+    key.mask_extents.x -= ox;
+    key.mask_extents.y -= oy;
+    key.mask = NULL;
+
+    CAIRO_MUTEX_LOCK (*shard->mutex);
+    if (shard->cache_initialized) {
+	cached = _cairo_cache_lookup (&shard->cache, &key.base);
+	if (cached != NULL) {
+	    mask = cairo_surface_reference (cached->mask);
+	    r = cached->mask_extents;
+	}
+    }
+    CAIRO_MUTEX_UNLOCK (*shard->mutex);
+
+    if (mask == NULL) {
+	status = coverage_entry_rasterise (compositor, &key, ctm_inverse);
+	if (likely (status == CAIRO_INT_STATUS_SUCCESS)) {
+	    mask = cairo_surface_reference (key.mask);
+	    r = key.mask_extents;
+
+	    CAIRO_MUTEX_LOCK (*shard->mutex);
+	    cached = NULL;
+	    if (shard->cache_initialized)
+		cached = _cairo_cache_lookup (&shard->cache, &key.base);
+	    if (cached == NULL)
+		coverage_shard_insert (shard, &key);
+	    CAIRO_MUTEX_UNLOCK (*shard->mutex);
+	}
+	cairo_surface_destroy (key.mask);
+    }
+    _cairo_path_fixed_fini (&key.path);
+
+    if (mask != NULL) {
+	status = composite_coverage_mask (compositor, extents, mask,
+					  ox + r.x, oy + r.y);
+	cairo_surface_destroy (mask);
+    }
+
+    return status;
+}
+
+/* Hairlines.
+ *
+ * Strokes no wider than a device pixel are rasterised straight from the
+ * path, skipping the stroker, the polygon and the full scan converter.
+ * Only undashed strokes under a similarity transform qualify, so that
+ * the pen remains a circle of known diameter.
+ */
+cairo_bool_t
+_cairo_stroke_is_hairline (const cairo_stroke_style_t	*style,
+			   const cairo_matrix_t		*ctm,
+			   double			*line_width)
+{
+    if (style->num_dashes)
+	return FALSE;
+
+    if (! ((ctm->xx == ctm->yy && ctm->xy == -ctm->yx) ||
+	   (ctm->xx == -ctm->yy && ctm->xy == ctm->yx)))
+	return FALSE;
+
+    *line_width = style->line_width * hypot (ctm->xx, ctm->yx);
+    return *line_width <= 1.;
+}
+
+static cairo_int_status_t
+composite_hairline (const cairo_spans_compositor_t	*compositor,
+		    cairo_composite_rectangles_t	*extents,
+		    const cairo_path_fixed_t		*path,
+		    cairo_line_cap_t			 line_cap,
+		    double				 line_width,
+		    double				 tolerance,
+		    cairo_antialias_t			 antialias)
+{
+    const cairo_rectangle_int_t *r = &extents->unbounded;
+    cairo_abstract_span_renderer_t renderer;
+    cairo_scan_converter_t *converter;
+    cairo_int_status_t status;
+
+    /* leave anything but a single clip box to the polygon */
+    if (! _clip_is_region (extents->clip) || extents->clip->num_boxes > 1)
+	return CAIRO_INT_STATUS_UNSUPPORTED;
+
+    converter = _cairo_hairline_scan_converter_create (r->x, r->y,
+						       r->x + r->width,
+						       r->y + r->height,
+						       line_width, line_cap);
+    status = _cairo_hairline_scan_converter_add_path (converter, path,
+						      tolerance);
+    if (unlikely (status))
+	goto cleanup_converter;
+
+    status = compositor->renderer_init (&renderer, extents, antialias, FALSE);
+    if (likely (status == CAIRO_INT_STATUS_SUCCESS))
+	status = converter->generate (converter, &renderer.base);
+    compositor->renderer_fini (&renderer, status);
+
+cleanup_converter:
+    converter->destroy (converter);
+    return status;
+}
+
 static cairo_int_status_t
 _cairo_spans_compositor_stroke (const cairo_compositor_t	*_compositor,
 				cairo_composite_rectangles_t	 *extents,
@@ -1013,6 +1892,25 @@ _cairo_spans_compositor_stroke (const cairo_compositor_t	*_compositor,
 	_cairo_boxes_fini (&boxes);
     }
 
+    if (status == CAIRO_INT_STATUS_UNSUPPORTED &&
+	antialias != CAIRO_ANTIALIAS_NONE)
+    {
+	double line_width;
+
+	if (_cairo_stroke_is_hairline (style, ctm, &line_width)) {
+	    status = composite_hairline (compositor, extents, path,
+					 style->line_cap, line_width,
+					 tolerance, antialias);
+	}
+    }
+
+    if (status == CAIRO_INT_STATUS_UNSUPPORTED) {
+	status = composite_cached_coverage (compositor, extents, path,
+					    CAIRO_FILL_RULE_WINDING,
+					    style, ctm, ctm_inverse,
+					    tolerance, antialias);
+    }
+
     if (status == CAIRO_INT_STATUS_UNSUPPORTED) {
 	cairo_polygon_t polygon;
 	cairo_fill_rule_t fill_rule = CAIRO_FILL_RULE_WINDING;
@@ -1094,6 +1992,11 @@ _cairo_spans_compositor_fill (const cairo_compositor_t		*_compositor,
 	    status = clip_and_composite_boxes (compositor, extents, &boxes);
 	_cairo_boxes_fini (&boxes);
     }
+    if (status == CAIRO_INT_STATUS_UNSUPPORTED) {
+	status = composite_cached_coverage (compositor, extents, path,
+					    fill_rule, NULL, NULL, NULL,
+					    tolerance, antialias);
+    }
     if (status == CAIRO_INT_STATUS_UNSUPPORTED) {
 	cairo_polygon_t polygon;
 
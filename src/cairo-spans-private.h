@@ -105,6 +105,17 @@ cairo_private cairo_status_t
 _cairo_tor22_scan_converter_add_polygon (void		*converter,
 					 const cairo_polygon_t *polygon);
 
+cairo_private cairo_scan_converter_t *
+_cairo_area_scan_converter_create (int			xmin,
+				   int			ymin,
+				   int			xmax,
+				   int			ymax,
+				   cairo_fill_rule_t	fill_rule,
+				   cairo_antialias_t	antialias);
+cairo_private cairo_status_t
+_cairo_area_scan_converter_add_polygon (void		*converter,
+					const cairo_polygon_t *polygon);
+
 cairo_private cairo_scan_converter_t *
 _cairo_mono_scan_converter_create (int			xmin,
 				   int			ymin,
@@ -115,6 +126,30 @@ cairo_private cairo_status_t
 _cairo_mono_scan_converter_add_polygon (void		*converter,
 					const cairo_polygon_t *polygon);
 
+cairo_private cairo_int_status_t
+_cairo_scan_converter_create_for_polygon (const cairo_rectangle_int_t	*r,
+					  cairo_polygon_t		*polygon,
+					  cairo_fill_rule_t		 fill_rule,
+					  cairo_antialias_t		 antialias,
+					  cairo_scan_converter_t	**out);
+
+cairo_private cairo_bool_t
+_cairo_stroke_is_hairline (const cairo_stroke_style_t	*style,
+			   const cairo_matrix_t		*ctm,
+			   double			*line_width);
+
+cairo_private cairo_scan_converter_t *
+_cairo_hairline_scan_converter_create (int			xmin,
+				       int			ymin,
+				       int			xmax,
+				       int			ymax,
+				       double			line_width,
+				       cairo_line_cap_t		line_cap);
+cairo_private cairo_status_t
+_cairo_hairline_scan_converter_add_path (void			 *converter,
+					 const cairo_path_fixed_t *path,
+					 double			  tolerance);
+
 cairo_private cairo_scan_converter_t *
 _cairo_clip_tor_scan_converter_create (cairo_clip_t *clip,
 				       cairo_polygon_t *polygon,
@@ -256,22 +256,380 @@ _cairo_spline_decompose_into (cairo_spline_knots_t *s1,
     return _cairo_spline_decompose_into (&s2, tolerance_squared, result);
 }
 
+/* Adaptive forward differencing.
+ *
+ * Rather than bisecting the control polygon until each piece is flat
+ * enough, we step along the curve adding the differences of the cubic
+ * polynomial, halving the step where it bends and doubling it again
+ * where it straightens out. The control points of each step follow
+ * from the differences, and are held to the same tolerance as the
+ * pieces of the subdivision.
+ *
+ * The chord of a step of h strays no further than max|P''|h²/8 from
+ * the curve, which estimates the number of segments up front: huge
+ * curves at fine tolerances would accumulate too much rounding error
+ * in the differences, so those are still subdivided recursively.
+ */
+#define SPLINE_MAX_LEVEL 10
+#define SPLINE_MAX_SEGMENTS (1 << SPLINE_MAX_LEVEL)
+
+typedef struct _cairo_spline_fd {
+    double f, df, ddf, dddf;
+} cairo_spline_fd_t;
+
+typedef struct _cairo_spline_stepper {
+    cairo_spline_fd_t x, y;
+    cairo_spline_fd_t tx, ty;
+    cairo_bool_t has_tangent;
+
+    double tolerance_squared;
+    int pos, step;
+} cairo_spline_stepper_t;
+
+static void
+_cairo_spline_knots_to_double (const cairo_point_t *a, const cairo_point_t *b,
+			       const cairo_point_t *c, const cairo_point_t *d,
+			       double x[4], double y[4])
+{
+    x[0] = _cairo_fixed_to_double (a->x);
+    y[0] = _cairo_fixed_to_double (a->y);
+    x[1] = _cairo_fixed_to_double (b->x);
+    y[1] = _cairo_fixed_to_double (b->y);
+    x[2] = _cairo_fixed_to_double (c->x);
+    y[2] = _cairo_fixed_to_double (c->y);
+    x[3] = _cairo_fixed_to_double (d->x);
+    y[3] = _cairo_fixed_to_double (d->y);
+}
+
+/* Returns FALSE if the spline needs too many segments to step through */
+static cairo_bool_t
+_cairo_spline_is_steppable (const double x[4], const double y[4],
+			    double tolerance)
+{
+    double dx, dy, d1, d2;
+
+    dx = x[0] - 2 * x[1] + x[2];
+    dy = y[0] - 2 * y[1] + y[2];
+    d1 = dx * dx + dy * dy;
+
+    dx = x[1] - 2 * x[2] + x[3];
+    dy = y[1] - 2 * y[2] + y[3];
+    d2 = dx * dx + dy * dy;
+
+    if (d2 > d1)
+	d1 = d2;
+
+    /* |P''| <= 6 max|Δ²|, so n² >= 3 max|Δ²| / 4 tolerance */
+    return .75 * sqrt (d1) <=
+	tolerance * SPLINE_MAX_SEGMENTS * SPLINE_MAX_SEGMENTS;
+}
+
+/* The differences of the position for a single step over the curve */
+static void
+_cairo_spline_fd_init (cairo_spline_fd_t *fd, const double p[4])
+{
+    double a = p[3] - p[0] + 3 * (p[1] - p[2]);
+    double b = 3 * (p[0] - 2 * p[1] + p[2]);
+    double c = 3 * (p[1] - p[0]);
+
+    fd->f = p[0];
+    fd->df = a + b + c;
+    fd->ddf = 6 * a + 2 * b;
+    fd->dddf = 6 * a;
+}
+
+/* ... and of the tangent, a third of the derivative */
+static void
+_cairo_spline_fd_init_tangent (cairo_spline_fd_t *fd, const double p[4])
+{
+    double a = p[3] - p[0] + 3 * (p[1] - p[2]);
+    double b = 2 * (p[0] - 2 * p[1] + p[2]);
+    double c = p[1] - p[0];
+
+    fd->f = c;
+    fd->df = a + b;
+    fd->ddf = 2 * a;
+    fd->dddf = 0;
+}
+
+static inline void
+_cairo_spline_fd_halve (cairo_spline_fd_t *fd)
+{
+    fd->dddf *= .125;
+    fd->ddf = fd->ddf * .25 - fd->dddf;
+    fd->df = (fd->df - fd->ddf) * .5;
+}
+
+static inline void
+_cairo_spline_fd_double (cairo_spline_fd_t *fd)
+{
+    fd->df = 2 * fd->df + fd->ddf;
+    fd->ddf = 4 * (fd->ddf + fd->dddf);
+    fd->dddf *= 8;
+}
+
+static inline void
+_cairo_spline_fd_step (cairo_spline_fd_t *fd)
+{
+    fd->f += fd->df;
+    fd->df += fd->ddf;
+    fd->ddf += fd->dddf;
+}
+
+static void
+_cairo_spline_stepper_init (cairo_spline_stepper_t *stepper,
+			    const double x[4], const double y[4],
+			    double tolerance,
+			    cairo_bool_t has_tangent)
+{
+    _cairo_spline_fd_init (&stepper->x, x);
+    _cairo_spline_fd_init (&stepper->y, y);
+
+    stepper->has_tangent = has_tangent;
+    if (has_tangent) {
+	_cairo_spline_fd_init_tangent (&stepper->tx, x);
+	_cairo_spline_fd_init_tangent (&stepper->ty, y);
+    }
+
+    stepper->tolerance_squared = tolerance * tolerance;
+    stepper->pos = 0;
+    stepper->step = SPLINE_MAX_SEGMENTS;
+}
+
+static inline double
+_cairo_spline_distance_squared (double px, double py,
+				double dx, double dy, double v)
+{
+    double u = px * dx + py * dy;
+
+    if (u >= v) {
+	px -= dx;
+	py -= dy;
+    } else if (u > 0) {
+	px -= u / v * dx;
+	py -= u / v * dy;
+    }
+
+    return px * px + py * py;
+}
+
+/* Is the next step flat? Like _cairo_spline_error_squared() but with the
+ * control points of the step, relative to its start, given by
+ *
+ *   b = (Δ - Δ²/2 + Δ³/3) / 3
+ *   c = Δ - (Δ + Δ²/2 - Δ³/6) / 3
+ */
+static inline cairo_bool_t
+_cairo_spline_fd_is_flat (const cairo_spline_fd_t *x,
+			  const cairo_spline_fd_t *y,
+			  double tolerance_squared)
+{
+    double bx = (x->df - x->ddf / 2 + x->dddf / 3) / 3;
+    double by = (y->df - y->ddf / 2 + y->dddf / 3) / 3;
+    double cx = x->df - (x->df + x->ddf / 2 - x->dddf / 6) / 3;
+    double cy = y->df - (y->df + y->ddf / 2 - y->dddf / 6) / 3;
+    double v = x->df * x->df + y->df * y->df;
+
+    if (v == 0) {
+	return bx * bx + by * by < tolerance_squared &&
+	       cx * cx + cy * cy < tolerance_squared;
+    }
+
+    return
+	_cairo_spline_distance_squared (bx, by, x->df, y->df, v) < tolerance_squared &&
+	_cairo_spline_distance_squared (cx, cy, x->df, y->df, v) < tolerance_squared;
+}
+
+static void
+_cairo_spline_stepper_halve (cairo_spline_stepper_t *stepper)
+{
+    _cairo_spline_fd_halve (&stepper->x);
+    _cairo_spline_fd_halve (&stepper->y);
+    if (stepper->has_tangent) {
+	_cairo_spline_fd_halve (&stepper->tx);
+	_cairo_spline_fd_halve (&stepper->ty);
+    }
+    stepper->step >>= 1;
+}
+
+static void
+_cairo_spline_stepper_double (cairo_spline_stepper_t *stepper)
+{
+    _cairo_spline_fd_double (&stepper->x);
+    _cairo_spline_fd_double (&stepper->y);
+    if (stepper->has_tangent) {
+	_cairo_spline_fd_double (&stepper->tx);
+	_cairo_spline_fd_double (&stepper->ty);
+    }
+    stepper->step <<= 1;
+}
+
+/* Advances to the next vertex, returning FALSE upon reaching the end
+ * of the curve, which is left for the caller to add exactly. */
+static cairo_bool_t
+_cairo_spline_stepper_next (cairo_spline_stepper_t *stepper,
+			    cairo_point_t *point)
+{
+    /* the doubled step must remain aligned to finish upon the end */
+    while (stepper->step < SPLINE_MAX_SEGMENTS &&
+	   (stepper->pos & (2 * stepper->step - 1)) == 0)
+    {
+	cairo_spline_fd_t x = stepper->x, y = stepper->y;
+
+	_cairo_spline_fd_double (&x);
+	_cairo_spline_fd_double (&y);
+	if (! _cairo_spline_fd_is_flat (&x, &y, stepper->tolerance_squared))
+	    break;
+
+	_cairo_spline_stepper_double (stepper);
+    }
+
+    while (stepper->step > 1 &&
+	   ! _cairo_spline_fd_is_flat (&stepper->x, &stepper->y,
+				       stepper->tolerance_squared))
+    {
+	_cairo_spline_stepper_halve (stepper);
+    }
+
+    stepper->pos += stepper->step;
+    if (stepper->pos >= SPLINE_MAX_SEGMENTS)
+	return FALSE;
+
+    _cairo_spline_fd_step (&stepper->x);
+    _cairo_spline_fd_step (&stepper->y);
+    if (stepper->has_tangent) {
+	_cairo_spline_fd_step (&stepper->tx);
+	_cairo_spline_fd_step (&stepper->ty);
+    }
+
+    point->x = _cairo_fixed_from_double (stepper->x.f);
+    point->y = _cairo_fixed_from_double (stepper->y.f);
+    return TRUE;
+}
+
+static void
+_cairo_spline_stepper_get_slope (const cairo_spline_stepper_t *stepper,
+				 cairo_slope_t *slope)
+{
+    double dx = stepper->tx.f, dy = stepper->ty.f, scale;
+
+    /* at a cusp, follow the curve on to the next vertex instead */
+    scale = MAX (fabs (dx), fabs (dy));
+    if (scale < CAIRO_FIXED_ERROR_DOUBLE) {
+	dx = stepper->x.df;
+	dy = stepper->y.df;
+	scale = MAX (fabs (dx), fabs (dy));
+    }
+
+    /* only the direction matters, so keep clear of overflow */
+    if (scale > 1 << 16) {
+	dx *= (1 << 16) / scale;
+	dy *= (1 << 16) / scale;
+    }
+
+    slope->dx = _cairo_fixed_from_double (dx);
+    slope->dy = _cairo_fixed_from_double (dy);
+}
+
 cairo_status_t
 _cairo_spline_decompose (cairo_spline_t *spline, double tolerance)
 {
-    cairo_spline_knots_t s1;
+    cairo_spline_stepper_t stepper;
+    cairo_point_t point;
+    double x[4], y[4];
     cairo_status_t status;
 
-    s1 = spline->knots;
-    spline->last_point = s1.a;
-    status = _cairo_spline_decompose_into (&s1, tolerance * tolerance, spline);
-    if (unlikely (status))
-	return status;
+    _cairo_spline_knots_to_double (&spline->knots.a, &spline->knots.b,
+				   &spline->knots.c, &spline->knots.d,
+				   x, y);
+    spline->last_point = spline->knots.a;
+
+    if (! _cairo_spline_is_steppable (x, y, tolerance)) {
+	cairo_spline_knots_t s1;
+
+	s1 = spline->knots;
+	status = _cairo_spline_decompose_into (&s1, tolerance * tolerance, spline);
+	if (unlikely (status))
+	    return status;
+
+	return spline->add_point_func (spline->closure,
+				       &spline->knots.d, &spline->final_slope);
+    }
+
+    _cairo_spline_stepper_init (&stepper, x, y, tolerance, TRUE);
+    while (_cairo_spline_stepper_next (&stepper, &point)) {
+	cairo_slope_t slope;
+
+	if (point.x == spline->last_point.x && point.y == spline->last_point.y)
+	    continue;
+
+	_cairo_spline_stepper_get_slope (&stepper, &slope);
+
+	spline->last_point = point;
+	status = spline->add_point_func (spline->closure, &point, &slope);
+	if (unlikely (status))
+	    return status;
+    }
 
     return spline->add_point_func (spline->closure,
 				   &spline->knots.d, &spline->final_slope);
 }
 
+/**
+ * _cairo_spline_flatten:
+ * @a: the start point of the spline
+ * @b: the first control point
+ * @c: the second control point
+ * @d: the end point
+ * @tolerance: the greatest distance allowed from the curve
+ * @points: return location for the vertices of the polyline
+ * @max_points: the length of @points
+ *
+ * Approximates the spline with a polyline in a single pass, without the
+ * tangents that _cairo_spline_decompose() computes for stroking. The
+ * vertices following @a, ending with @d, are stored in @points.
+ *
+ * Return value: the number of vertices stored, or 0 if the spline
+ * needs more than @max_points and must be decomposed instead.
+ **/
+int
+_cairo_spline_flatten (const cairo_point_t *a, const cairo_point_t *b,
+		       const cairo_point_t *c, const cairo_point_t *d,
+		       double tolerance,
+		       cairo_point_t *points, int max_points)
+{
+    cairo_spline_stepper_t stepper;
+    cairo_point_t point, last;
+    double x[4], y[4];
+    int num_points;
+
+    /* If both tangents are zero, this is just a straight line */
+    if (a->x == b->x && a->y == b->y && c->x == d->x && c->y == d->y) {
+	points[0] = *d;
+	return 1;
+    }
+
+    _cairo_spline_knots_to_double (a, b, c, d, x, y);
+    if (! _cairo_spline_is_steppable (x, y, tolerance))
+	return 0;
+
+    num_points = 0;
+    last = *a;
+    _cairo_spline_stepper_init (&stepper, x, y, tolerance, FALSE);
+    while (_cairo_spline_stepper_next (&stepper, &point)) {
+	if (point.x == last.x && point.y == last.y)
+	    continue;
+
+	if (num_points == max_points - 1)
+	    return 0;
+
+	points[num_points++] = last = point;
+    }
+    points[num_points++] = *d;
+
+    return num_points;
+}
+
 /* Note: this function is only good for computing bounds in device space. */
 cairo_status_t
 _cairo_spline_bound (cairo_spline_add_point_func_t add_point_func,
@@ -53,6 +53,9 @@ typedef struct _cairo_stroker_dash {
     double dash_offset;
     const double *dashes;
     unsigned int num_dashes;
+
+    /* the length after which the pattern, and its phase, repeats */
+    double period;
 } cairo_stroker_dash_t;
 
 cairo_private void
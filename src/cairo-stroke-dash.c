@@ -84,6 +84,8 @@ void
 _cairo_stroker_dash_init (cairo_stroker_dash_t *dash,
 			  const cairo_stroke_style_t *style)
 {
+    unsigned int i;
+
     dash->dashed = style->dash != NULL;
     if (! dash->dashed)
 	return;
@@ -92,5 +94,12 @@ _cairo_stroker_dash_init (cairo_stroker_dash_t *dash,
     dash->num_dashes = style->num_dashes;
     dash->dash_offset = style->dash_offset;
 
+    /* an odd number of dashes alternate between on and off */
+    dash->period = 0;
+    for (i = 0; i < dash->num_dashes; i++)
+	dash->period += dash->dashes[i];
+    if (dash->num_dashes & 1)
+	dash->period *= 2;
+
     _cairo_stroker_dash_start (dash);
 }
@@ -0,0 +1,65 @@
+/* cairo - a vector graphics library with display and print output
+ *
+ * Copyright © 2012 Samsung Electronics
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it either under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * (the "LGPL") or, at your option, under the terms of the Mozilla
+ * Public License Version 1.1 (the "MPL"). If you do not alter this
+ * notice, a recipient may use your version of this file under either
+ * the MPL or the LGPL.
+ *
+ * You should have received a copy of the LGPL along with this library
+ * in the file COPYING-LGPL-2.1; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA 02110-1335, USA
+ * You should have received a copy of the MPL along with this library
+ * in the file COPYING-MPL-1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License
+ * Version 1.1 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY
+ * OF ANY KIND, either express or implied. See the LGPL or the MPL for
+ * the specific language governing rights and limitations.
+ *
+ * The Original Code is the cairo graphics library.
+ *
+ * The Initial Developer of the Original Code is Samsung Electronics.
+ */
+
+#ifndef CAIRO_THREAD_POOL_PRIVATE_H
+#define CAIRO_THREAD_POOL_PRIVATE_H
+
+#include "cairo-compiler-private.h"
+
+CAIRO_BEGIN_DECLS
+
+/* A small pool of persistent worker threads used to spread independent
+ * pieces of rendering work across cores.
+ *
+ * The pool is opt-in: it is only enabled when the CAIRO_RENDER_THREADS
+ * environment variable requests more than one thread, and it requires a
+ * real pthread implementation. Otherwise, and whenever the pool is
+ * already busy on behalf of another thread, the work is simply run
+ * serially by the caller.
+ */
+
+typedef void (*cairo_thread_pool_func_t) (void *closure, int index);
+
+cairo_private int
+_cairo_thread_pool_get_num_threads (void);
+
+cairo_private void
+_cairo_thread_pool_run (cairo_thread_pool_func_t func,
+			void *closure,
+			int count);
+
+cairo_private void
+_cairo_thread_pool_reset_static_data (void);
+
+CAIRO_END_DECLS
+
+#endif /* CAIRO_THREAD_POOL_PRIVATE_H */
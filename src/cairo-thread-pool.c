@@ -0,0 +1,235 @@
+/* cairo - a vector graphics library with display and print output
+ *
+ * Copyright © 2012 Samsung Electronics
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it either under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * (the "LGPL") or, at your option, under the terms of the Mozilla
+ * Public License Version 1.1 (the "MPL"). If you do not alter this
+ * notice, a recipient may use your version of this file under either
+ * the MPL or the LGPL.
+ *
+ * You should have received a copy of the LGPL along with this library
+ * in the file COPYING-LGPL-2.1; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA 02110-1335, USA
+ * You should have received a copy of the MPL along with this library
+ * in the file COPYING-MPL-1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License
+ * Version 1.1 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY
+ * OF ANY KIND, either express or implied. See the LGPL or the MPL for
+ * the specific language governing rights and limitations.
+ *
+ * The Original Code is the cairo graphics library.
+ *
+ * The Initial Developer of the Original Code is Samsung Electronics.
+ */
+
+#include "cairoint.h"
+
+#include "cairo-thread-pool-private.h"
+
+#include <stdlib.h>
+
+#if CAIRO_HAS_REAL_PTHREAD
+#include <pthread.h>
+
+#define MAX_THREADS 16
+
+static struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+
+    pthread_t threads[MAX_THREADS - 1];
+    int num_workers;
+    cairo_bool_t shutdown;
+
+    /* the current job */
+    unsigned int generation;
+    cairo_thread_pool_func_t func;
+    void *closure;
+    int count;
+    int next;
+    int pending;
+} pool = {
+    PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_COND_INITIALIZER,
+    PTHREAD_COND_INITIALIZER,
+};
+
+/* Only a single job may be in flight; held by the submitting thread */
+static pthread_mutex_t pool_busy = PTHREAD_MUTEX_INITIALIZER;
+
+/* -1 until the environment has been consulted */
+static int pool_num_threads = -1;
+
+/* Called with pool.mutex held, drops it whilst running each task */
+static void
+_cairo_thread_pool_run_tasks (void)
+{
+    while (pool.next < pool.count) {
+	int index = pool.next++;
+
+	pthread_mutex_unlock (&pool.mutex);
+	pool.func (pool.closure, index);
+	pthread_mutex_lock (&pool.mutex);
+
+	if (--pool.pending == 0)
+	    pthread_cond_broadcast (&pool.done);
+    }
+}
+
+static void *
+_cairo_thread_pool_worker (void *arg)
+{
+    unsigned int seen = 0;
+
+    pthread_mutex_lock (&pool.mutex);
+    for (;;) {
+	while (! pool.shutdown && pool.generation == seen)
+	    pthread_cond_wait (&pool.wake, &pool.mutex);
+	if (pool.shutdown)
+	    break;
+
+	seen = pool.generation;
+	_cairo_thread_pool_run_tasks ();
+    }
+    pthread_mutex_unlock (&pool.mutex);
+
+    return NULL;
+}
+
+int
+_cairo_thread_pool_get_num_threads (void)
+{
+    if (unlikely (pool_num_threads < 0)) {
+	const char *env;
+	int n = 1;
+
+	env = getenv ("CAIRO_RENDER_THREADS");
+	if (env != NULL)
+	    n = atoi (env);
+	if (n < 1)
+	    n = 1;
+	if (n > MAX_THREADS)
+	    n = MAX_THREADS;
+
+	pool_num_threads = n;
+    }
+
+    return pool_num_threads;
+}
+
+/* Called with pool.mutex held */
+static cairo_bool_t
+_cairo_thread_pool_start_workers (void)
+{
+    int n = _cairo_thread_pool_get_num_threads () - 1;
+
+    while (pool.num_workers < n) {
+	if (pthread_create (&pool.threads[pool.num_workers], NULL,
+			    _cairo_thread_pool_worker, NULL))
+	    break;
+
+	pool.num_workers++;
+    }
+
+    return pool.num_workers > 0;
+}
+
+void
+_cairo_thread_pool_run (cairo_thread_pool_func_t func,
+			void *closure,
+			int count)
+{
+    int i;
+
+    if (count > 1 &&
+	_cairo_thread_pool_get_num_threads () > 1 &&
+	pthread_mutex_trylock (&pool_busy) == 0)
+    {
+	cairo_bool_t started;
+
+	pthread_mutex_lock (&pool.mutex);
+	started = _cairo_thread_pool_start_workers ();
+	if (started) {
+	    pool.func = func;
+	    pool.closure = closure;
+	    pool.count = count;
+	    pool.next = 0;
+	    pool.pending = count;
+	    pool.generation++;
+	    pthread_cond_broadcast (&pool.wake);
+
+	    /* the submitting thread works too */
+	    _cairo_thread_pool_run_tasks ();
+	    while (pool.pending)
+		pthread_cond_wait (&pool.done, &pool.mutex);
+
+	    pool.func = NULL;
+	    pool.closure = NULL;
+	}
+	pthread_mutex_unlock (&pool.mutex);
+	pthread_mutex_unlock (&pool_busy);
+
+	if (started)
+	    return;
+    }
+
+    for (i = 0; i < count; i++)
+	func (closure, i);
+}
+
+void
+_cairo_thread_pool_reset_static_data (void)
+{
+    int i;
+
+    pthread_mutex_lock (&pool_busy);
+
+    pthread_mutex_lock (&pool.mutex);
+    pool.shutdown = TRUE;
+    pthread_cond_broadcast (&pool.wake);
+    pthread_mutex_unlock (&pool.mutex);
+
+    for (i = 0; i < pool.num_workers; i++)
+	pthread_join (pool.threads[i], NULL);
+
+    pool.num_workers = 0;
+    pool.shutdown = FALSE;
+    pool_num_threads = -1;
+
+    pthread_mutex_unlock (&pool_busy);
+}
+
+#else /* ! CAIRO_HAS_REAL_PTHREAD */
+
+int
+_cairo_thread_pool_get_num_threads (void)
+{
+    return 1;
+}
+
+void
+_cairo_thread_pool_run (cairo_thread_pool_func_t func,
+			void *closure,
+			int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+	func (closure, i);
+}
+
+void
+_cairo_thread_pool_reset_static_data (void)
+{
+}
+
+#endif
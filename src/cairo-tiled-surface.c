@@ -0,0 +1,1173 @@
+/* cairo - a vector graphics library with display and print output
+ *
+ * Copyright © 2012 Samsung Electronics
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it either under the terms of the GNU Lesser General Public
+ * License version 2.1 as published by the Free Software Foundation
+ * (the "LGPL") or, at your option, under the terms of the Mozilla
+ * Public License Version 1.1 (the "MPL"). If you do not alter this
+ * notice, a recipient may use your version of this file under either
+ * the MPL or the LGPL.
+ *
+ * You should have received a copy of the LGPL along with this library
+ * in the file COPYING-LGPL-2.1; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA 02110-1335, USA
+ * You should have received a copy of the MPL along with this library
+ * in the file COPYING-MPL-1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License
+ * Version 1.1 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY
+ * OF ANY KIND, either express or implied. See the LGPL or the MPL for
+ * the specific language governing rights and limitations.
+ *
+ * The Original Code is the cairo graphics library.
+ *
+ * The Initial Developer of the Original Code is Samsung Electronics.
+ */
+
+/* An image surface whose pixels are stored in fixed size tiles rather
+ * than in one linear buffer.
+ *
+ * Each tile is an ordinary image surface, so rendering is handed to the
+ * image compositor for every tile the operation reaches, translated
+ * into the tile and clipped to it. A column or a rotated blit then only
+ * walks the few rows of each tile, and the tiles are the natural unit
+ * of work for later parallelisation. Fills and strokes are rasterised
+ * just once, into a coverage mask per tile, and glyphs are sorted into
+ * the tiles they overlap, so that only the tiles actually drawn on are
+ * visited.
+ *
+ * Tiles are allocated on first write, so untouched areas of a large
+ * canvas cost nothing, and they are shared between the surface and its
+ * snapshots and copied only when written to.
+ */
+
+#include "cairoint.h"
+
+#include "cairo-clip-inline.h"
+#include "cairo-clip-private.h"
+#include "cairo-composite-rectangles-private.h"
+#include "cairo-boxes-private.h"
+#include "cairo-default-context-private.h"
+#include "cairo-error-private.h"
+#include "cairo-image-surface-private.h"
+#include "cairo-path-fixed-private.h"
+#include "cairo-spans-private.h"
+#include "cairo-surface-wrapper-private.h"
+
+#define TILE_SIZE 64
+
+typedef struct _cairo_tiled_surface {
+    cairo_surface_t base;
+
+    cairo_format_t format;
+    pixman_format_code_t pixman_format;
+    int width, height;
+
+    int num_cols, num_rows;
+    cairo_image_surface_t **tiles;
+} cairo_tiled_surface_t;
+
+static cairo_surface_t *
+_cairo_tiled_surface_create_internal (cairo_format_t format,
+				      int width, int height);
+
+static void
+_cairo_tiled_surface_tile_extents (cairo_tiled_surface_t *surface,
+				   int col, int row,
+				   cairo_rectangle_int_t *extents)
+{
+    extents->x = col * TILE_SIZE;
+    extents->y = row * TILE_SIZE;
+    extents->width  = MIN (TILE_SIZE, surface->width  - extents->x);
+    extents->height = MIN (TILE_SIZE, surface->height - extents->y);
+}
+
+/* Returns the tile ready to be written to, allocating it if it has
+ * never been touched and copying it if it is shared with a snapshot.
+ */
+static cairo_status_t
+_cairo_tiled_surface_get_tile_for_write (cairo_tiled_surface_t *surface,
+					 int col, int row,
+					 cairo_image_surface_t **tile_out)
+{
+    cairo_image_surface_t **tile, *copy;
+    cairo_rectangle_int_t extents;
+
+    tile = &surface->tiles[row * surface->num_cols + col];
+    if (*tile != NULL &&
+	CAIRO_REFERENCE_COUNT_GET_VALUE (&(*tile)->base.ref_count) == 1)
+    {
+	*tile_out = *tile;
+	return CAIRO_STATUS_SUCCESS;
+    }
+
+    _cairo_tiled_surface_tile_extents (surface, col, row, &extents);
+    copy = (cairo_image_surface_t *)
+	_cairo_image_surface_create_with_pixman_format (NULL,
+							surface->pixman_format,
+							extents.width,
+							extents.height,
+							0);
+    if (unlikely (copy->base.status)) {
+	cairo_status_t status = copy->base.status;
+	cairo_surface_destroy (&copy->base);
+	return status;
+    }
+
+    if (*tile != NULL) {
+	memcpy (copy->data, (*tile)->data, (*tile)->stride * extents.height);
+	copy->base.is_clear = (*tile)->base.is_clear;
+	cairo_surface_destroy (&(*tile)->base);
+    }
+
+    *tile = copy;
+    *tile_out = copy;
+    return CAIRO_STATUS_SUCCESS;
+}
+
+/* Copies the pixels shared by @image and the tiles between them. The
+ * image is positioned on the surface by its device offset, as it is
+ * for cairo_surface_map_to_image().
+ */
+static cairo_status_t
+_cairo_tiled_surface_copy (cairo_tiled_surface_t *surface,
+			   cairo_image_surface_t *image,
+			   cairo_bool_t upload)
+{
+    cairo_rectangle_int_t extents;
+    int col, row;
+
+    extents.x = image->base.device_transform_inverse.x0;
+    extents.y = image->base.device_transform_inverse.y0;
+    extents.width  = image->width;
+    extents.height = image->height;
+
+    for (row = extents.y / TILE_SIZE;
+	 row <= (extents.y + extents.height - 1) / TILE_SIZE;
+	 row++)
+    {
+	for (col = extents.x / TILE_SIZE;
+	     col <= (extents.x + extents.width - 1) / TILE_SIZE;
+	     col++)
+	{
+	    cairo_image_surface_t *tile;
+	    cairo_rectangle_int_t r;
+
+	    _cairo_tiled_surface_tile_extents (surface, col, row, &r);
+	    if (! _cairo_rectangle_intersect (&r, &extents))
+		continue;
+
+	    if (upload) {
+		cairo_status_t status;
+
+		status = _cairo_tiled_surface_get_tile_for_write (surface,
+								  col, row,
+								  &tile);
+		if (unlikely (status))
+		    return status;
+
+		pixman_image_composite32 (PIXMAN_OP_SRC,
+					  image->pixman_image, NULL,
+					  tile->pixman_image,
+					  r.x - extents.x, r.y - extents.y,
+					  0, 0,
+					  r.x - col * TILE_SIZE,
+					  r.y - row * TILE_SIZE,
+					  r.width, r.height);
+		tile->base.is_clear = FALSE;
+	    } else {
+		/* an untouched tile is clear, as is the fresh image */
+		tile = surface->tiles[row * surface->num_cols + col];
+		if (tile == NULL)
+		    continue;
+
+		pixman_image_composite32 (PIXMAN_OP_SRC,
+					  tile->pixman_image, NULL,
+					  image->pixman_image,
+					  r.x - col * TILE_SIZE,
+					  r.y - row * TILE_SIZE,
+					  0, 0,
+					  r.x - extents.x, r.y - extents.y,
+					  r.width, r.height);
+	    }
+	}
+    }
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_image_surface_t *
+_cairo_tiled_surface_linearize (cairo_tiled_surface_t *surface,
+				const cairo_rectangle_int_t *extents)
+{
+    cairo_image_surface_t *image;
+    cairo_status_t status;
+
+    image = (cairo_image_surface_t *)
+	_cairo_image_surface_create_with_pixman_format (NULL,
+							surface->pixman_format,
+							extents->width,
+							extents->height,
+							0);
+    if (unlikely (image->base.status))
+	return image;
+
+    cairo_surface_set_device_offset (&image->base, -extents->x, -extents->y);
+
+    status = _cairo_tiled_surface_copy (surface, image, FALSE);
+    if (unlikely (status)) {
+	cairo_surface_destroy (&image->base);
+	return (cairo_image_surface_t *) _cairo_surface_create_in_error (status);
+    }
+
+    return image;
+}
+
+static cairo_status_t
+_cairo_tiled_surface_finish (void *abstract_surface)
+{
+    cairo_tiled_surface_t *surface = abstract_surface;
+    int n;
+
+    for (n = 0; n < surface->num_cols * surface->num_rows; n++) {
+	if (surface->tiles[n] != NULL)
+	    cairo_surface_destroy (&surface->tiles[n]->base);
+    }
+    free (surface->tiles);
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_surface_t *
+_cairo_tiled_surface_create_similar (void		*abstract_other,
+				     cairo_content_t	 content,
+				     int		 width,
+				     int		 height)
+{
+    return _cairo_tiled_surface_create_internal (_cairo_format_from_content (content),
+						 width, height);
+}
+
+static cairo_surface_t *
+_cairo_tiled_surface_map_to_image (void				*abstract_surface,
+				   const cairo_rectangle_int_t	*extents)
+{
+    cairo_tiled_surface_t *surface = abstract_surface;
+
+    /* only the tiles underneath the extents are copied */
+    return &_cairo_tiled_surface_linearize (surface, extents)->base;
+}
+
+static cairo_int_status_t
+_cairo_tiled_surface_unmap_image (void			*abstract_surface,
+				  cairo_image_surface_t	*image)
+{
+    cairo_tiled_surface_t *surface = abstract_surface;
+
+    _cairo_surface_begin_modification (&surface->base);
+    return _cairo_tiled_surface_copy (surface, image, TRUE);
+}
+
+static cairo_status_t
+_cairo_tiled_surface_acquire_source_image (void			 *abstract_surface,
+					   cairo_image_surface_t **image_out,
+					   void			**image_extra)
+{
+    cairo_tiled_surface_t *surface = abstract_surface;
+    cairo_image_surface_t *image;
+    cairo_rectangle_int_t extents;
+
+    /* Keep the linear copy around for as long as the surface is left
+     * unmodified, so that repeated use as a source is cheap.
+     */
+    image = (cairo_image_surface_t *)
+	_cairo_surface_has_snapshot (&surface->base,
+				     &_cairo_image_surface_backend);
+    if (image != NULL) {
+	*image_out = (cairo_image_surface_t *) cairo_surface_reference (&image->base);
+	*image_extra = NULL;
+	return CAIRO_STATUS_SUCCESS;
+    }
+
+    extents.x = extents.y = 0;
+    extents.width  = surface->width;
+    extents.height = surface->height;
+    image = _cairo_tiled_surface_linearize (surface, &extents);
+    if (unlikely (image->base.status))
+	return image->base.status;
+
+    _cairo_surface_attach_snapshot (&surface->base, &image->base, NULL);
+
+    *image_out = image;
+    *image_extra = NULL;
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static void
+_cairo_tiled_surface_release_source_image (void			*abstract_surface,
+					   cairo_image_surface_t	*image,
+					   void				*image_extra)
+{
+    cairo_surface_destroy (&image->base);
+}
+
+static cairo_surface_t *
+_cairo_tiled_surface_snapshot (void *abstract_surface)
+{
+    cairo_tiled_surface_t *surface = abstract_surface;
+    cairo_tiled_surface_t *clone;
+    int n;
+
+    clone = (cairo_tiled_surface_t *)
+	_cairo_tiled_surface_create_internal (surface->format,
+					      surface->width,
+					      surface->height);
+    if (unlikely (clone->base.status))
+	return &clone->base;
+
+    /* Share the tiles, whoever writes to one next takes a copy */
+    for (n = 0; n < surface->num_cols * surface->num_rows; n++) {
+	if (surface->tiles[n] != NULL) {
+	    clone->tiles[n] = (cairo_image_surface_t *)
+		cairo_surface_reference (&surface->tiles[n]->base);
+	}
+    }
+
+    return &clone->base;
+}
+
+static cairo_bool_t
+_cairo_tiled_surface_get_extents (void			  *abstract_surface,
+				  cairo_rectangle_int_t   *rectangle)
+{
+    cairo_tiled_surface_t *surface = abstract_surface;
+
+    rectangle->x = 0;
+    rectangle->y = 0;
+    rectangle->width  = surface->width;
+    rectangle->height = surface->height;
+
+    return TRUE;
+}
+
+static void
+_cairo_tiled_surface_get_font_options (void                  *abstract_surface,
+				       cairo_font_options_t  *options)
+{
+    _cairo_font_options_init_default (options);
+
+    cairo_font_options_set_hint_metrics (options, CAIRO_HINT_METRICS_ON);
+    _cairo_font_options_set_round_glyph_positions (options, CAIRO_ROUND_GLYPH_POS_ON);
+}
+
+/* The coverage of a fill or stroke is rasterised once, by the scan
+ * converter the image compositor would choose, into an alpha mask for
+ * each tile that a span lands in. Tiles without a mask receive no
+ * coverage and so are neither allocated nor copied.
+ */
+typedef struct _cairo_tiled_coverage {
+    cairo_span_renderer_t base;
+
+    cairo_tiled_surface_t *surface;
+    int col, row, num_cols, num_rows;
+    cairo_image_surface_t **masks;
+} cairo_tiled_coverage_t;
+
+static cairo_image_surface_t *
+_cairo_tiled_coverage_get_mask (cairo_tiled_coverage_t *coverage,
+				int col, int row)
+{
+    cairo_image_surface_t **mask;
+    cairo_rectangle_int_t extents;
+
+    mask = &coverage->masks[(row - coverage->row) * coverage->num_cols +
+			    col - coverage->col];
+    if (*mask == NULL) {
+	_cairo_tiled_surface_tile_extents (coverage->surface, col, row,
+					   &extents);
+	*mask = (cairo_image_surface_t *)
+	    _cairo_image_surface_create_with_pixman_format (NULL, PIXMAN_a8,
+							    extents.width,
+							    extents.height,
+							    0);
+	if (unlikely ((*mask)->base.status)) {
+	    cairo_surface_destroy (&(*mask)->base);
+	    *mask = NULL;
+	    return NULL;
+	}
+
+	(*mask)->base.is_clear = FALSE;
+    }
+
+    return *mask;
+}
+
+static cairo_status_t
+_cairo_tiled_coverage_render_rows (void *abstract_renderer,
+				   int y, int height,
+				   const cairo_half_open_span_t *spans,
+				   unsigned num_spans)
+{
+    cairo_tiled_coverage_t *coverage = abstract_renderer;
+
+    if (num_spans == 0)
+	return CAIRO_STATUS_SUCCESS;
+
+    do {
+	if (spans[0].coverage) {
+	    int x = spans[0].x;
+
+	    while (x < spans[1].x) {
+		int col = x / TILE_SIZE;
+		int x_end = MIN (spans[1].x, (col + 1) * TILE_SIZE);
+		int yy = y;
+
+		while (yy < y + height) {
+		    int row = yy / TILE_SIZE;
+		    int y_end = MIN (y + height, (row + 1) * TILE_SIZE);
+		    cairo_image_surface_t *mask;
+
+		    mask = _cairo_tiled_coverage_get_mask (coverage, col, row);
+		    if (unlikely (mask == NULL))
+			return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+
+		    for (; yy < y_end; yy++) {
+			memset (mask->data +
+				(yy - row * TILE_SIZE) * mask->stride +
+				x - col * TILE_SIZE,
+				spans[0].coverage, x_end - x);
+		    }
+		}
+
+		x = x_end;
+	    }
+	}
+	spans++;
+    } while (--num_spans > 1);
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_status_t
+_cairo_tiled_coverage_init (cairo_tiled_coverage_t *coverage,
+			    cairo_tiled_surface_t *surface,
+			    const cairo_rectangle_int_t *extents)
+{
+    coverage->base.render_rows = _cairo_tiled_coverage_render_rows;
+    coverage->surface = surface;
+    coverage->col = extents->x / TILE_SIZE;
+    coverage->row = extents->y / TILE_SIZE;
+    coverage->num_cols =
+	(extents->x + extents->width - 1) / TILE_SIZE - coverage->col + 1;
+    coverage->num_rows =
+	(extents->y + extents->height - 1) / TILE_SIZE - coverage->row + 1;
+
+    coverage->masks = calloc (coverage->num_cols * coverage->num_rows,
+			      sizeof (cairo_image_surface_t *));
+    if (unlikely (coverage->masks == NULL))
+	return _cairo_error (CAIRO_STATUS_NO_MEMORY);
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static void
+_cairo_tiled_coverage_fini (cairo_tiled_coverage_t *coverage)
+{
+    int n;
+
+    for (n = 0; n < coverage->num_cols * coverage->num_rows; n++) {
+	if (coverage->masks[n] != NULL)
+	    cairo_surface_destroy (&coverage->masks[n]->base);
+    }
+    free (coverage->masks);
+}
+
+static cairo_status_t
+_cairo_tiled_coverage_add_boxes (cairo_tiled_coverage_t *coverage,
+				 const cairo_rectangle_int_t *extents,
+				 const cairo_boxes_t *boxes)
+{
+    cairo_rectangular_scan_converter_t converter;
+    const struct _cairo_boxes_chunk *chunk;
+    cairo_status_t status = CAIRO_STATUS_SUCCESS;
+    int i;
+
+    _cairo_rectangular_scan_converter_init (&converter, extents);
+    for (chunk = &boxes->chunks; chunk != NULL; chunk = chunk->next) {
+	for (i = 0; i < chunk->count; i++) {
+	    status = _cairo_rectangular_scan_converter_add_box (&converter,
+								&chunk->base[i],
+								1);
+	    if (unlikely (status))
+		goto cleanup;
+	}
+    }
+
+    status = converter.base.generate (&converter.base, &coverage->base);
+
+cleanup:
+    converter.base.destroy (&converter.base);
+    return status;
+}
+
+static cairo_status_t
+_cairo_tiled_coverage_add_polygon (cairo_tiled_coverage_t *coverage,
+				   const cairo_rectangle_int_t *extents,
+				   cairo_polygon_t *polygon,
+				   cairo_fill_rule_t fill_rule,
+				   cairo_antialias_t antialias)
+{
+    cairo_scan_converter_t *converter;
+    cairo_status_t status;
+
+    status = _cairo_scan_converter_create_for_polygon (extents, polygon,
+						       fill_rule, antialias,
+						       &converter);
+    if (likely (status == CAIRO_STATUS_SUCCESS))
+	status = converter->generate (converter, &coverage->base);
+    if (converter != NULL)
+	converter->destroy (converter);
+
+    return status;
+}
+
+typedef struct _cairo_tiled_operation {
+    /* Does the tile receive no coverage from the operation? */
+    cairo_bool_t (*is_empty) (struct _cairo_tiled_operation *op,
+			      int col, int row,
+			      const cairo_rectangle_int_t *tile);
+    cairo_int_status_t (*func) (const struct _cairo_tiled_operation *op,
+				cairo_surface_wrapper_t *wrapper,
+				int col, int row,
+				const cairo_rectangle_int_t *tile);
+
+    cairo_operator_t op;
+    const cairo_pattern_t *source;
+    const cairo_pattern_t *mask;
+    const cairo_clip_t *clip;
+
+    cairo_tiled_coverage_t coverage;
+
+    cairo_glyph_t *glyphs;
+    int num_glyphs;
+    cairo_scaled_font_t *scaled_font;
+    cairo_rectangle_int_t *glyph_extents;
+    cairo_glyph_t *tile_glyphs;
+    int num_tile_glyphs;
+} cairo_tiled_operation_t;
+
+/* Applies the operation to every tile inside the area it may affect.
+ *
+ * A tile that receives no coverage is skipped without being allocated
+ * or copied if the operator is bounded. It is also skipped if it was
+ * never written, as every operator leaves clear pixels clear where the
+ * coverage is zero. Otherwise it is composited through a clear mask, so
+ * that an unbounded operator still clears it within the clip.
+ */
+static cairo_int_status_t
+_cairo_tiled_surface_composite (cairo_tiled_surface_t *surface,
+				cairo_tiled_operation_t *op,
+				cairo_composite_rectangles_t *composite)
+{
+    const cairo_rectangle_int_t *extents;
+    cairo_int_status_t status = CAIRO_INT_STATUS_SUCCESS;
+    int col, row;
+
+    extents = composite->is_bounded ? &composite->bounded : &composite->unbounded;
+    if (extents->width == 0 || extents->height == 0)
+	return CAIRO_INT_STATUS_SUCCESS;
+
+    for (row = extents->y / TILE_SIZE;
+	 row <= (extents->y + extents->height - 1) / TILE_SIZE;
+	 row++)
+    {
+	for (col = extents->x / TILE_SIZE;
+	     col <= (extents->x + extents->width - 1) / TILE_SIZE;
+	     col++)
+	{
+	    cairo_surface_wrapper_t wrapper;
+	    cairo_image_surface_t *tile;
+	    cairo_rectangle_int_t r;
+	    cairo_bool_t is_empty;
+
+	    _cairo_tiled_surface_tile_extents (surface, col, row, &r);
+	    is_empty = op->is_empty (op, col, row, &r);
+	    if (is_empty &&
+		(composite->is_bounded ||
+		 surface->tiles[row * surface->num_cols + col] == NULL))
+	    {
+		continue;
+	    }
+
+	    status = _cairo_tiled_surface_get_tile_for_write (surface,
+							      col, row,
+							      &tile);
+	    if (unlikely (status))
+		return status;
+
+	    _cairo_surface_wrapper_init (&wrapper, &tile->base);
+	    _cairo_surface_wrapper_intersect_extents (&wrapper, &r);
+
+	    if (is_empty) {
+		status = _cairo_surface_wrapper_mask (&wrapper, op->op,
+						      op->source,
+						      &_cairo_pattern_clear.base,
+						      op->clip);
+	    } else {
+		status = op->func (op, &wrapper, col, row, &r);
+	    }
+	    _cairo_surface_wrapper_fini (&wrapper);
+
+	    if (status == CAIRO_INT_STATUS_NOTHING_TO_DO)
+		status = CAIRO_INT_STATUS_SUCCESS;
+	    if (unlikely (status))
+		return status;
+	}
+    }
+
+    return status;
+}
+
+static cairo_bool_t
+_clip_is_empty (cairo_tiled_operation_t *op,
+		int col, int row,
+		const cairo_rectangle_int_t *tile)
+{
+    cairo_clip_t *clip;
+    cairo_bool_t is_empty;
+
+    if (op->clip == NULL)
+	return FALSE;
+
+    clip = _cairo_clip_intersect_rectangle (_cairo_clip_copy (op->clip),
+					    tile);
+    is_empty = _cairo_clip_is_all_clipped (clip);
+    _cairo_clip_destroy (clip);
+
+    return is_empty;
+}
+
+static cairo_int_status_t
+_paint_tile (const cairo_tiled_operation_t *op,
+	     cairo_surface_wrapper_t *wrapper,
+	     int col, int row,
+	     const cairo_rectangle_int_t *tile)
+{
+    return _cairo_surface_wrapper_paint (wrapper, op->op, op->source,
+					 op->clip);
+}
+
+static cairo_int_status_t
+_cairo_tiled_surface_paint (void			*abstract_surface,
+			    cairo_operator_t		 op,
+			    const cairo_pattern_t	*source,
+			    const cairo_clip_t		*clip)
+{
+    cairo_tiled_surface_t *surface = abstract_surface;
+    cairo_composite_rectangles_t composite;
+    cairo_tiled_operation_t tiled;
+    cairo_int_status_t status;
+
+    status = _cairo_composite_rectangles_init_for_paint (&composite,
+							 &surface->base,
+							 op, source, clip);
+    if (unlikely (status))
+	return status;
+
+    tiled.is_empty = _clip_is_empty;
+    tiled.func = _paint_tile;
+    tiled.op = op;
+    tiled.source = source;
+    tiled.clip = composite.clip;
+
+    status = _cairo_tiled_surface_composite (surface, &tiled, &composite);
+    _cairo_composite_rectangles_fini (&composite);
+
+    return status;
+}
+
+static cairo_int_status_t
+_mask_tile (const cairo_tiled_operation_t *op,
+	    cairo_surface_wrapper_t *wrapper,
+	    int col, int row,
+	    const cairo_rectangle_int_t *tile)
+{
+    return _cairo_surface_wrapper_mask (wrapper, op->op,
+					op->source, op->mask,
+					op->clip);
+}
+
+static cairo_int_status_t
+_cairo_tiled_surface_mask (void				*abstract_surface,
+			   cairo_operator_t		 op,
+			   const cairo_pattern_t	*source,
+			   const cairo_pattern_t	*mask,
+			   const cairo_clip_t		*clip)
+{
+    cairo_tiled_surface_t *surface = abstract_surface;
+    cairo_composite_rectangles_t composite;
+    cairo_tiled_operation_t tiled;
+    cairo_int_status_t status;
+
+    status = _cairo_composite_rectangles_init_for_mask (&composite,
+							&surface->base,
+							op, source, mask, clip);
+    if (unlikely (status))
+	return status;
+
+    tiled.is_empty = _clip_is_empty;
+    tiled.func = _mask_tile;
+    tiled.op = op;
+    tiled.source = source;
+    tiled.mask = mask;
+    tiled.clip = composite.clip;
+
+    status = _cairo_tiled_surface_composite (surface, &tiled, &composite);
+    _cairo_composite_rectangles_fini (&composite);
+
+    return status;
+}
+
+static cairo_bool_t
+_coverage_is_empty (cairo_tiled_operation_t *op,
+		    int col, int row,
+		    const cairo_rectangle_int_t *tile)
+{
+    const cairo_tiled_coverage_t *coverage = &op->coverage;
+
+    return coverage->masks[(row - coverage->row) * coverage->num_cols +
+			   col - coverage->col] == NULL;
+}
+
+static cairo_int_status_t
+_coverage_tile (const cairo_tiled_operation_t *op,
+		cairo_surface_wrapper_t *wrapper,
+		int col, int row,
+		const cairo_rectangle_int_t *tile)
+{
+    const cairo_tiled_coverage_t *coverage = &op->coverage;
+    cairo_surface_pattern_t mask;
+    cairo_int_status_t status;
+
+    _cairo_pattern_init_for_surface (&mask,
+				     &coverage->masks[(row - coverage->row) * coverage->num_cols +
+						      col - coverage->col]->base);
+    mask.base.filter = CAIRO_FILTER_NEAREST;
+    cairo_matrix_init_translate (&mask.base.matrix, -tile->x, -tile->y);
+
+    status = _cairo_surface_wrapper_mask (wrapper, op->op,
+					  op->source, &mask.base,
+					  op->clip);
+    _cairo_pattern_fini (&mask.base);
+
+    return status;
+}
+
+/* Rasterises the fill or stroke, whose coverage has been accumulated
+ * in tiled->coverage, onto the tiles.
+ */
+static cairo_int_status_t
+_cairo_tiled_surface_composite_coverage (cairo_tiled_surface_t *surface,
+					 cairo_tiled_operation_t *tiled,
+					 cairo_composite_rectangles_t *composite)
+{
+    tiled->is_empty = _coverage_is_empty;
+    tiled->func = _coverage_tile;
+    tiled->clip = composite->clip;
+
+    return _cairo_tiled_surface_composite (surface, tiled, composite);
+}
+
+static cairo_int_status_t
+_cairo_tiled_surface_stroke (void			*abstract_surface,
+			     cairo_operator_t		 op,
+			     const cairo_pattern_t	*source,
+			     const cairo_path_fixed_t	*path,
+			     const cairo_stroke_style_t	*style,
+			     const cairo_matrix_t	*ctm,
+			     const cairo_matrix_t	*ctm_inverse,
+			     double			 tolerance,
+			     cairo_antialias_t		 antialias,
+			     const cairo_clip_t		*clip)
+{
+    cairo_tiled_surface_t *surface = abstract_surface;
+    cairo_composite_rectangles_t composite;
+    cairo_tiled_operation_t tiled;
+    const cairo_rectangle_int_t *extents;
+    cairo_int_status_t status;
+    double line_width;
+
+    status = _cairo_composite_rectangles_init_for_stroke (&composite,
+							  &surface->base,
+							  op, source,
+							  path, style, ctm,
+							  clip);
+    if (unlikely (status))
+	return status;
+
+    extents = composite.is_bounded ? &composite.bounded : &composite.unbounded;
+    if (extents->width == 0 || extents->height == 0)
+	goto finish;
+
+    status = _cairo_tiled_coverage_init (&tiled.coverage, surface, extents);
+    if (unlikely (status))
+	goto finish;
+
+    status = CAIRO_INT_STATUS_UNSUPPORTED;
+    if (_cairo_path_fixed_stroke_is_rectilinear (path)) {
+	cairo_boxes_t boxes;
+
+	_cairo_boxes_init (&boxes);
+	status = _cairo_path_fixed_stroke_rectilinear_to_boxes (path, style,
+								ctm, antialias,
+								&boxes);
+	if (likely (status == CAIRO_INT_STATUS_SUCCESS))
+	    status = _cairo_tiled_coverage_add_boxes (&tiled.coverage,
+						      extents, &boxes);
+	_cairo_boxes_fini (&boxes);
+    }
+
+    if (status == CAIRO_INT_STATUS_UNSUPPORTED &&
+	antialias != CAIRO_ANTIALIAS_NONE &&
+	_cairo_stroke_is_hairline (style, ctm, &line_width))
+    {
+	cairo_scan_converter_t *converter;
+
+	converter = _cairo_hairline_scan_converter_create (extents->x,
+							   extents->y,
+							   extents->x + extents->width,
+							   extents->y + extents->height,
+							   line_width,
+							   style->line_cap);
+	status = _cairo_hairline_scan_converter_add_path (converter, path,
+							  tolerance);
+	if (likely (status == CAIRO_INT_STATUS_SUCCESS))
+	    status = converter->generate (converter, &tiled.coverage.base);
+	converter->destroy (converter);
+    }
+
+    if (status == CAIRO_INT_STATUS_UNSUPPORTED) {
+	cairo_polygon_t polygon;
+	cairo_box_t limits;
+
+	_cairo_box_from_rectangle (&limits, extents);
+	_cairo_polygon_init (&polygon, &limits, 1);
+	status = _cairo_path_fixed_stroke_to_polygon (path, style,
+						      ctm, ctm_inverse,
+						      tolerance,
+						      &polygon);
+	if (likely (status == CAIRO_INT_STATUS_SUCCESS)) {
+	    status = _cairo_tiled_coverage_add_polygon (&tiled.coverage,
+							extents, &polygon,
+							CAIRO_FILL_RULE_WINDING,
+							antialias);
+	}
+	_cairo_polygon_fini (&polygon);
+    }
+
+    if (likely (status == CAIRO_INT_STATUS_SUCCESS)) {
+	tiled.op = op;
+	tiled.source = source;
+	status = _cairo_tiled_surface_composite_coverage (surface, &tiled,
+							  &composite);
+    }
+
+    _cairo_tiled_coverage_fini (&tiled.coverage);
+finish:
+    _cairo_composite_rectangles_fini (&composite);
+    return status;
+}
+
+static cairo_int_status_t
+_cairo_tiled_surface_fill (void				*abstract_surface,
+			   cairo_operator_t		 op,
+			   const cairo_pattern_t	*source,
+			   const cairo_path_fixed_t	*path,
+			   cairo_fill_rule_t		 fill_rule,
+			   double			 tolerance,
+			   cairo_antialias_t		 antialias,
+			   const cairo_clip_t		*clip)
+{
+    cairo_tiled_surface_t *surface = abstract_surface;
+    cairo_composite_rectangles_t composite;
+    cairo_tiled_operation_t tiled;
+    const cairo_rectangle_int_t *extents;
+    cairo_int_status_t status;
+
+    status = _cairo_composite_rectangles_init_for_fill (&composite,
+							&surface->base,
+							op, source, path,
+							clip);
+    if (unlikely (status))
+	return status;
+
+    extents = composite.is_bounded ? &composite.bounded : &composite.unbounded;
+    if (extents->width == 0 || extents->height == 0)
+	goto finish;
+
+    status = _cairo_tiled_coverage_init (&tiled.coverage, surface, extents);
+    if (unlikely (status))
+	goto finish;
+
+    if (_cairo_path_fixed_fill_is_rectilinear (path)) {
+	cairo_boxes_t boxes;
+
+	_cairo_boxes_init (&boxes);
+	status = _cairo_path_fixed_fill_rectilinear_to_boxes (path,
+							      fill_rule,
+							      antialias,
+							      &boxes);
+	if (likely (status == CAIRO_INT_STATUS_SUCCESS))
+	    status = _cairo_tiled_coverage_add_boxes (&tiled.coverage,
+						      extents, &boxes);
+	_cairo_boxes_fini (&boxes);
+    } else {
+	cairo_polygon_t polygon;
+	cairo_box_t limits;
+
+	_cairo_box_from_rectangle (&limits, extents);
+	_cairo_polygon_init (&polygon, &limits, 1);
+	status = _cairo_path_fixed_fill_to_polygon (path, tolerance, &polygon);
+	if (likely (status == CAIRO_INT_STATUS_SUCCESS)) {
+	    status = _cairo_tiled_coverage_add_polygon (&tiled.coverage,
+							extents, &polygon,
+							fill_rule, antialias);
+	}
+	_cairo_polygon_fini (&polygon);
+    }
+
+    if (likely (status == CAIRO_INT_STATUS_SUCCESS)) {
+	tiled.op = op;
+	tiled.source = source;
+	status = _cairo_tiled_surface_composite_coverage (surface, &tiled,
+							  &composite);
+    }
+
+    _cairo_tiled_coverage_fini (&tiled.coverage);
+finish:
+    _cairo_composite_rectangles_fini (&composite);
+    return status;
+}
+
+/* Glyphs are sorted into the tiles that their ink extents overlap, and
+ * each tile is sent only its own glyphs.
+ */
+static cairo_bool_t
+_glyphs_is_empty (cairo_tiled_operation_t *op,
+		  int col, int row,
+		  const cairo_rectangle_int_t *tile)
+{
+    int i;
+
+    op->num_tile_glyphs = 0;
+    for (i = 0; i < op->num_glyphs; i++) {
+	cairo_rectangle_int_t r = op->glyph_extents[i];
+
+	if (_cairo_rectangle_intersect (&r, tile))
+	    op->tile_glyphs[op->num_tile_glyphs++] = op->glyphs[i];
+    }
+
+    return op->num_tile_glyphs == 0;
+}
+
+static cairo_int_status_t
+_glyphs_tile (const cairo_tiled_operation_t *op,
+	      cairo_surface_wrapper_t *wrapper,
+	      int col, int row,
+	      const cairo_rectangle_int_t *tile)
+{
+    return _cairo_surface_wrapper_show_text_glyphs (wrapper, op->op, op->source,
+						    NULL, 0,
+						    op->tile_glyphs,
+						    op->num_tile_glyphs,
+						    NULL, 0, 0,
+						    op->scaled_font,
+						    op->clip);
+}
+
+static cairo_status_t
+_cairo_tiled_surface_glyph_extents (cairo_tiled_operation_t *op)
+{
+    int i;
+
+    for (i = 0; i < op->num_glyphs; i++) {
+	cairo_status_t status;
+
+	status = _cairo_scaled_font_glyph_device_extents (op->scaled_font,
+							  &op->glyphs[i], 1,
+							  &op->glyph_extents[i],
+							  NULL);
+	if (unlikely (status))
+	    return status;
+    }
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_int_status_t
+_cairo_tiled_surface_glyphs (void			*abstract_surface,
+			     cairo_operator_t		 op,
+			     const cairo_pattern_t	*source,
+			     cairo_glyph_t		*glyphs,
+			     int			 num_glyphs,
+			     cairo_scaled_font_t	*scaled_font,
+			     const cairo_clip_t		*clip)
+{
+    cairo_tiled_surface_t *surface = abstract_surface;
+    cairo_composite_rectangles_t composite;
+    cairo_tiled_operation_t tiled;
+    cairo_int_status_t status;
+    cairo_bool_t overlap;
+
+    status = _cairo_composite_rectangles_init_for_glyphs (&composite,
+							  &surface->base,
+							  op, source,
+							  scaled_font,
+							  glyphs, num_glyphs,
+							  clip, &overlap);
+    if (unlikely (status))
+	return status;
+
+    tiled.glyph_extents = _cairo_malloc_ab (num_glyphs,
+					    sizeof (cairo_rectangle_int_t) +
+					    sizeof (cairo_glyph_t));
+    if (unlikely (tiled.glyph_extents == NULL)) {
+	status = _cairo_error (CAIRO_STATUS_NO_MEMORY);
+	goto finish;
+    }
+    tiled.tile_glyphs = (cairo_glyph_t *) (tiled.glyph_extents + num_glyphs);
+
+    tiled.is_empty = _glyphs_is_empty;
+    tiled.func = _glyphs_tile;
+    tiled.op = op;
+    tiled.source = source;
+    tiled.glyphs = glyphs;
+    tiled.num_glyphs = num_glyphs;
+    tiled.scaled_font = scaled_font;
+    tiled.clip = composite.clip;
+
+    status = _cairo_tiled_surface_glyph_extents (&tiled);
+    if (likely (status == CAIRO_INT_STATUS_SUCCESS))
+	status = _cairo_tiled_surface_composite (surface, &tiled, &composite);
+
+    free (tiled.glyph_extents);
+finish:
+    _cairo_composite_rectangles_fini (&composite);
+    return status;
+}
+
+static const cairo_surface_backend_t _cairo_tiled_surface_backend = {
+    CAIRO_SURFACE_TYPE_TILED_IMAGE,
+    _cairo_tiled_surface_finish,
+
+    _cairo_default_context_create,
+
+    _cairo_tiled_surface_create_similar,
+    NULL, /* create_similar_image */
+    _cairo_tiled_surface_map_to_image,
+    _cairo_tiled_surface_unmap_image,
+
+    NULL, /* source */
+    _cairo_tiled_surface_acquire_source_image,
+    _cairo_tiled_surface_release_source_image,
+    _cairo_tiled_surface_snapshot,
+
+    NULL, /* copy_page */
+    NULL, /* show_page */
+
+    _cairo_tiled_surface_get_extents,
+    _cairo_tiled_surface_get_font_options,
+
+    NULL, /* flush */
+    NULL, /* mark_dirty_rectangle */
+
+    _cairo_tiled_surface_paint,
+    _cairo_tiled_surface_mask,
+    _cairo_tiled_surface_stroke,
+    _cairo_tiled_surface_fill,
+    NULL, /* fill-stroke */
+    _cairo_tiled_surface_glyphs,
+};
+
+static cairo_surface_t *
+_cairo_tiled_surface_create_internal (cairo_format_t format,
+				      int width, int height)
+{
+    cairo_tiled_surface_t *surface;
+
+    if (! CAIRO_FORMAT_VALID (format))
+	return _cairo_surface_create_in_error (_cairo_error (CAIRO_STATUS_INVALID_FORMAT));
+
+    if (width < 0 || height < 0)
+	return _cairo_surface_create_in_error (_cairo_error (CAIRO_STATUS_INVALID_SIZE));
+
+    surface = malloc (sizeof (cairo_tiled_surface_t));
+    if (unlikely (surface == NULL))
+	return _cairo_surface_create_in_error (_cairo_error (CAIRO_STATUS_NO_MEMORY));
+
+    _cairo_surface_init (&surface->base,
+			 &_cairo_tiled_surface_backend,
+			 NULL, /* device */
+			 _cairo_content_from_format (format));
+
+    surface->format = format;
+    surface->pixman_format = _cairo_format_to_pixman_format_code (format);
+    surface->width = width;
+    surface->height = height;
+    surface->num_cols = (width  + TILE_SIZE - 1) / TILE_SIZE;
+    surface->num_rows = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+    surface->tiles = NULL;
+    if (surface->num_cols && surface->num_rows) {
+	surface->tiles = calloc (surface->num_cols * surface->num_rows,
+				 sizeof (cairo_image_surface_t *));
+	if (unlikely (surface->tiles == NULL)) {
+	    free (surface);
+	    return _cairo_surface_create_in_error (_cairo_error (CAIRO_STATUS_NO_MEMORY));
+	}
+    }
+
+    return &surface->base;
+}
+
+/**
+ * cairo_tiled_image_surface_create:
+ * @format: format of pixels in the surface to create
+ * @width: width of the surface, in pixels
+ * @height: height of the surface, in pixels
+ *
+ * Creates an image surface of the specified format and dimensions
+ * whose pixels are stored in small square tiles rather than row after
+ * row. Rendering to it gives the same results as rendering to a surface
+ * from cairo_image_surface_create(), but operations that walk down the
+ * surface or across it at an angle touch far less memory, and only
+ * the tiles that are drawn to are ever allocated. Snapshots of the
+ * surface share its tiles until either side is modified.
+ *
+ * The pixel data is not directly accessible; use
+ * cairo_surface_map_to_image() to read or write a region of it, which
+ * only copies the tiles underneath that region.
+ *
+ * Return value: a pointer to the newly created surface. The caller
+ * owns the surface and should call cairo_surface_destroy() when done
+ * with it.
+ *
+ * This function always returns a valid pointer, but it will return a
+ * pointer to a "nil" surface if an error such as out of memory
+ * occurs. You can use cairo_surface_status() to check for this.
+ *
+ * Since: 1.14
+ **/
+cairo_surface_t *
+cairo_tiled_image_surface_create (cairo_format_t	format,
+				  int			width,
+				  int			height)
+{
+    return _cairo_tiled_surface_create_internal (format, width, height);
+}
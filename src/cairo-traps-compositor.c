@@ -2276,7 +2276,10 @@ _cairo_traps_compositor_glyphs (const cairo_compositor_t	*_compositor,
     if (unlikely (status))
 	return status;
 
-    _cairo_scaled_font_freeze_cache (scaled_font);
+    if (compositor->shared_glyph_cache)
+	_cairo_scaled_font_freeze_cache_shared (scaled_font);
+    else
+	_cairo_scaled_font_freeze_cache (scaled_font);
     status = compositor->check_composite_glyphs (extents,
 						 scaled_font, glyphs,
 						 &num_glyphs);
@@ -2301,7 +2304,10 @@ _cairo_traps_compositor_glyphs (const cairo_compositor_t	*_compositor,
 				     need_bounded_clip (extents) |
 				     flags);
     }
-    _cairo_scaled_font_thaw_cache (scaled_font);
+    if (compositor->shared_glyph_cache)
+	_cairo_scaled_font_thaw_cache_shared (scaled_font);
+    else
+	_cairo_scaled_font_thaw_cache (scaled_font);
 
     return status;
 }
@@ -4323,7 +4323,7 @@ _cairo_xcb_glyph_fini (cairo_scaled_glyph_private_t *glyph_private,
 	    _cairo_scaled_glyph_index (glyph);
     }
 
-    cairo_list_del (&glyph_private->link);
+    _cairo_scaled_glyph_detach_private (glyph, glyph_private);
     free (glyph_private);
 }
 
@@ -1640,6 +1640,54 @@ cairo_public void
 cairo_scaled_font_get_font_options (cairo_scaled_font_t		*scaled_font,
 				    cairo_font_options_t	*options);
 
+/* Glyph cache */
+
+/**
+ * cairo_glyph_cache_stats_t:
+ * @hits: the number of glyph lookups that found the glyph in the cache
+ * @misses: the number of glyph lookups that had to create or amend the glyph
+ * @evictions: the number of glyphs dropped to stay within the budget
+ * @size: the number of bytes currently held by cached glyphs
+ * @max_size: the budget, as set with cairo_glyph_cache_set_max_size()
+ * @text_hits: the number of strings converted to glyphs by reusing an
+ *   earlier conversion of the same string with the same scaled font
+ * @text_misses: the number of strings that had to be converted afresh
+ * @text_evictions: the number of remembered conversions dropped to make
+ *   room for newer ones
+ *
+ * A snapshot of the glyph cache shared by all scaled fonts, as returned by
+ * cairo_glyph_cache_get_stats(). The counters run for the lifetime of the
+ * process and wrap around, so compare two snapshots to see the effect of
+ * a change.
+ *
+ * Since: 1.14
+ **/
+typedef struct {
+    unsigned int hits;
+    unsigned int misses;
+    unsigned int evictions;
+    unsigned long size;
+    unsigned long max_size;
+    unsigned int text_hits;
+    unsigned int text_misses;
+    unsigned int text_evictions;
+} cairo_glyph_cache_stats_t;
+
+cairo_public void
+cairo_glyph_cache_set_max_size (unsigned long max_size);
+
+cairo_public unsigned long
+cairo_glyph_cache_get_max_size (void);
+
+cairo_public void
+cairo_glyph_cache_set_max_glyph_size (double max_glyph_size);
+
+cairo_public double
+cairo_glyph_cache_get_max_glyph_size (void);
+
+cairo_public void
+cairo_glyph_cache_get_stats (cairo_glyph_cache_stats_t *stats);
+
 
 /* Toy fonts */
 
@@ -2332,6 +2380,8 @@ cairo_surface_status (cairo_surface_t *surface);
  * @CAIRO_SURFACE_TYPE_SUBSURFACE: The surface is a subsurface created with
  *   cairo_surface_create_for_rectangle(), since 1.10
  * @CAIRO_SURFACE_TYPE_COGL: This surface is of type Cogl, since 1.12
+ * @CAIRO_SURFACE_TYPE_TILED_IMAGE: The surface is an image surface stored
+ *   in tiles, created with cairo_tiled_image_surface_create(), since 1.14
  *
  * #cairo_surface_type_t is used to describe the type of a given
  * surface. The surface types are also known as "backends" or "surface
@@ -2382,7 +2432,8 @@ typedef enum _cairo_surface_type {
     CAIRO_SURFACE_TYPE_XML,
     CAIRO_SURFACE_TYPE_SKIA,
     CAIRO_SURFACE_TYPE_SUBSURFACE,
-    CAIRO_SURFACE_TYPE_COGL
+    CAIRO_SURFACE_TYPE_COGL,
+    CAIRO_SURFACE_TYPE_TILED_IMAGE
 } cairo_surface_type_t;
 
 cairo_public cairo_surface_type_t
@@ -2517,6 +2568,13 @@ cairo_image_surface_get_height (cairo_surface_t *surface);
 cairo_public int
 cairo_image_surface_get_stride (cairo_surface_t *surface);
 
+/* Tiled image-surface functions */
+
+cairo_public cairo_surface_t *
+cairo_tiled_image_surface_create (cairo_format_t	format,
+				  int			width,
+				  int			height);
+
 #if CAIRO_HAS_PNG_FUNCTIONS
 
 cairo_public cairo_surface_t *
@@ -2882,8 +2940,11 @@ cairo_pattern_get_extend (cairo_pattern_t *pattern);
  *     not be suitable for interactive use. (Since 1.0)
  * @CAIRO_FILTER_NEAREST: Nearest-neighbor filtering (Since 1.0)
  * @CAIRO_FILTER_BILINEAR: Linear interpolation in two dimensions (Since 1.0)
- * @CAIRO_FILTER_GAUSSIAN: This filter value is currently
- *     unimplemented, and should not be used in current code. (Since 1.0)
+ * @CAIRO_FILTER_GAUSSIAN: A Gaussian blur, of the standard deviation
+ *     set with cairo_pattern_set_sigma(), or by default one that follows
+ *     the pattern scale but covers at least one source pixel. Only image
+ *     sources are blurred; elsewhere it behaves as %CAIRO_FILTER_BEST.
+ *     (Since 1.0)
  *
  * #cairo_filter_t is used to indicate what filtering should be
  * applied when reading pixel values from patterns. See
@@ -2907,6 +2968,14 @@ cairo_pattern_set_filter (cairo_pattern_t *pattern, cairo_filter_t filter);
 cairo_public cairo_filter_t
 cairo_pattern_get_filter (cairo_pattern_t *pattern);
 
+cairo_public void
+cairo_pattern_set_sigma (cairo_pattern_t *pattern,
+			 double x_sigma, double y_sigma);
+
+cairo_public void
+cairo_pattern_get_sigma (cairo_pattern_t *pattern,
+			 double *x_sigma, double *y_sigma);
+
 cairo_public cairo_status_t
 cairo_pattern_get_rgba (cairo_pattern_t *pattern,
 			double *red, double *green,
@@ -393,6 +393,21 @@ _cairo_hash_bytes (unsigned long hash,
 #define _cairo_scaled_glyph_index(g) ((g)->hash_entry.hash)
 #define _cairo_scaled_glyph_set_index(g, i)  ((g)->hash_entry.hash = (i))
 
+/* Fonts with glyph phases render variants of each glyph offset to the
+ * right by a fraction of a pixel, the phase, which is looked up above the
+ * font's own glyph index. See _cairo_scaled_font_enable_glyph_phases(). */
+#define CAIRO_SCALED_GLYPH_XPHASE_SHIFT 24
+#define CAIRO_SCALED_GLYPH_XPHASES 4
+#define CAIRO_SCALED_GLYPH_INDEX_MASK ((1UL << CAIRO_SCALED_GLYPH_XPHASE_SHIFT) - 1)
+#define _cairo_scaled_glyph_xphase(g) \
+    ((int) (_cairo_scaled_glyph_index (g) >> CAIRO_SCALED_GLYPH_XPHASE_SHIFT) & \
+     (CAIRO_SCALED_GLYPH_XPHASES - 1))
+#define _cairo_scaled_glyph_font_index(g) \
+    (_cairo_scaled_glyph_index (g) & CAIRO_SCALED_GLYPH_INDEX_MASK)
+/* spreads the phases of a glyph over small direct-mapped caches */
+#define _cairo_scaled_glyph_index_hash(i) \
+    ((i) ^ ((i) >> (CAIRO_SCALED_GLYPH_XPHASE_SHIFT - 4)))
+
 #include "cairo-scaled-font-private.h"
 
 struct _cairo_font_face {
@@ -1116,9 +1131,18 @@ _cairo_scaled_font_freeze_cache (cairo_scaled_font_t *scaled_font);
 cairo_private void
 _cairo_scaled_font_thaw_cache (cairo_scaled_font_t *scaled_font);
 
+cairo_private void
+_cairo_scaled_font_freeze_cache_shared (cairo_scaled_font_t *scaled_font);
+
+cairo_private void
+_cairo_scaled_font_thaw_cache_shared (cairo_scaled_font_t *scaled_font);
+
 cairo_private void
 _cairo_scaled_font_reset_cache (cairo_scaled_font_t *scaled_font);
 
+cairo_private void
+_cairo_scaled_font_enable_glyph_phases (cairo_scaled_font_t *scaled_font);
+
 cairo_private cairo_status_t
 _cairo_scaled_font_set_error (cairo_scaled_font_t *scaled_font,
 			      cairo_status_t status);
@@ -1189,6 +1213,15 @@ _cairo_scaled_font_glyph_path (cairo_scaled_font_t *scaled_font,
 			       int                  num_glyphs,
 			       cairo_path_fixed_t  *path);
 
+cairo_private cairo_int_status_t
+_cairo_scaled_font_glyph_outlines (cairo_scaled_font_t *scaled_font,
+				   const cairo_glyph_t *glyphs,
+				   int                  num_glyphs,
+				   cairo_path_fixed_t  *path);
+
+cairo_private cairo_bool_t
+_cairo_scaled_font_has_large_glyphs (cairo_scaled_font_t *scaled_font);
+
 cairo_private void
 _cairo_scaled_glyph_set_metrics (cairo_scaled_glyph_t *scaled_glyph,
 				 cairo_scaled_font_t *scaled_font,
@@ -1492,6 +1525,19 @@ _pixman_format_to_masks (pixman_format_code_t	 pixman_format,
 cairo_private void
 _cairo_image_reset_static_data (void);
 
+cairo_private void
+_cairo_image_solid_cache_get_stats (unsigned long *hits,
+				    unsigned long *misses);
+
+cairo_private void
+_cairo_image_compositor_reset_static_data (void);
+
+cairo_private void
+_cairo_image_scratch_reset_static_data (void);
+
+cairo_private void
+_cairo_spans_compositor_reset_static_data (void);
+
 cairo_private cairo_surface_t *
 _cairo_image_surface_create_with_pixman_format (unsigned char		*data,
 						pixman_format_code_t	 pixman_format,
@@ -1547,6 +1593,9 @@ cairo_private int
 _cairo_pen_find_active_ccw_vertex_index (const cairo_pen_t *pen,
 					 const cairo_slope_t *slope);
 
+cairo_private void
+_cairo_pen_reset_static_data (void);
+
 /* cairo-polygon.c */
 cairo_private void
 _cairo_polygon_init (cairo_polygon_t   *polygon,
@@ -1596,6 +1645,12 @@ _cairo_polygon_add_contour (cairo_polygon_t *polygon,
 cairo_private void
 _cairo_polygon_translate (cairo_polygon_t *polygon, int dx, int dy);
 
+cairo_private cairo_status_t
+_cairo_polygon_partition (const cairo_polygon_t *polygon,
+			  int max_clusters,
+			  cairo_polygon_cluster_t **clusters_out,
+			  int *num_clusters_out);
+
 cairo_private cairo_status_t
 _cairo_polygon_reduce (cairo_polygon_t *polygon,
 		       cairo_fill_rule_t fill_rule);
@@ -1631,6 +1686,12 @@ _cairo_spline_init (cairo_spline_t *spline,
 cairo_private cairo_status_t
 _cairo_spline_decompose (cairo_spline_t *spline, double tolerance);
 
+cairo_private int
+_cairo_spline_flatten (const cairo_point_t *a, const cairo_point_t *b,
+		       const cairo_point_t *c, const cairo_point_t *d,
+		       double tolerance,
+		       cairo_point_t *points, int max_points);
+
 cairo_private cairo_status_t
 _cairo_spline_bound (cairo_spline_add_point_func_t add_point_func,
 		     void *closure,
@@ -0,0 +1,126 @@
+/*
+ * Copyright © 2012 Samsung Electronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Draws overlapping fills, under both fill rules, and a self-crossing
+ * stroke at each antialiasing tier and checks that BEST and FAST agree
+ * with GOOD. The area converter behind BEST is only exact once any
+ * overlaps are resolved, so these are the shapes it would get wrong.
+ */
+
+#include "cairo-test.h"
+
+#define WIDTH 160
+#define HEIGHT 120
+
+/* tor, behind GOOD, samples only 15 rows per pixel */
+#define BEST_TOLERANCE 32
+/* tor22, behind FAST, samples a 4x4 grid, and may be out by over a
+ * third of full coverage along an edge; this only catches gross errors */
+#define FAST_TOLERANCE 128
+
+static void
+draw_shapes (cairo_t *cr)
+{
+    cairo_set_source_rgb (cr, 1, 1, 1);
+    cairo_paint (cr);
+    cairo_set_source_rgb (cr, 0, 0, 0);
+
+    /* two overlapping discs, wound the same way */
+    cairo_arc (cr, 30.5, 30.25, 22, 0, 2 * M_PI);
+    cairo_new_sub_path (cr);
+    cairo_arc (cr, 45.75, 35.5, 20, 0, 2 * M_PI);
+    cairo_fill (cr);
+
+    /* a pentagram, both with and without its centre */
+    cairo_move_to (cr, 100.3, 5.2);
+    cairo_line_to (cr, 115.6, 55.1);
+    cairo_line_to (cr, 72.1, 24.4);
+    cairo_line_to (cr, 128.9, 24.4);
+    cairo_line_to (cr, 85.2, 55.1);
+    cairo_close_path (cr);
+    cairo_fill_preserve (cr);
+    cairo_save (cr);
+    cairo_translate (cr, 0, 60);
+    cairo_set_fill_rule (cr, CAIRO_FILL_RULE_EVEN_ODD);
+    cairo_fill (cr);
+    cairo_restore (cr);
+
+    /* a thick stroke that crosses itself with mitred joins */
+    cairo_move_to (cr, 10.3, 70.6);
+    cairo_line_to (cr, 60.2, 112.1);
+    cairo_line_to (cr, 15.7, 110.4);
+    cairo_line_to (cr, 62.5, 66.9);
+    cairo_set_line_width (cr, 7);
+    cairo_set_line_join (cr, CAIRO_LINE_JOIN_MITER);
+    cairo_stroke (cr);
+}
+
+static cairo_surface_t *
+draw (cairo_antialias_t antialias)
+{
+    cairo_surface_t *image;
+    cairo_t *cr;
+
+    image = cairo_image_surface_create (CAIRO_FORMAT_RGB24, WIDTH, HEIGHT);
+    cr = cairo_create (image);
+    cairo_set_antialias (cr, antialias);
+    draw_shapes (cr);
+    cairo_destroy (cr);
+
+    return image;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_surface_t *best, *good, *fast;
+    cairo_test_status_t status = CAIRO_TEST_SUCCESS;
+
+    best = draw (CAIRO_ANTIALIAS_BEST);
+    good = draw (CAIRO_ANTIALIAS_GOOD);
+    fast = draw (CAIRO_ANTIALIAS_FAST);
+
+    if (! cairo_test_images_match (ctx, best, good, BEST_TOLERANCE)) {
+	cairo_test_log (ctx, "Error: ANTIALIAS_BEST differs from ANTIALIAS_GOOD\n");
+	status = CAIRO_TEST_FAILURE;
+    }
+
+    if (! cairo_test_images_match (ctx, fast, good, FAST_TOLERANCE)) {
+	cairo_test_log (ctx, "Error: ANTIALIAS_FAST differs from ANTIALIAS_GOOD\n");
+	status = CAIRO_TEST_FAILURE;
+    }
+
+    cairo_surface_destroy (fast);
+    cairo_surface_destroy (good);
+    cairo_surface_destroy (best);
+
+    return status;
+}
+
+CAIRO_TEST (antialias_tiers,
+	    "Check that the antialiasing tiers agree on overlapping shapes",
+	    "fill, stroke", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
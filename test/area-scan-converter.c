@@ -0,0 +1,116 @@
+/*
+ * Copyright © 2012 Samsung Electronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Fills a few shapes through the exact area scan converter, which
+ * ANTIALIAS_BEST selects, and checks them against the tor scan converter
+ * used for ANTIALIAS_GOOD.
+ */
+
+#include "cairo-test.h"
+
+#define WIDTH 120
+#define HEIGHT 120
+
+/* tor samples only 15 rows per pixel, which leaves its coverage up to a
+ * tenth out where edges meet at a sharp angle */
+#define TOLERANCE 32
+
+static void
+draw_shapes (cairo_t *cr)
+{
+    cairo_set_source_rgb (cr, 1, 1, 1);
+    cairo_paint (cr);
+    cairo_set_source_rgb (cr, 0, 0, 0);
+
+    /* a circle at a fractional offset */
+    cairo_arc (cr, 30.3, 30.7, 22.4, 0, 2 * M_PI);
+    cairo_fill (cr);
+
+    /* a concave polygon with thin spikes and near-horizontal edges */
+    cairo_move_to (cr, 65.5, 10.2);
+    cairo_line_to (cr, 112.1, 14.6);
+    cairo_line_to (cr, 80.4, 22.9);
+    cairo_line_to (cr, 110.8, 52.3);
+    cairo_line_to (cr, 71.2, 40.1);
+    cairo_line_to (cr, 68.9, 55.5);
+    cairo_close_path (cr);
+    cairo_fill (cr);
+
+    /* a ring under the even-odd rule */
+    cairo_set_fill_rule (cr, CAIRO_FILL_RULE_EVEN_ODD);
+    cairo_arc (cr, 60.5, 88.25, 26, 0, 2 * M_PI);
+    cairo_new_sub_path (cr);
+    cairo_arc (cr, 63.75, 85.5, 13, 0, 2 * M_PI);
+    cairo_fill (cr);
+
+    /* a rotated sliver narrower than a pixel */
+    cairo_save (cr);
+    cairo_translate (cr, 10, 110);
+    cairo_rotate (cr, -M_PI / 3);
+    cairo_rectangle (cr, 0, 0, 50, .4);
+    cairo_restore (cr);
+    cairo_fill (cr);
+}
+
+static cairo_surface_t *
+draw (cairo_antialias_t antialias)
+{
+    cairo_surface_t *image;
+    cairo_t *cr;
+
+    image = cairo_image_surface_create (CAIRO_FORMAT_RGB24, WIDTH, HEIGHT);
+    cr = cairo_create (image);
+    cairo_set_antialias (cr, antialias);
+    draw_shapes (cr);
+    cairo_destroy (cr);
+
+    return image;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_surface_t *area, *tor;
+    cairo_test_status_t status = CAIRO_TEST_SUCCESS;
+
+    area = draw (CAIRO_ANTIALIAS_BEST);
+    tor = draw (CAIRO_ANTIALIAS_GOOD);
+
+    if (! cairo_test_images_match (ctx, area, tor, TOLERANCE)) {
+	cairo_test_log (ctx, "Error: the area scan converter differs from tor\n");
+	status = CAIRO_TEST_FAILURE;
+    }
+
+    cairo_surface_destroy (tor);
+    cairo_surface_destroy (area);
+
+    return status;
+}
+
+CAIRO_TEST (area_scan_converter,
+	    "Check fills through the area scan converter against tor",
+	    "fill", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
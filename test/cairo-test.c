@@ -1737,6 +1737,33 @@ cairo_test_paint_checkered (cairo_t *cr)
     cairo_restore (cr);
 }
 
+cairo_bool_t
+cairo_test_images_match (const cairo_test_context_t *ctx,
+			 cairo_surface_t *a,
+			 cairo_surface_t *b,
+			 unsigned int tolerance)
+{
+    buffer_diff_result_t result;
+    cairo_surface_t *diff;
+    cairo_status_t status;
+
+    cairo_surface_flush (a);
+    cairo_surface_flush (b);
+
+    diff = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+				       cairo_image_surface_get_width (a),
+				       cairo_image_surface_get_height (a));
+    status = image_diff (ctx, a, b, diff, &result);
+    cairo_surface_destroy (diff);
+    if (status) {
+	cairo_test_log (ctx, "Error: Failed to compare images: %s\n",
+			cairo_status_to_string (status));
+	return FALSE;
+    }
+
+    return ! image_diff_is_failure (&result, tolerance);
+}
+
 cairo_bool_t
 cairo_test_is_target_enabled (const cairo_test_context_t *ctx,
 			      const char *target)
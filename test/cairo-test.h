@@ -266,6 +266,14 @@ cairo_test_create_pattern_from_png (const cairo_test_context_t *ctx,
 void
 cairo_test_paint_checkered (cairo_t *cr);
 
+/* Compares two image surfaces of the same size, allowing each channel
+ * to differ by up to @tolerance, and logs any differences found. */
+cairo_bool_t
+cairo_test_images_match (const cairo_test_context_t *ctx,
+			 cairo_surface_t *a,
+			 cairo_surface_t *b,
+			 unsigned int tolerance);
+
 #define CAIRO_TEST_DOUBLE_EQUALS(a,b)  (fabs((a)-(b)) < 0.00001)
 
 cairo_bool_t
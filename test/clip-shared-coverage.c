@@ -0,0 +1,108 @@
+/*
+ * Copyright © 2012 Samsung Electronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/* Paints a column of rectangles through a rounded clip, as a clipped
+ * scroll view would its children, so that the later rectangles are
+ * composited through the coverage shared on the clip. The result is
+ * compared against the same scene with the clip rebuilt for every
+ * rectangle, which rasterises the clip afresh each time.
+ */
+
+#include "cairo-test.h"
+
+#define WIDTH 80
+#define HEIGHT 120
+#define ROWS 6
+
+/* the shared coverage is applied as a mask, the fresh clip as spans */
+#define TOLERANCE 2
+
+static void
+rounded_clip (cairo_t *cr)
+{
+    double r = 15.5;
+
+    cairo_new_path (cr);
+    cairo_arc (cr, 5 + r, 5 + r, r, M_PI, 3 * M_PI / 2);
+    cairo_arc (cr, WIDTH - 5 - r, 5 + r, r, 3 * M_PI / 2, 2 * M_PI);
+    cairo_arc (cr, WIDTH - 5 - r, HEIGHT - 5 - r, r, 0, M_PI / 2);
+    cairo_arc (cr, 5 + r, HEIGHT - 5 - r, r, M_PI / 2, M_PI);
+    cairo_close_path (cr);
+    cairo_clip (cr);
+}
+
+static void
+draw_rows (cairo_t *cr, cairo_bool_t reclip)
+{
+    int i;
+
+    cairo_set_source_rgb (cr, 1, 1, 1);
+    cairo_paint (cr);
+
+    rounded_clip (cr);
+    for (i = 0; i < ROWS; i++) {
+	if (reclip) {
+	    cairo_reset_clip (cr);
+	    rounded_clip (cr);
+	}
+
+	cairo_rectangle (cr, 0, i * HEIGHT / ROWS, WIDTH, HEIGHT / ROWS);
+	cairo_set_source_rgba (cr, i & 1, 0, 1, .75);
+	cairo_fill (cr);
+    }
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_surface_t *shared, *fresh;
+    cairo_test_status_t status = CAIRO_TEST_SUCCESS;
+    cairo_t *cr;
+
+    shared = cairo_image_surface_create (CAIRO_FORMAT_RGB24, WIDTH, HEIGHT);
+    cr = cairo_create (shared);
+    draw_rows (cr, FALSE);
+    cairo_destroy (cr);
+
+    fresh = cairo_image_surface_create (CAIRO_FORMAT_RGB24, WIDTH, HEIGHT);
+    cr = cairo_create (fresh);
+    draw_rows (cr, TRUE);
+    cairo_destroy (cr);
+
+    if (! cairo_test_images_match (ctx, shared, fresh, TOLERANCE)) {
+	cairo_test_log (ctx, "Error: drawing through the shared clip differs\n");
+	status = CAIRO_TEST_FAILURE;
+    }
+
+    cairo_surface_destroy (fresh);
+    cairo_surface_destroy (shared);
+
+    return status;
+}
+
+CAIRO_TEST (clip_shared_coverage,
+	    "Check that draws through a reused clip match a freshly built clip",
+	    "clip", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
@@ -0,0 +1,112 @@
+/*
+ * Copyright © 2012 Samsung Electronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/* Draws the same filled and stroked shape at several integer offsets,
+ * which has the second and later copies composited from the coverage
+ * mask cache, and checks that every copy matches the first, which was
+ * rasterised directly. The last copy is also clipped.
+ */
+
+#include "cairo-test.h"
+
+#define CELL 40
+#define COUNT 4
+/* the first copy is rasterised, the others composite the cached mask */
+#define TOLERANCE 2
+
+static void
+draw_shape (cairo_t *cr, double x, double y)
+{
+    cairo_new_path (cr);
+    cairo_arc (cr, x + 12.3, y + 12.3, 8, M_PI, 3 * M_PI / 2);
+    cairo_arc (cr, x + 27.3, y + 12.3, 8, 3 * M_PI / 2, 2 * M_PI);
+    cairo_arc (cr, x + 27.3, y + 27.3, 8, 0, M_PI / 2);
+    cairo_arc (cr, x + 12.3, y + 27.3, 8, M_PI / 2, M_PI);
+    cairo_close_path (cr);
+    cairo_set_source_rgba (cr, 0, 0, 1, .8);
+    cairo_fill (cr);
+
+    cairo_move_to (cr, x + 10.3, y + 20.3);
+    cairo_line_to (cr, x + 17.3, y + 28.3);
+    cairo_line_to (cr, x + 30.3, y + 11.3);
+    cairo_set_line_width (cr, 3);
+    cairo_set_source_rgb (cr, 1, 1, 1);
+    cairo_stroke (cr);
+}
+
+static cairo_surface_t *
+get_cell (cairo_surface_t *image, int i, int width)
+{
+    return cairo_image_surface_create_for_data (cairo_image_surface_get_data (image) + i * CELL * 4,
+						CAIRO_FORMAT_RGB24, width, CELL,
+						cairo_image_surface_get_stride (image));
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_surface_t *image;
+    cairo_test_status_t status = CAIRO_TEST_SUCCESS;
+    cairo_t *cr;
+    int i;
+
+    image = cairo_image_surface_create (CAIRO_FORMAT_RGB24,
+					COUNT * CELL, CELL);
+    cr = cairo_create (image);
+    cairo_set_source_rgb (cr, 1, 1, 0);
+    cairo_paint (cr);
+
+    for (i = 0; i < COUNT - 1; i++)
+	draw_shape (cr, i * CELL, 0);
+
+    cairo_rectangle (cr, i * CELL, 0, CELL / 2, CELL);
+    cairo_clip (cr);
+    draw_shape (cr, i * CELL, 0);
+    cairo_destroy (cr);
+
+    cairo_surface_flush (image);
+    for (i = 1; i < COUNT; i++) {
+	int width = i < COUNT - 1 ? CELL : CELL / 2;
+	cairo_surface_t *first, *copy;
+
+	first = get_cell (image, 0, width);
+	copy = get_cell (image, i, width);
+	if (! cairo_test_images_match (ctx, first, copy, TOLERANCE)) {
+	    cairo_test_log (ctx, "Error: copy %d differs from the first\n", i);
+	    status = CAIRO_TEST_FAILURE;
+	}
+	cairo_surface_destroy (copy);
+	cairo_surface_destroy (first);
+    }
+
+    cairo_surface_destroy (image);
+
+    return status;
+}
+
+CAIRO_TEST (coverage_cache,
+	    "Check that shapes composited from the coverage cache match the original",
+	    "fill, stroke", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
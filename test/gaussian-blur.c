@@ -0,0 +1,117 @@
+/*
+ * Copyright © 2012 Samsung Electronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Blurs an opaque square with CAIRO_FILTER_GAUSSIAN and a different
+ * sigma along either axis, and checks every pixel of the result against
+ * the square convolved with the ideal Gaussian. The blur is built from
+ * three box filters, so allow a few percent for the approximation.
+ */
+
+#include "cairo-test.h"
+
+#define SIZE 80
+#define INSET 20
+#define X_SIGMA 6.
+#define Y_SIGMA 2.5
+#define TOLERANCE 10
+
+static double
+coverage (double x, double sigma)
+{
+    /* the integral of the Gaussian over [INSET, SIZE - INSET] */
+    return .5 * (erf ((x - INSET) / (sigma * M_SQRT2)) -
+		 erf ((x - (SIZE - INSET)) / (sigma * M_SQRT2)));
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_test_status_t status = CAIRO_TEST_SUCCESS;
+    cairo_surface_t *source, *image;
+    const unsigned char *data;
+    double x_sigma, y_sigma;
+    int stride, x, y;
+    cairo_pattern_t *pattern;
+    cairo_t *cr;
+
+    source = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, SIZE, SIZE);
+    cr = cairo_create (source);
+    cairo_rectangle (cr, INSET, INSET, SIZE - 2 * INSET, SIZE - 2 * INSET);
+    cairo_fill (cr);
+    cairo_destroy (cr);
+
+    pattern = cairo_pattern_create_for_surface (source);
+    cairo_surface_destroy (source);
+    cairo_pattern_set_filter (pattern, CAIRO_FILTER_GAUSSIAN);
+    cairo_pattern_set_sigma (pattern, X_SIGMA, Y_SIGMA);
+
+    cairo_pattern_get_sigma (pattern, &x_sigma, &y_sigma);
+    if (x_sigma != X_SIGMA || y_sigma != Y_SIGMA) {
+	cairo_test_log (ctx, "Error: sigma (%f, %f) not kept\n",
+			x_sigma, y_sigma);
+	cairo_pattern_destroy (pattern);
+	return CAIRO_TEST_FAILURE;
+    }
+
+    image = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, SIZE, SIZE);
+    cr = cairo_create (image);
+    cairo_set_source (cr, pattern);
+    cairo_paint (cr);
+    cairo_destroy (cr);
+    cairo_pattern_destroy (pattern);
+
+    cairo_surface_flush (image);
+    data = cairo_image_surface_get_data (image);
+    stride = cairo_image_surface_get_stride (image);
+
+    for (y = 0; y < SIZE; y++) {
+	const uint32_t *row = (const uint32_t *) (data + y * stride);
+
+	for (x = 0; x < SIZE; x++) {
+	    int expected = floor (255 * coverage (x + .5, X_SIGMA) *
+				  coverage (y + .5, Y_SIGMA) + .5);
+	    int alpha = row[x] >> 24;
+
+	    if (abs (alpha - expected) > TOLERANCE) {
+		cairo_test_log (ctx,
+				"Error: pixel (%d, %d) has alpha %d, expected %d\n",
+				x, y, alpha, expected);
+		status = CAIRO_TEST_FAILURE;
+		goto out;
+	    }
+	}
+    }
+
+out:
+    cairo_surface_destroy (image);
+
+    return status;
+}
+
+CAIRO_TEST (gaussian_blur,
+	    "Check CAIRO_FILTER_GAUSSIAN against the ideal blur of a square",
+	    "image, filter", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
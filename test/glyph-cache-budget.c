@@ -0,0 +1,118 @@
+/*
+ * Copyright © 2012 Samsung Electronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Checks that cairo_glyph_cache_set_max_size() bounds the memory held by
+ * the glyph cache, and that cairo_glyph_cache_get_stats() accounts for
+ * the glyphs found, created and evicted whilst drawing.
+ */
+
+#include "cairo-test.h"
+
+#define BUDGET (16 << 10)
+
+static void
+draw_text (cairo_surface_t *surface, double size)
+{
+    cairo_t *cr;
+
+    cr = cairo_create (surface);
+    cairo_select_font_face (cr, CAIRO_TEST_FONT_FAMILY " Sans",
+			    CAIRO_FONT_SLANT_NORMAL,
+			    CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size (cr, size);
+    cairo_move_to (cr, 0, size);
+    cairo_show_text (cr, "the five boxing wizards jump quickly");
+    cairo_destroy (cr);
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_glyph_cache_stats_t before, after;
+    cairo_test_status_t status = CAIRO_TEST_SUCCESS;
+    cairo_surface_t *surface;
+    unsigned long max_size;
+    int n;
+
+    max_size = cairo_glyph_cache_get_max_size ();
+    cairo_glyph_cache_set_max_size (BUDGET);
+    if (cairo_glyph_cache_get_max_size () != BUDGET) {
+	cairo_test_log (ctx, "Error: budget not set\n");
+	status = CAIRO_TEST_FAILURE;
+	goto out;
+    }
+
+    surface = cairo_image_surface_create (CAIRO_FORMAT_A8, 400, 100);
+
+    /* every size makes new glyphs, more than fit within the budget */
+    cairo_glyph_cache_get_stats (&before);
+    for (n = 8; n < 64; n++)
+	draw_text (surface, n);
+    cairo_glyph_cache_get_stats (&after);
+
+    if (after.misses == before.misses ||
+	after.evictions == before.evictions)
+    {
+	cairo_test_log (ctx, "Error: expected glyphs to be created and evicted, "
+			"misses %u, evictions %u\n",
+			after.misses - before.misses,
+			after.evictions - before.evictions);
+	status = CAIRO_TEST_FAILURE;
+    }
+
+    if (after.size > BUDGET || after.max_size != BUDGET) {
+	cairo_test_log (ctx, "Error: cache holds %lu bytes, over budget of %lu\n",
+			after.size, after.max_size);
+	status = CAIRO_TEST_FAILURE;
+    }
+
+    /* with room to keep them, the same glyphs again are found in the cache */
+    cairo_glyph_cache_set_max_size (max_size);
+    draw_text (surface, 12);
+    cairo_glyph_cache_get_stats (&before);
+    draw_text (surface, 12);
+    cairo_glyph_cache_get_stats (&after);
+
+    if (after.hits == before.hits || after.misses != before.misses) {
+	cairo_test_log (ctx, "Error: expected only hits redrawing, "
+			"hits %u, misses %u\n",
+			after.hits - before.hits,
+			after.misses - before.misses);
+	status = CAIRO_TEST_FAILURE;
+    }
+
+    cairo_surface_destroy (surface);
+
+out:
+    cairo_glyph_cache_set_max_size (max_size);
+
+    return status;
+}
+
+CAIRO_TEST (glyph_cache_budget,
+	    "Check the glyph cache budget and statistics",
+	    "api, text", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
@@ -0,0 +1,155 @@
+/*
+ * Copyright © 2012 Samsung Electronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Checks that glyphs larger than cairo_glyph_cache_set_max_glyph_size(),
+ * such as those of a 300 pixel headline under the default threshold, are
+ * drawn without caching their images, so that they take up little of the
+ * glyph cache, yet are still drawn.
+ */
+
+#include "cairo-test.h"
+
+#include <math.h>
+
+#define HEADLINE_SIZE 300
+#define MAX_GLYPH_SIZE 100
+#define BUDGET (64 << 20)
+#define TEXT "Headline"
+
+/* Returns the growth of the glyph cache from drawing TEXT at @size, which
+ * is only meaningful if nothing was evicted meanwhile. */
+static long
+draw_text (cairo_surface_t *surface, double size,
+	   cairo_bool_t *inked, cairo_bool_t *evicted)
+{
+    cairo_glyph_cache_stats_t before, after;
+    const unsigned char *data;
+    int stride, width, height, x, y;
+    cairo_t *cr;
+
+    cr = cairo_create (surface);
+    cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+    cairo_paint (cr);
+    cairo_set_operator (cr, CAIRO_OPERATOR_OVER);
+
+    cairo_select_font_face (cr, CAIRO_TEST_FONT_FAMILY " Sans",
+			    CAIRO_FONT_SLANT_NORMAL,
+			    CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size (cr, size);
+    cairo_move_to (cr, 0, size);
+
+    cairo_glyph_cache_get_stats (&before);
+    cairo_show_text (cr, TEXT);
+    cairo_glyph_cache_get_stats (&after);
+    cairo_destroy (cr);
+
+    cairo_surface_flush (surface);
+    data = cairo_image_surface_get_data (surface);
+    stride = cairo_image_surface_get_stride (surface);
+    width = cairo_image_surface_get_width (surface);
+    height = cairo_image_surface_get_height (surface);
+
+    *inked = FALSE;
+    for (y = 0; y < height && ! *inked; y++) {
+	for (x = 0; x < width; x++) {
+	    if (data[y * stride + x]) {
+		*inked = TRUE;
+		break;
+	    }
+	}
+    }
+
+    *evicted = after.evictions != before.evictions;
+    return (long) after.size - (long) before.size;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_test_status_t status = CAIRO_TEST_SUCCESS;
+    cairo_surface_t *surface;
+    long as_images, as_outlines;
+    cairo_bool_t inked, evicted;
+    unsigned long max_size;
+    double max_glyph_size;
+
+    max_size = cairo_glyph_cache_get_max_size ();
+    max_glyph_size = cairo_glyph_cache_get_max_glyph_size ();
+    surface = cairo_image_surface_create (CAIRO_FORMAT_A8, 1600, 400);
+
+    cairo_glyph_cache_set_max_glyph_size (MAX_GLYPH_SIZE);
+    if (cairo_glyph_cache_get_max_glyph_size () != MAX_GLYPH_SIZE) {
+	cairo_test_log (ctx, "Error: max glyph size not set\n");
+	status = CAIRO_TEST_FAILURE;
+    }
+
+    /* leave room for every glyph, so that none is evicted */
+    cairo_glyph_cache_set_max_size (BUDGET);
+
+    /* every glyph is cached as an image */
+    cairo_glyph_cache_set_max_glyph_size (HUGE_VAL);
+    as_images = draw_text (surface, HEADLINE_SIZE, &inked, &evicted);
+    if (! inked) {
+	cairo_test_log (ctx, "Error: glyphs not drawn as images\n");
+	status = CAIRO_TEST_FAILURE;
+    }
+    if (evicted || as_images <= 0) {
+	cairo_test_log (ctx, "Error: glyph images not kept in the cache, "
+			"grew by %ld bytes\n", as_images);
+	status = CAIRO_TEST_FAILURE;
+    }
+
+    /* under the default threshold, a slightly different size, which has
+     * glyphs of its own, is drawn from the outlines */
+    cairo_glyph_cache_set_max_glyph_size (max_glyph_size);
+    as_outlines = draw_text (surface, HEADLINE_SIZE + 1, &inked, &evicted);
+    if (! inked) {
+	cairo_test_log (ctx, "Error: glyphs not drawn as outlines\n");
+	status = CAIRO_TEST_FAILURE;
+    }
+    if (evicted) {
+	cairo_test_log (ctx, "Error: glyphs evicted whilst drawing outlines\n");
+	status = CAIRO_TEST_FAILURE;
+    }
+
+    if (as_outlines * 4 > as_images) {
+	cairo_test_log (ctx, "Error: %dpx glyphs grew the cache by %ld bytes, "
+			"against %ld bytes as images, with a max glyph size of %g\n",
+			HEADLINE_SIZE + 1, as_outlines, as_images, max_glyph_size);
+	status = CAIRO_TEST_FAILURE;
+    }
+
+    cairo_surface_destroy (surface);
+    cairo_glyph_cache_set_max_glyph_size (max_glyph_size);
+    cairo_glyph_cache_set_max_size (max_size);
+
+    return status;
+}
+
+CAIRO_TEST (glyph_cache_large_glyphs,
+	    "Check that large glyphs are not cached as images",
+	    "api, text", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
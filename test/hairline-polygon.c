@@ -0,0 +1,151 @@
+/*
+ * Copyright © 2012 Samsung Electronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Strokes a finely flattened curve and a circle no wider than a pixel
+ * and checks that the hairline scan converter, which draws them by
+ * default, agrees with stroking them into a polygon. A dash pattern
+ * longer than the paths forces the latter. The hairline converter does
+ * not draw joins, so individual pixels at sharp turns may differ, but
+ * the ink laid down along the curves should be the same.
+ */
+
+#include "cairo-test.h"
+
+#define WIDTH 240
+#define HEIGHT 120
+
+/* the polygon has round joins where the hairline has none */
+#define TOLERANCE 112
+/* the total ink may differ by no more than 1 part in 32 */
+#define INK_SHIFT 5
+
+static void
+draw_shapes (cairo_t *cr, double line_width)
+{
+    int i;
+
+    cairo_set_source_rgb (cr, 1, 1, 1);
+    cairo_paint (cr);
+    cairo_set_source_rgb (cr, 0, 0, 0);
+    cairo_set_line_width (cr, line_width);
+    cairo_set_line_join (cr, CAIRO_LINE_JOIN_ROUND);
+
+    /* a sine wave of segments much shorter than a pixel */
+    for (i = 0; i <= 400; i++) {
+	double t = i / 400.;
+	cairo_line_to (cr, 5 + t * 110, 60 + 40 * sin (t * 6 * M_PI));
+    }
+    cairo_stroke (cr);
+
+    /* a circle of 256 segments */
+    for (i = 0; i < 256; i++) {
+	double t = 2 * M_PI * i / 256;
+	cairo_line_to (cr, 180.3 + 45 * cos (t), 60.6 + 45 * sin (t));
+    }
+    cairo_close_path (cr);
+    cairo_stroke (cr);
+}
+
+static cairo_surface_t *
+draw (double line_width, cairo_bool_t hairline)
+{
+    cairo_surface_t *image;
+    cairo_t *cr;
+
+    image = cairo_image_surface_create (CAIRO_FORMAT_RGB24, WIDTH, HEIGHT);
+    cr = cairo_create (image);
+    cairo_set_antialias (cr, CAIRO_ANTIALIAS_BEST);
+    if (! hairline) {
+	double dash = 4 * (WIDTH + HEIGHT);
+
+	cairo_set_dash (cr, &dash, 1, 0);
+    }
+    draw_shapes (cr, line_width);
+    cairo_destroy (cr);
+
+    return image;
+}
+
+static unsigned long
+ink (cairo_surface_t *image)
+{
+    const unsigned char *data;
+    unsigned long sum = 0;
+    int stride, x, y;
+
+    cairo_surface_flush (image);
+    data = cairo_image_surface_get_data (image);
+    stride = cairo_image_surface_get_stride (image);
+    for (y = 0; y < HEIGHT; y++) {
+	const uint32_t *row = (const uint32_t *) (data + y * stride);
+
+	for (x = 0; x < WIDTH; x++)
+	    sum += 255 - (row[x] & 0xff);
+    }
+
+    return sum;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    static const double line_widths[] = { .5, .75, 1. };
+    cairo_test_status_t status = CAIRO_TEST_SUCCESS;
+    int i;
+
+    for (i = 0; i < ARRAY_LENGTH (line_widths); i++) {
+	cairo_surface_t *hairline, *polygon;
+	unsigned long a, b;
+
+	hairline = draw (line_widths[i], TRUE);
+	polygon = draw (line_widths[i], FALSE);
+
+	if (! cairo_test_images_match (ctx, hairline, polygon, TOLERANCE)) {
+	    cairo_test_log (ctx, "Error: hairline of width %g differs from its polygon\n",
+			    line_widths[i]);
+	    status = CAIRO_TEST_FAILURE;
+	}
+
+	a = ink (hairline);
+	b = ink (polygon);
+	if ((a > b ? a - b : b - a) > b >> INK_SHIFT) {
+	    cairo_test_log (ctx, "Error: hairline of width %g lays down %lu of ink, "
+			    "its polygon %lu\n",
+			    line_widths[i], a, b);
+	    status = CAIRO_TEST_FAILURE;
+	}
+
+	cairo_surface_destroy (polygon);
+	cairo_surface_destroy (hairline);
+    }
+
+    return status;
+}
+
+CAIRO_TEST (hairline_polygon,
+	    "Check that hairline strokes agree with their stroked polygons",
+	    "stroke", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
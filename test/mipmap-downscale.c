@@ -0,0 +1,136 @@
+/*
+ * Copyright © 2012 Samsung Electronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Shrinks a source of alternating one pixel black and white columns by
+ * a factor of eight with CAIRO_FILTER_GOOD, which samples from the mip
+ * pyramid. Every covered pixel should come out as an even grey rather
+ * than the aliased black or white a bilinear filter would pick, and the
+ * odd sized source should end where it is expected to, a little way
+ * into the last pixel, rather than extending over it.
+ */
+
+#include "cairo-test.h"
+
+#define SIZE 257 /* odd so that every level of the pyramid rounds up */
+#define SCALE 8
+
+static cairo_surface_t *
+create_source (void)
+{
+    cairo_surface_t *source;
+    cairo_t *cr;
+    int x;
+
+    source = cairo_image_surface_create (CAIRO_FORMAT_RGB24, SIZE, SIZE);
+    cr = cairo_create (source);
+    cairo_set_source_rgb (cr, 0, 0, 0);
+    cairo_paint (cr);
+    cairo_set_source_rgb (cr, 1, 1, 1);
+    for (x = 0; x < SIZE; x += 2)
+	cairo_rectangle (cr, x, 0, 1, SIZE);
+    cairo_fill (cr);
+    cairo_destroy (cr);
+
+    return source;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_test_status_t status = CAIRO_TEST_SUCCESS;
+    cairo_surface_t *source, *image;
+    const unsigned char *data;
+    int stride, x, y;
+    cairo_t *cr;
+
+    source = create_source ();
+
+    image = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 40, 40);
+    cr = cairo_create (image);
+    cairo_scale (cr, 1. / SCALE, 1. / SCALE);
+    cairo_set_source_surface (cr, source, 0, 0);
+    cairo_pattern_set_filter (cairo_get_source (cr), CAIRO_FILTER_GOOD);
+    cairo_paint (cr);
+    cairo_destroy (cr);
+    cairo_surface_destroy (source);
+
+    cairo_surface_flush (image);
+    data = cairo_image_surface_get_data (image);
+    stride = cairo_image_surface_get_stride (image);
+
+    /* the interior averages to (129 * 255 / 257) in every channel */
+    for (y = 1; y < SIZE / SCALE - 1; y++) {
+	const uint32_t *row = (const uint32_t *) (data + y * stride);
+
+	for (x = 1; x < SIZE / SCALE - 1; x++) {
+	    int green = (row[x] >> 8) & 0xff;
+
+	    if (green < 0x70 || green > 0x90) {
+		cairo_test_log (ctx,
+				"Error: pixel (%d, %d) is %08x, expected grey\n",
+				x, y, row[x]);
+		status = CAIRO_TEST_FAILURE;
+		goto out;
+	    }
+	}
+    }
+
+    /* the source covers only an eighth of the next column and row */
+    for (y = 0; y < SIZE / SCALE; y++) {
+	const uint32_t *row = (const uint32_t *) (data + y * stride);
+	int alpha = row[SIZE / SCALE] >> 24;
+
+	if (alpha > 0x40) {
+	    cairo_test_log (ctx,
+			    "Error: source extends over pixel (%d, %d), alpha %02x\n",
+			    SIZE / SCALE, y, alpha);
+	    status = CAIRO_TEST_FAILURE;
+	    goto out;
+	}
+    }
+    for (x = 0; x < SIZE / SCALE; x++) {
+	const uint32_t *row = (const uint32_t *) (data + SIZE / SCALE * stride);
+	int alpha = row[x] >> 24;
+
+	if (alpha > 0x40) {
+	    cairo_test_log (ctx,
+			    "Error: source extends over pixel (%d, %d), alpha %02x\n",
+			    x, SIZE / SCALE, alpha);
+	    status = CAIRO_TEST_FAILURE;
+	    goto out;
+	}
+    }
+
+out:
+    cairo_surface_destroy (image);
+
+    return status;
+}
+
+CAIRO_TEST (mipmap_downscale,
+	    "Check that strongly downscaled images are filtered from a mip pyramid",
+	    "image, filter", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
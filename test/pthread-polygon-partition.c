@@ -0,0 +1,127 @@
+/*
+ * Copyright © 2012 Samsung Electronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Fills a polygon large enough to be split into clusters and processed
+ * by the render threads, once with a single thread and once with four,
+ * and checks that the two agree. The scene has disjoint clusters, rings
+ * nested within each other and squares touching along their edges.
+ * ANTIALIAS_BEST is used, as it reduces the polygon before rasterising.
+ */
+
+#include "cairo-test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SIZE 320
+#define CELLS 8
+
+static void
+draw_scene (cairo_t *cr)
+{
+    int i, j;
+
+    cairo_set_source_rgb (cr, 1, 1, 1);
+    cairo_paint (cr);
+    cairo_set_source_rgb (cr, 0, 0, 0);
+    cairo_set_antialias (cr, CAIRO_ANTIALIAS_BEST);
+    cairo_set_tolerance (cr, .01);
+
+    /* nested rings, wound alternately, in disjoint cells */
+    for (j = 0; j < CELLS; j++) {
+	for (i = 0; i < CELLS; i++) {
+	    double x = 20.3 + i * 36.7, y = 20.6 + j * 36.1;
+
+	    cairo_new_sub_path (cr);
+	    cairo_arc (cr, x, y, 16, 0, 2 * M_PI);
+	    cairo_new_sub_path (cr);
+	    cairo_arc_negative (cr, x + .5, y - .25, 10, 2 * M_PI, 0);
+	    cairo_new_sub_path (cr);
+	    cairo_arc (cr, x, y, 4.5, 0, 2 * M_PI);
+	}
+    }
+
+    /* a row of squares sharing their sides */
+    for (i = 0; i < 2 * CELLS; i++)
+	cairo_rectangle (cr, 2.25 + i * 19.5, 300.5, 19.5, 15);
+
+    cairo_fill (cr);
+}
+
+static cairo_surface_t *
+draw (const char *num_threads)
+{
+    cairo_surface_t *image;
+    cairo_t *cr;
+
+    setenv ("CAIRO_RENDER_THREADS", num_threads, 1);
+    cairo_debug_reset_static_data ();
+
+    image = cairo_image_surface_create (CAIRO_FORMAT_RGB24, SIZE, SIZE);
+    cr = cairo_create (image);
+    draw_scene (cr);
+    cairo_destroy (cr);
+
+    return image;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_surface_t *serial, *parallel;
+    cairo_test_status_t status = CAIRO_TEST_SUCCESS;
+    char *saved;
+
+    saved = getenv ("CAIRO_RENDER_THREADS");
+    if (saved != NULL)
+	saved = strdup (saved);
+
+    serial = draw ("1");
+    parallel = draw ("4");
+
+    if (! cairo_test_images_match (ctx, serial, parallel, 0)) {
+	cairo_test_log (ctx, "Error: rendering with four threads differs\n");
+	status = CAIRO_TEST_FAILURE;
+    }
+
+    cairo_surface_destroy (parallel);
+    cairo_surface_destroy (serial);
+
+    if (saved != NULL) {
+	setenv ("CAIRO_RENDER_THREADS", saved, 1);
+	free (saved);
+    } else {
+	unsetenv ("CAIRO_RENDER_THREADS");
+    }
+    cairo_debug_reset_static_data ();
+
+    return status;
+}
+
+CAIRO_TEST (pthread_polygon_partition,
+	    "Check that polygons split across the render threads match the serial result",
+	    "fill, thread", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
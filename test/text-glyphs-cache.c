@@ -0,0 +1,167 @@
+/*
+ * Copyright © 2012 Samsung Electronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Checks that strings converted to glyphs again are found in the text
+ * cache of the scaled font, placed at the new origin, and that the least
+ * recently used strings are dropped once the cache is full.
+ */
+
+#include "cairo-test.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#define TEXT "a label redrawn every frame"
+
+static cairo_bool_t
+convert (cairo_scaled_font_t *scaled_font,
+	 double x, double y,
+	 const char *utf8,
+	 cairo_glyph_t **glyphs, int *num_glyphs,
+	 cairo_text_cluster_t **clusters, int *num_clusters)
+{
+    cairo_text_cluster_flags_t cluster_flags;
+
+    *glyphs = NULL;
+    *clusters = NULL;
+    return cairo_scaled_font_text_to_glyphs (scaled_font, x, y, utf8, -1,
+					     glyphs, num_glyphs,
+					     clusters, num_clusters,
+					     &cluster_flags) == CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_glyph_cache_stats_t before, after;
+    cairo_test_status_t status = CAIRO_TEST_SUCCESS;
+    cairo_font_face_t *font_face;
+    cairo_font_options_t *options;
+    cairo_scaled_font_t *scaled_font;
+    cairo_matrix_t font_matrix, ctm;
+    cairo_glyph_t *glyphs[2];
+    cairo_text_cluster_t *clusters[2];
+    int num_glyphs[2], num_clusters[2];
+    int n;
+
+    font_face = cairo_toy_font_face_create (CAIRO_TEST_FONT_FAMILY " Sans",
+					    CAIRO_FONT_SLANT_NORMAL,
+					    CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_matrix_init_scale (&font_matrix, 12, 12);
+    cairo_matrix_init_identity (&ctm);
+    options = cairo_font_options_create ();
+    scaled_font = cairo_scaled_font_create (font_face,
+					    &font_matrix, &ctm, options);
+    cairo_font_options_destroy (options);
+    cairo_font_face_destroy (font_face);
+
+    /* the first conversion fills the cache, the second is found there */
+    cairo_glyph_cache_get_stats (&before);
+    if (! convert (scaled_font, 0, 0, TEXT,
+		   &glyphs[0], &num_glyphs[0], &clusters[0], &num_clusters[0]) ||
+	! convert (scaled_font, 10.5, 20, TEXT,
+		   &glyphs[1], &num_glyphs[1], &clusters[1], &num_clusters[1]))
+    {
+	cairo_test_log (ctx, "Error: failed to convert text to glyphs\n");
+	cairo_scaled_font_destroy (scaled_font);
+	return CAIRO_TEST_FAILURE;
+    }
+    cairo_glyph_cache_get_stats (&after);
+
+    if (after.text_misses - before.text_misses != 1 ||
+	after.text_hits - before.text_hits != 1)
+    {
+	cairo_test_log (ctx, "Error: expected one miss and one hit, "
+			"misses %u, hits %u\n",
+			after.text_misses - before.text_misses,
+			after.text_hits - before.text_hits);
+	status = CAIRO_TEST_FAILURE;
+    }
+
+    if (num_glyphs[0] != num_glyphs[1] || num_clusters[0] != num_clusters[1]) {
+	cairo_test_log (ctx, "Error: converted to %d and %d glyphs\n",
+			num_glyphs[0], num_glyphs[1]);
+	status = CAIRO_TEST_FAILURE;
+    } else {
+	for (n = 0; n < num_glyphs[0]; n++) {
+	    if (glyphs[0][n].index != glyphs[1][n].index ||
+		fabs (glyphs[0][n].x + 10.5 - glyphs[1][n].x) > 1e-6 ||
+		fabs (glyphs[0][n].y + 20 - glyphs[1][n].y) > 1e-6 ||
+		clusters[0][n].num_bytes != clusters[1][n].num_bytes ||
+		clusters[0][n].num_glyphs != clusters[1][n].num_glyphs)
+	    {
+		cairo_test_log (ctx, "Error: glyph %d differs when cached\n", n);
+		status = CAIRO_TEST_FAILURE;
+		break;
+	    }
+	}
+    }
+
+    for (n = 0; n < 2; n++) {
+	cairo_glyph_free (glyphs[n]);
+	cairo_text_cluster_free (clusters[n]);
+    }
+
+    /* many other strings push the first one out */
+    cairo_glyph_cache_get_stats (&before);
+    for (n = 0; n < 256; n++) {
+	char buf[32];
+
+	snprintf (buf, sizeof (buf), "label %d", n);
+	if (convert (scaled_font, 0, 0, buf,
+		     &glyphs[0], &num_glyphs[0], &clusters[0], &num_clusters[0]))
+	{
+	    cairo_glyph_free (glyphs[0]);
+	    cairo_text_cluster_free (clusters[0]);
+	}
+    }
+    if (convert (scaled_font, 0, 0, TEXT,
+		 &glyphs[0], &num_glyphs[0], &clusters[0], &num_clusters[0]))
+    {
+	cairo_glyph_free (glyphs[0]);
+	cairo_text_cluster_free (clusters[0]);
+    }
+    cairo_glyph_cache_get_stats (&after);
+
+    if (after.text_evictions == before.text_evictions ||
+	after.text_misses - before.text_misses != 257)
+    {
+	cairo_test_log (ctx, "Error: expected strings to be evicted, "
+			"misses %u, evictions %u\n",
+			after.text_misses - before.text_misses,
+			after.text_evictions - before.text_evictions);
+	status = CAIRO_TEST_FAILURE;
+    }
+
+    cairo_scaled_font_destroy (scaled_font);
+
+    return status;
+}
+
+CAIRO_TEST (text_glyphs_cache,
+	    "Check that text converted to glyphs again is taken from the cache",
+	    "api, text", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)
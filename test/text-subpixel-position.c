@@ -0,0 +1,127 @@
+/*
+ * Copyright © 2012 Samsung Electronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Checks that, with unhinted metrics, text drawn at a fractional x
+ * position is drawn there rather than at the nearest whole pixel, and
+ * that it looks the same wherever it lands with the same fraction.
+ * Only the FreeType backend renders glyphs at fractional offsets.
+ */
+
+#include "cairo-test.h"
+
+#include <string.h>
+
+#define WIDTH 48
+#define HEIGHT 24
+
+static cairo_surface_t *
+draw_text (double x, cairo_hint_metrics_t hint_metrics)
+{
+    cairo_font_options_t *options;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+
+    surface = cairo_image_surface_create (CAIRO_FORMAT_A8, WIDTH, HEIGHT);
+    cr = cairo_create (surface);
+
+    cairo_select_font_face (cr, CAIRO_TEST_FONT_FAMILY " Sans",
+			    CAIRO_FONT_SLANT_NORMAL,
+			    CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size (cr, 16);
+
+    options = cairo_font_options_create ();
+    cairo_font_options_set_antialias (options, CAIRO_ANTIALIAS_GRAY);
+    cairo_font_options_set_hint_metrics (options, hint_metrics);
+    cairo_set_font_options (cr, options);
+    cairo_font_options_destroy (options);
+
+    cairo_move_to (cr, x, 18);
+    cairo_show_text (cr, "ill");
+    cairo_destroy (cr);
+
+    cairo_surface_flush (surface);
+    return surface;
+}
+
+/* Compares @b with @a moved @dx pixels to the right. */
+static cairo_bool_t
+same_text (cairo_surface_t *a, cairo_surface_t *b, int dx)
+{
+    const unsigned char *pa = cairo_image_surface_get_data (a);
+    const unsigned char *pb = cairo_image_surface_get_data (b);
+    int stride = cairo_image_surface_get_stride (a);
+    int y;
+
+    for (y = 0; y < HEIGHT; y++) {
+	if (memcmp (pa + y * stride, pb + y * stride + dx, WIDTH - dx))
+	    return FALSE;
+    }
+
+    return TRUE;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_surface_t *whole, *quarter, *next_quarter;
+    cairo_test_status_t status = CAIRO_TEST_SUCCESS;
+
+    whole = draw_text (4, CAIRO_HINT_METRICS_OFF);
+    quarter = draw_text (4.25, CAIRO_HINT_METRICS_OFF);
+    next_quarter = draw_text (5.25, CAIRO_HINT_METRICS_OFF);
+
+    if (same_text (whole, quarter, 0)) {
+	cairo_test_log (ctx, "Error: text at 4.25 drawn as at 4\n");
+	status = CAIRO_TEST_FAILURE;
+    }
+    if (! same_text (quarter, next_quarter, 1)) {
+	cairo_test_log (ctx, "Error: text at 5.25 differs from text at 4.25\n");
+	status = CAIRO_TEST_FAILURE;
+    }
+
+    cairo_surface_destroy (whole);
+    cairo_surface_destroy (quarter);
+    cairo_surface_destroy (next_quarter);
+
+    /* hinted metrics keep glyphs on whole pixels */
+    whole = draw_text (4, CAIRO_HINT_METRICS_ON);
+    quarter = draw_text (4.25, CAIRO_HINT_METRICS_ON);
+
+    if (! same_text (whole, quarter, 0)) {
+	cairo_test_log (ctx, "Error: hinted text at 4.25 not drawn as at 4\n");
+	status = CAIRO_TEST_FAILURE;
+    }
+
+    cairo_surface_destroy (whole);
+    cairo_surface_destroy (quarter);
+
+    return status;
+}
+
+CAIRO_TEST (text_subpixel_position,
+	    "Check that text is drawn at fractional positions with unhinted metrics",
+	    "ft, text", /* keywords */
+	    "ft", /* requirements */
+	    0, 0,
+	    preamble, NULL)
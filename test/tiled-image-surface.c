@@ -0,0 +1,201 @@
+/*
+ * Copyright © 2012 Samsung Electronics
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Renders the same scene into a tiled and a linear image surface and
+ * checks that the pixels agree, including where operations straddle
+ * the tile boundaries, miss some of the tiles within their extents,
+ * read back from the surface itself, or are made through
+ * cairo_surface_map_to_image().
+ */
+
+#include "cairo-test.h"
+
+#define WIDTH 301
+#define HEIGHT 199
+
+/* each tile is composited on its own, which may round differently */
+#define TOLERANCE 2
+
+static void
+draw_scene (cairo_t *cr, cairo_surface_t *source)
+{
+    cairo_set_source_rgb (cr, 1, 1, 1);
+    cairo_paint (cr);
+
+    cairo_arc (cr, WIDTH / 2., HEIGHT / 2., HEIGHT / 3., 0, 2 * M_PI);
+    cairo_set_source_rgba (cr, 0, 0, 1, .75);
+    cairo_fill (cr);
+
+    cairo_move_to (cr, 3.5, HEIGHT - 3.5);
+    cairo_line_to (cr, WIDTH - 3.5, 3.5);
+    cairo_set_line_width (cr, 9);
+    cairo_set_source_rgb (cr, 1, 0, 0);
+    cairo_stroke (cr);
+
+    /* a hairline that passes through some tiles of its extents only */
+    cairo_arc (cr, WIDTH / 2., HEIGHT / 2., HEIGHT / 2.5, 0, 2 * M_PI);
+    cairo_set_line_width (cr, 1);
+    cairo_set_source_rgb (cr, 0, 0, 0);
+    cairo_stroke (cr);
+
+    /* glyphs straddling the tile boundaries */
+    cairo_select_font_face (cr, CAIRO_TEST_FONT_FAMILY " Sans",
+			    CAIRO_FONT_SLANT_NORMAL,
+			    CAIRO_FONT_WEIGHT_BOLD);
+    cairo_set_font_size (cr, 40);
+    cairo_move_to (cr, 40, 140);
+    cairo_set_source_rgb (cr, 0, .5, 0);
+    cairo_show_text (cr, "tiled text");
+
+    cairo_save (cr);
+    cairo_translate (cr, WIDTH / 2., HEIGHT / 2.);
+    cairo_rotate (cr, M_PI / 7);
+    cairo_set_source_surface (cr, source, -32, -32);
+    cairo_paint_with_alpha (cr, .5);
+    cairo_restore (cr);
+
+    /* an unbounded operator, applied across every tile in the clip */
+    cairo_save (cr);
+    cairo_rectangle (cr, 60, 30, 170, 120);
+    cairo_clip (cr);
+    cairo_arc (cr, 150, 90, 40, 0, 2 * M_PI);
+    cairo_set_operator (cr, CAIRO_OPERATOR_IN);
+    cairo_set_source_rgba (cr, 0, 1, 0, .5);
+    cairo_fill (cr);
+    cairo_restore (cr);
+
+    /* and read back from the target whilst drawing to it */
+    cairo_set_source_surface (cr, cairo_get_target (cr), 70, 40);
+    cairo_rectangle (cr, 70, 40, 150, 100);
+    cairo_fill (cr);
+}
+
+static cairo_surface_t *
+create_source (void)
+{
+    cairo_surface_t *source;
+    cairo_t *cr;
+
+    source = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 64, 64);
+    cr = cairo_create (source);
+    cairo_set_source_rgb (cr, 1, 0, 1);
+    cairo_paint (cr);
+    cairo_set_source_rgb (cr, 0, 1, 1);
+    cairo_rectangle (cr, 0, 0, 32, 32);
+    cairo_rectangle (cr, 32, 32, 32, 32);
+    cairo_fill (cr);
+    cairo_destroy (cr);
+
+    return source;
+}
+
+static cairo_bool_t
+compare (const cairo_test_context_t *ctx,
+	 cairo_surface_t *tiled, cairo_surface_t *linear)
+{
+    cairo_surface_t *image;
+    cairo_bool_t same;
+
+    image = cairo_surface_map_to_image (tiled, NULL);
+    same = cairo_test_images_match (ctx, image, linear, TOLERANCE);
+    cairo_surface_unmap_image (tiled, image);
+
+    return same;
+}
+
+static cairo_test_status_t
+preamble (cairo_test_context_t *ctx)
+{
+    cairo_surface_t *tiled, *linear, *source, *image;
+    cairo_rectangle_int_t extents;
+    cairo_test_status_t status = CAIRO_TEST_SUCCESS;
+    cairo_t *cr;
+
+    source = create_source ();
+
+    tiled = cairo_tiled_image_surface_create (CAIRO_FORMAT_ARGB32,
+					      WIDTH, HEIGHT);
+    linear = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+					 WIDTH, HEIGHT);
+
+    cr = cairo_create (tiled);
+    draw_scene (cr, source);
+    cairo_destroy (cr);
+
+    cr = cairo_create (linear);
+    draw_scene (cr, source);
+    cairo_destroy (cr);
+
+    if (cairo_surface_status (tiled)) {
+	cairo_test_log (ctx, "Error: tiled surface in error, %s\n",
+			cairo_status_to_string (cairo_surface_status (tiled)));
+	status = CAIRO_TEST_FAILURE;
+	goto out;
+    }
+
+    if (! compare (ctx, tiled, linear)) {
+	cairo_test_log (ctx, "Error: tiled rendering differs\n");
+	status = CAIRO_TEST_FAILURE;
+	goto out;
+    }
+
+    /* write a region through a mapping that covers parts of six tiles */
+    extents.x = 50;
+    extents.y = 20;
+    extents.width = 100;
+    extents.height = 100;
+
+    image = cairo_surface_map_to_image (tiled, &extents);
+    cr = cairo_create (image);
+    cairo_set_source_rgb (cr, 1, 1, 0);
+    cairo_paint (cr);
+    cairo_destroy (cr);
+    cairo_surface_unmap_image (tiled, image);
+
+    image = cairo_surface_map_to_image (linear, &extents);
+    cr = cairo_create (image);
+    cairo_set_source_rgb (cr, 1, 1, 0);
+    cairo_paint (cr);
+    cairo_destroy (cr);
+    cairo_surface_unmap_image (linear, image);
+
+    if (! compare (ctx, tiled, linear)) {
+	cairo_test_log (ctx, "Error: tiled surface differs after unmapping\n");
+	status = CAIRO_TEST_FAILURE;
+    }
+
+out:
+    cairo_surface_destroy (linear);
+    cairo_surface_destroy (tiled);
+    cairo_surface_destroy (source);
+
+    return status;
+}
+
+CAIRO_TEST (tiled_image_surface,
+	    "Check that tiled image surfaces render as linear ones",
+	    "image, text", /* keywords */
+	    NULL, /* requirements */
+	    0, 0,
+	    preamble, NULL)